@@ -7,25 +7,25 @@ GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
 
 #include "back_propagation.h"
 
-void d_identity(int layer_size, double* layer_input, double* layer_output, double* layer_derivative) {
+void d_identity(int layer_size, mlp_real* layer_input, mlp_real* layer_output, mlp_real* layer_derivative) {
     int i;
     for (i = 0; i < layer_size; i++)
         layer_derivative[i] = 1;
 }
 
-void d_sigmoid(int layer_size, double* layer_input, double* layer_output, double* layer_derivative) {
+void d_sigmoid(int layer_size, mlp_real* layer_input, mlp_real* layer_output, mlp_real* layer_derivative) {
     int i;
     for (i = 0; i < layer_size; i++)
-        layer_derivative[i] = layer_output[i+1] * (1.0 - layer_output[i+1]);
+        layer_derivative[i] = layer_output[i+1] * (1 - layer_output[i+1]);
 }
 
-void d_tanh(int layer_size, double* layer_input, double* layer_output, double* layer_derivative) {
+void d_tanh(int layer_size, mlp_real* layer_input, mlp_real* layer_output, mlp_real* layer_derivative) {
     int i;
     for (i = 0; i < layer_size; i++)
-        layer_derivative[i] = 1.0 - layer_output[i+1] * layer_output[i+1];
+        layer_derivative[i] = 1 - layer_output[i+1] * layer_output[i+1];
 }
 
-void d_relu(int layer_size, double* layer_input, double* layer_output, double* layer_derivative) {
+void d_relu(int layer_size, mlp_real* layer_input, mlp_real* layer_output, mlp_real* layer_derivative) {
     int i;
     for (i = 0; i < layer_size; i++) {
         if (layer_input[i] > 0)
@@ -37,28 +37,32 @@ void d_relu(int layer_size, double* layer_input, double* layer_output, double* l
     }
 }
 
-void d_softmax(int layer_size, double* layer_input, double* layer_output, double* layer_derivative) {
+void d_softmax(int layer_size, mlp_real* layer_input, mlp_real* layer_output, mlp_real* layer_derivative) {
     int i;
     for (i = 0; i < layer_size; i++)
-        layer_derivative[i] = layer_output[i+1] * (1.0 - layer_output[i+1]);
+        layer_derivative[i] = layer_output[i+1] * (1 - layer_output[i+1]);
 }
 
-void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int* layer_sizes, double** layer_inputs, double** layer_outputs,
-    double* expected_output, double** local_gradient) {
-    // Create memory for derivatives
-    double** layer_derivatives = (double**)calloc(n_layers, sizeof(double*));
+void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int* layer_sizes, training_workspace* ws) {
+    mlp_real** layer_inputs = ws->layer_inputs;
+    mlp_real** layer_outputs = ws->layer_outputs;
+    mlp_real* expected_output = ws->expected_output;
+    mlp_real** local_gradient = ws->local_gradient;
+
+    // Memory for derivatives is part of the workspace
+    mlp_real** layer_derivatives = ws->layer_derivatives;
 
     int i;
-    for (i = 0; i < n_layers; i++)
-        layer_derivatives[i] = (double*)calloc(layer_sizes[i], sizeof(double));
 
     // If output layer
     if (layer_no == n_layers-1) {
         // Error produced at the output layer
-        double* error_output = (double*)calloc(param->output_layer_size, sizeof(double));
+        mlp_real* error_output = ws->error_output;
 
+        // Derivative of the squared error with respect to each output, so the local gradients and the
+        // weight corrections are the gradient of the error and the weights move against them
         for (i = 0; i < param->output_layer_size; i++)
-            error_output[i] = expected_output[i] - layer_outputs[layer_no][i+1];
+            error_output[i] = layer_outputs[layer_no][i+1] - expected_output[i];
 
         // Calculate the layer derivatives
         // Calculate the local gradients
@@ -104,10 +108,12 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 break;
         }
 
-        // Free the memory allocated in Heap
-        free(error_output);
     }
     else { // If hidden layer
+        // Weights from this layer to the next layer
+        mlp_real* weight = weight_matrix(&param->weight, layer_no);
+        int stride = param->weight.stride[layer_no];
+
         // Calculate the layer derivative for all units in the layer
         // Calculate local gradient
         int j;
@@ -116,9 +122,9 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 d_identity(layer_sizes[layer_no], layer_inputs[layer_no], layer_outputs[layer_no], layer_derivatives[layer_no]);
 
                 for (i = 0; i < layer_sizes[layer_no]; i++) {
-                    double error = 0.0;
+                    mlp_real error = 0.0;
                     for (j = 0; j < layer_sizes[layer_no+1]; j++)
-                        error += local_gradient[layer_no+1][j] * param->weight[layer_no][i][j];
+                        error += local_gradient[layer_no+1][j] * weight[i * stride + j];
 
                     local_gradient[layer_no][i] = error * layer_derivatives[layer_no][i];
                 }
@@ -128,9 +134,9 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 d_sigmoid(layer_sizes[layer_no], layer_inputs[layer_no], layer_outputs[layer_no], layer_derivatives[layer_no]);
 
                 for (i = 0; i < layer_sizes[layer_no]; i++) {
-                    double error = 0.0;
+                    mlp_real error = 0.0;
                     for (j = 0; j < layer_sizes[layer_no+1]; j++)
-                        error += local_gradient[layer_no+1][j] * param->weight[layer_no][i][j];
+                        error += local_gradient[layer_no+1][j] * weight[i * stride + j];
 
                     local_gradient[layer_no][i] = error * layer_derivatives[layer_no][i];
                 }
@@ -140,9 +146,9 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 d_tanh(layer_sizes[layer_no], layer_inputs[layer_no], layer_outputs[layer_no], layer_derivatives[layer_no]);
 
                 for (i = 0; i < layer_sizes[layer_no]; i++) {
-                    double error = 0.0;
+                    mlp_real error = 0.0;
                     for (j = 0; j < layer_sizes[layer_no+1]; j++)
-                        error += local_gradient[layer_no+1][j] * param->weight[layer_no][i][j];
+                        error += local_gradient[layer_no+1][j] * weight[i * stride + j];
 
                     local_gradient[layer_no][i] = error * layer_derivatives[layer_no][i];
                 }
@@ -152,9 +158,9 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 d_relu(layer_sizes[layer_no], layer_inputs[layer_no], layer_outputs[layer_no], layer_derivatives[layer_no]);
 
                 for (i = 0; i < layer_sizes[layer_no]; i++) {
-                    double error = 0.0;
+                    mlp_real error = 0.0;
                     for (j = 0; j < layer_sizes[layer_no+1]; j++)
-                        error += local_gradient[layer_no+1][j] * param->weight[layer_no][i][j];
+                        error += local_gradient[layer_no+1][j] * weight[i * stride + j];
 
                     local_gradient[layer_no][i] = error * layer_derivatives[layer_no][i];
                 }
@@ -164,9 +170,9 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 d_softmax(layer_sizes[layer_no], layer_inputs[layer_no], layer_outputs[layer_no], layer_derivatives[layer_no]);
 
                 for (i = 0; i < layer_sizes[layer_no]; i++) {
-                    double error = 0.0;
+                    mlp_real error = 0.0;
                     for (j = 0; j < layer_sizes[layer_no+1]; j++)
-                        error += local_gradient[layer_no+1][j] * param->weight[layer_no][i][j];
+                        error += local_gradient[layer_no+1][j] * weight[i * stride + j];
 
                     local_gradient[layer_no][i] = error * layer_derivatives[layer_no][i];
                 }
@@ -178,93 +184,185 @@ void calculate_local_gradient(parameters* param, int layer_no, int n_layers, int
                 break;
         }
     }
-
-    // Free the memory allocated in Heap
-    for (i = 0; i < n_layers; i++)
-        free(layer_derivatives[i]);
-
-    free(layer_derivatives);
-
 }
 
-void back_propagation(parameters* param, int training_example, int n_layers, int* layer_sizes, double** layer_inputs, double** layer_outputs) {
+void back_propagation(parameters* param, int training_example, int n_layers, int* layer_sizes, training_workspace* ws) {
+    mlp_real** layer_outputs = ws->layer_outputs;
+    mlp_real** local_gradient = ws->local_gradient;
+
     /* ------------------ Expected output ----------------------------------------*/
     // Get the expected output from the data matrix
-    // Create memory for the expected output array
-    // Initialized to zero's
-    double* expected_output = (double*)calloc(param->output_layer_size, sizeof(double));
+    // Reset the expected output array of the workspace to zero's
+    mlp_real* expected_output = ws->expected_output;
+    int i, j;
+    PERF_BEGIN(PERF_DATA_ACCESS);
+    for (i = 0; i < param->output_layer_size; i++)
+        expected_output[i] = 0.0;
 
     // Make the respective element in expected_output to 1 and rest all 0
     // Ex: If y = 3 and output_layer_size = 4 then expected_output = [0, 0, 1, 0]
     if (param->output_layer_size == 1)
-        expected_output[0] = param->data_train[training_example][param->feature_size-1];
+        expected_output[0] = param->data_train.labels[training_example];
     else 
-        expected_output[(int)(param->data_train[training_example][param->feature_size-1] - 1)] = 1;
+        expected_output[(int)(param->data_train.labels[training_example] - 1)] = 1;
+    PERF_END(PERF_DATA_ACCESS);
 
-    /* ---------------------- Weight correction Memory allocation ----------------------------------- */
-    // Create memory for the weight_correction matrices between layers
-    // weight_correction is a pointer to the array of 2D arrays between the layers
-    double*** weight_correction = (double***)calloc(n_layers-1, sizeof(double**));
-
-    // Each 2D array between two layers i and i+1 is of size ((layer_size[i]+1) x layer_size[i+1])
-    // The weight_correction matrix includes weight corrections for the bias terms too
-    int i;
-    for (i = 0; i < n_layers-1; i++)
-        weight_correction[i] = (double**)calloc(layer_sizes[i]+1, sizeof(double*));
-
-    int j;
-    for (i = 0; i < n_layers-1; i++)
-        for (j = 0; j < layer_sizes[i]+1; j++)
-            weight_correction[i][j] = (double*)calloc(layer_sizes[i+1], sizeof(double));
-
-    /* --------------------- Local Gradient memory allocation --------------------------------------*/
-    // Create memory for local gradient (delta) for each layer
-    double** local_gradient = (double**)calloc(n_layers, sizeof(double*));
-
-    for (i = 0; i < n_layers; i++)
-        local_gradient[i] = (double*)calloc(layer_sizes[i], sizeof(double));
+    // The weight_correction matrices between layers have the same layout as the weights, including the bias rows
+    // They hold the gradient of the error of this sample, the optimizer scales it into the update
+    weight_arena* weight_correction = &ws->weight_correction;
 
     /*----------- Calculate weight corrections for all layers' weights -------------------*/
     // Weight correction for the output layer
-    calculate_local_gradient(param, n_layers-1, n_layers, layer_sizes, layer_inputs, layer_outputs, expected_output, local_gradient);
+    TRACE_BEGIN("backward", n_layers-1);
+    PERF_BEGIN(PERF_LOCAL_GRADIENT);
+    calculate_local_gradient(param, n_layers-1, n_layers, layer_sizes, ws);
+    PERF_END(PERF_LOCAL_GRADIENT);
+
+    PERF_BEGIN(PERF_WEIGHT_UPDATE);
+    mlp_real* correction = weight_matrix(weight_correction, n_layers-2);
+    int stride = weight_correction->stride[n_layers-2];
     for (i = 0; i < param->output_layer_size; i++)
         for (j = 0; j < layer_sizes[n_layers-2]+1; j++)
-            weight_correction[n_layers-2][j][i] = (param->learning_rate) * local_gradient[n_layers-1][i] * layer_outputs[n_layers-2][j];
+            correction[j * stride + i] = local_gradient[n_layers-1][i] * layer_outputs[n_layers-2][j];
+    PERF_END(PERF_WEIGHT_UPDATE);
+    TRACE_END();
 
     // Weight correction for the hidden layers
     int k;
     for (i = n_layers-2; i >= 1; i--) {
-        calculate_local_gradient(param, i, n_layers, layer_sizes, layer_inputs, layer_outputs, expected_output, local_gradient);
-
+        TRACE_BEGIN("backward", i);
+        PERF_BEGIN(PERF_LOCAL_GRADIENT);
+        calculate_local_gradient(param, i, n_layers, layer_sizes, ws);
+        PERF_END(PERF_LOCAL_GRADIENT);
+
+        PERF_BEGIN(PERF_WEIGHT_UPDATE);
+        correction = weight_matrix(weight_correction, i-1);
+        stride = weight_correction->stride[i-1];
         for (j = 0; j < layer_sizes[i]; j++) 
             for (k = 0; k < layer_sizes[i-1]+1; k++)
-                weight_correction[i-1][k][j] = (param->learning_rate) * local_gradient[i][j] * layer_outputs[i-1][k];
+                correction[k * stride + j] = local_gradient[i][j] * layer_outputs[i-1][k];
+        PERF_END(PERF_WEIGHT_UPDATE);
+        TRACE_END();
     }
 
     /*----------------- Update the weights -------------------------------------*/
-    for (i = 0; i < n_layers-1; i++) {
-        for (j = 0; j < layer_sizes[i]+1; j++) {
-            for (k = 0; k < layer_sizes[i+1]; k++) {
-                param->weight[i][j][k] -= weight_correction[i][j][k];
-            }
-        }
-    }
-
-
-    // Free the memory allocated in Heap
-    for (i = 0; i < n_layers; i++)
-        free(local_gradient[i]);
-
-    free(local_gradient);
+    // Both arenas share the same layout, so the update runs over the whole block at once
+    // The padding is zero in both and stays zero
+    TRACE_BEGIN("update", -1);
+    PERF_BEGIN(PERF_WEIGHT_UPDATE);
+    update_step step;
+    optimizer_step(&param->moments, param->learning_rate, 1, &step);
+    optimizer_update(&param->moments, &step, &param->weight, weight_correction, 0, weight_correction->size);
+    PERF_END(PERF_WEIGHT_UPDATE);
+    TRACE_END();
+}
 
-    for (i = 0; i < n_layers - 1; i++)
-        for (j = 0; j < layer_sizes[i]+1; j++)
-            free(weight_correction[i][j]);
+void layer_derivative(int activation_function, int layer_size, mlp_real* layer_input, mlp_real* layer_output, mlp_real* layer_derivative) {
+    // Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+    switch (activation_function) {
+        case 1: // identity
+            d_identity(layer_size, layer_input, layer_output, layer_derivative);
+            break;
+        case 2: // sigmoid
+            d_sigmoid(layer_size, layer_input, layer_output, layer_derivative);
+            break;
+        case 3: // tanh
+            d_tanh(layer_size, layer_input, layer_output, layer_derivative);
+            break;
+        case 4: // relu
+            d_relu(layer_size, layer_input, layer_output, layer_derivative);
+            break;
+        case 5: // softmax
+            d_softmax(layer_size, layer_input, layer_output, layer_derivative);
+            break;
+        default:
+            printf("Layer derivative: Invalid activation function\n");
+            exit(0);
+            break;
+    }
+}
 
-    for (i = 0; i < n_layers - 1; i++)
-        free(weight_correction[i]);
+void weight_gradient_batch(parameters* param, int* training_examples, int n_layers, int* layer_sizes, mini_batch* batch) {
+    int m = batch->size;
+    int output_size = param->output_layer_size;
 
-    free(weight_correction);
+    /* ------------------ Expected output ----------------------------------------*/
+    // One row of expected outputs per training example, as in back_propagation
+    int i, j, l;
+    PERF_BEGIN(PERF_DATA_ACCESS);
+    for (i = 0; i < m; i++) {
+        mlp_real* expected_output = batch->expected_output + (size_t)i * output_size;
+        mlp_real y = param->data_train.labels[training_examples[i]];
+        if (output_size == 1)
+            expected_output[0] = y;
+        else {
+            for (j = 0; j < output_size; j++)
+                expected_output[j] = 0.0;
+            expected_output[(int)(y - 1)] = 1;
+        }
+    }
+    PERF_END(PERF_DATA_ACCESS);
+
+    /*----------- Local gradients of the output layer -------------------*/
+    PERF_BEGIN(PERF_LOCAL_GRADIENT);
+    l = n_layers-1;
+    TRACE_BEGIN("backward", l);
+    for (i = 0; i < m; i++) {
+        mlp_real* input = batch->inputs[l] + (size_t)i * output_size;
+        mlp_real* output = batch->outputs[l] + (size_t)i * (output_size+1);
+        mlp_real* expected_output = batch->expected_output + (size_t)i * output_size;
+        mlp_real* local_gradient = batch->local_gradient[l] + (size_t)i * output_size;
+
+        layer_derivative(param->output_activation_function, output_size, input, output, batch->layer_derivative);
+        for (j = 0; j < output_size; j++)
+            local_gradient[j] = (output[j+1] - expected_output[j]) * batch->layer_derivative[j];
+    }
+    TRACE_END();
+
+    /*----------- Local gradients of the hidden layers -------------------*/
+    // The error of a hidden layer is the next layer's local gradients times the transposed weights,
+    // computed for the whole batch as one matrix product
+    for (l = n_layers-2; l >= 1; l--) {
+        TRACE_BEGIN("backward", l);
+        simd->mat_mul_nt(batch->local_gradient[l+1], layer_sizes[l+1], weight_matrix(&param->weight, l), param->weight.stride[l],
+            batch->local_gradient[l], layer_sizes[l], m, layer_sizes[l+1], layer_sizes[l]);
+
+        for (i = 0; i < m; i++) {
+            mlp_real* input = batch->inputs[l] + (size_t)i * layer_sizes[l];
+            mlp_real* output = batch->outputs[l] + (size_t)i * (layer_sizes[l]+1);
+            mlp_real* local_gradient = batch->local_gradient[l] + (size_t)i * layer_sizes[l];
+
+            layer_derivative(param->hidden_activation_functions[l-1], layer_sizes[l], input, output, batch->layer_derivative);
+            for (j = 0; j < layer_sizes[l]; j++)
+                local_gradient[j] *= batch->layer_derivative[j];
+        }
+        TRACE_END();
+    }
+    PERF_END(PERF_LOCAL_GRADIENT);
+
+    /*----------- Weight gradients summed over the batch -------------------*/
+    TRACE_BEGIN("weight gradients", -1);
+    PERF_BEGIN(PERF_WEIGHT_UPDATE);
+    for (l = 0; l < n_layers-1; l++)
+        simd->mat_mul_tn(batch->outputs[l], layer_sizes[l]+1, batch->local_gradient[l+1], layer_sizes[l+1],
+            weight_matrix(&batch->weight_correction, l), batch->weight_correction.stride[l], m, layer_sizes[l]+1, layer_sizes[l+1]);
+    PERF_END(PERF_WEIGHT_UPDATE);
+    TRACE_END();
+}
 
-    free(expected_output);
+void back_propagation_batch(parameters* param, int* training_examples, int n_layers, int* layer_sizes, mini_batch* batch) {
+    int m = batch->size;
+
+    // Weight gradients of the batch, accumulated in batch->weight_correction
+    weight_gradient_batch(param, training_examples, n_layers, layer_sizes, batch);
+
+    /*----------------- Update the weights once for the batch -------------------------------------*/
+    // The gradient is averaged over the batch so the learning rate keeps its per-sample meaning
+    TRACE_BEGIN("update", -1);
+    PERF_BEGIN(PERF_WEIGHT_UPDATE);
+    update_step step;
+    optimizer_step(&param->moments, param->learning_rate, m, &step);
+    optimizer_update(&param->moments, &step, &param->weight, &batch->weight_correction, 0, batch->weight_correction.size);
+    PERF_END(PERF_WEIGHT_UPDATE);
+    TRACE_END();
 }
@@ -4,7 +4,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "parameters.h"
+#include "workspace.h"
+#include "mlp_perf.h"
+#include "mlp_trace.h"
 
-void back_propagation(parameters*, int, int, int*, double**, double**);
+// Derivatives of the activation functions from the inputs and outputs of a layer
+void d_identity(int, mlp_real*, mlp_real*, mlp_real*);
+void d_sigmoid(int, mlp_real*, mlp_real*, mlp_real*);
+void d_tanh(int, mlp_real*, mlp_real*, mlp_real*);
+void d_relu(int, mlp_real*, mlp_real*, mlp_real*);
+void d_softmax(int, mlp_real*, mlp_real*, mlp_real*);
+
+// Local gradients of one layer into the workspace, from those of the next layer
+void calculate_local_gradient(parameters*, int, int, int*, training_workspace*);
+
+void back_propagation(parameters*, int, int, int*, training_workspace*);
+void back_propagation_batch(parameters*, int*, int, int*, mini_batch*);
+void weight_gradient_batch(parameters*, int*, int, int*, mini_batch*);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+/*
+Desc: Tests of the CSV reader: decimals converted exactly as strtod converts them, on the fast paths
+      and on the cases they hand over to strtod, and large files read in parallel row for row as serially
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include "read_csv.h"
+
+#define TEST_SEED 7
+
+// Random decimals of up to 19 significant digits with powers of ten up to 27, the range of the fast paths
+#define TEST_RANDOM_NUMBERS 200000
+
+// .csv file written by the tests and removed afterwards
+#define TEST_CSV "csv_test.csv"
+
+// Columns of the large file, which is a quarter larger than the block read_csv_parallel splits files from
+#define TEST_COLS 6
+#define TEST_LARGE_SIZE (CSV_BLOCK_SIZE + CSV_BLOCK_SIZE / 4)
+
+// Decimals that are hard to round: halfway between two doubles past 2^53, the smallest normal double,
+// 19-digit significands, powers of ten past the exact ones, and signs and zeros
+static const char* hard_numbers[] = {
+    "9007199254740993", "9007199254740995", "9007199254740993000", "90071992547409930e-1", "-9007199254740993",
+    "2.2250738585072011e-308", "2.2250738585072012e-308", "2.2250738585072014e-308", "4.9406564584124654e-324",
+    "1.7976931348623157e308", "9999999999999999999", "1844674407370955161", "1.234567890123456789",
+    "0.1234567890123456789", "9223372036854775807e-27", "9223372036854775807e27", "1000000000000000000e-27",
+    "7450580596923828125e-27", "1e22", "1e23", "3e-23", "123456789012345678e-5", "0.1", "0.3", "2.5e-1",
+    "8.98846567431158e307", "+1.5", "-0", "-0.0e5", "0", "000000000000000000000000001.5", "12345678901234567890"
+};
+#define TEST_HARD_NUMBERS (int)(sizeof(hard_numbers) / sizeof(hard_numbers[0]))
+
+static int failures = 0;
+
+static void check(int ok, const char* name, const char* what) {
+    printf("%s: %s %s\n", ok ? "PASS" : "FAIL", name, what);
+    failures += !ok;
+}
+
+// value is bit for bit the double strtod converts text to, which tells -0 from 0
+static int same_as_strtod(const char* text, double value) {
+    double expected = strtod(text, NULL);
+    if (memcmp(&value, &expected, sizeof(double)) == 0)
+        return 1;
+    printf("%s: %.17g, strtod %.17g\n", text, value, expected);
+    return 0;
+}
+
+// Random uint64_t, rand() only guarantees 15 bits
+static uint64_t random_u64(void) {
+    uint64_t x = 0;
+    int i;
+    for (i = 0; i < 5; i++)
+        x = (x << 15) ^ (uint64_t)rand();
+    return x;
+}
+
+// A random decimal of 1 to 19 digits with the point anywhere, an integer times a power of ten in [1e-27, 1e27]
+static void random_number(char* text, size_t size) {
+    char digits[24];
+    int n = snprintf(digits, sizeof(digits), "%llu", (unsigned long long)(random_u64() % 10000000000000000000ULL));
+    int cut = 1 + rand() % 19;
+    if (n > cut) {
+        n = cut;
+        digits[n] = '\0';
+    }
+    int point = rand() % (n + 1);
+    int exponent = rand() % 55 - 27;
+    snprintf(text, size, "%s%.*s.%se%d", rand() % 2 ? "-" : "", point, digits, digits + point, exponent + n - point);
+}
+
+// One field of the large file: short and 17-digit decimals, spaces around the field, and significands
+// longer than 19 digits that go through strtod
+static void write_field(FILE* fp, int j) {
+    double x = (double)random_u64() / 18446744073709551616.0 - 0.5;
+    switch (rand() % 4) {
+    case 0:
+        fprintf(fp, "%.3f", x);
+        break;
+    case 1:
+        fprintf(fp, "%.17g", x * 1e6);
+        break;
+    case 2:
+        fprintf(fp, "  %.6e ", x);
+        break;
+    default:
+        fprintf(fp, "%.25f", x);
+    }
+    fputs(j < TEST_COLS - 1 ? "," : "", fp);
+}
+
+// Rows of TEST_COLS fields until the file is TEST_LARGE_SIZE bytes, with some blank lines and CRLF line breaks
+static void write_large_csv(const char* filename) {
+    FILE* fp = fopen(filename, "wb");
+    while (ftell(fp) < TEST_LARGE_SIZE) {
+        int j;
+        for (j = 0; j < TEST_COLS; j++)
+            write_field(fp, j);
+        fputs(rand() % 8 ? "\n" : "\r\n", fp);
+        if (rand() % 64 == 0)
+            fputs(rand() % 2 ? "\n" : "   \n", fp);
+    }
+    fclose(fp);
+}
+
+int main(void) {
+    srand(TEST_SEED);
+    char text[64];
+    double value;
+    int i, ok;
+
+    // Whole fields, trimmed, as a line is parsed when its fields do not end at the delimiter
+    ok = 1;
+    for (i = 0; i < TEST_HARD_NUMBERS; i++)
+        ok &= csv_parse_number(hard_numbers[i], hard_numbers[i] + strlen(hard_numbers[i]), &value) &&
+            same_as_strtod(hard_numbers[i], value);
+    check(ok, "csv_parse_number", "converts hard decimals as strtod does");
+
+    ok = 1;
+    for (i = 0; i < TEST_RANDOM_NUMBERS; i++) {
+        random_number(text, sizeof(text));
+        ok &= csv_parse_number(text, text + strlen(text), &value) && same_as_strtod(text, value);
+    }
+    check(ok, "csv_parse_number", "converts random 19-digit decimals as strtod does");
+
+    const char* not_numbers[] = { "", " ", "-", ".", "e5", "1e", "1e+", "1.2.3", "1,5", "0x", "abc" };
+    ok = 1;
+    for (i = 0; i < (int)(sizeof(not_numbers) / sizeof(not_numbers[0])); i++)
+        ok &= !csv_parse_number(not_numbers[i], not_numbers[i] + strlen(not_numbers[i]), &value);
+    check(ok, "csv_parse_number", "rejects text that is not a number");
+
+    // The same decimals as fields of a file, where csv_fast_number converts them straight from the block
+    FILE* fp = fopen(TEST_CSV, "wb");
+    for (i = 0; i < TEST_HARD_NUMBERS; i++)
+        fprintf(fp, "%s,%s\n", hard_numbers[i], hard_numbers[TEST_HARD_NUMBERS - 1 - i]);
+    fclose(fp);
+    int rows, cols;
+    mlp_real** table = read_csv_auto(TEST_CSV, &rows, &cols);
+    ok = rows == TEST_HARD_NUMBERS && cols == 2;
+    for (i = 0; ok && i < rows; i++)
+        ok &= table[i][0] == (mlp_real)strtod(hard_numbers[i], NULL) &&
+            table[i][1] == (mlp_real)strtod(hard_numbers[TEST_HARD_NUMBERS - 1 - i], NULL) &&
+            !signbit(table[i][0]) == !signbit(strtod(hard_numbers[i], NULL));
+    check(ok, "read_csv_auto", "converts hard decimals as strtod does");
+    free_csv(table);
+
+    // A file larger than CSV_BLOCK_SIZE is split into byte ranges, every thread count must give the rows of one thread
+    write_large_csv(TEST_CSV);
+    table = read_csv_auto(TEST_CSV, &rows, &cols);
+    int thread_counts[] = { 2, 3, 8 };
+    int t;
+    for (t = 0; t < 3; t++) {
+        int parallel_rows, parallel_cols;
+        mlp_real** parallel = read_csv_parallel(TEST_CSV, &parallel_rows, &parallel_cols, thread_counts[t]);
+        snprintf(text, sizeof(text), "read_csv_parallel x%d", thread_counts[t]);
+        ok = parallel_rows == rows && parallel_cols == cols;
+        for (i = 0; ok && i < rows; i++)
+            ok &= memcmp(parallel[i], table[i], cols * sizeof(mlp_real)) == 0;
+        check(ok, text, "reads the rows of read_csv_auto");
+        free_csv(parallel);
+    }
+    check(cols == TEST_COLS, "read_csv_auto", "reads every column of the large file");
+    free_csv(table);
+    remove(TEST_CSV);
+
+    printf("%d failed\n", failures);
+    return failures > 0;
+}
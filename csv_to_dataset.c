@@ -0,0 +1,38 @@
+/*
+Desc: Convert a .csv dataset into a binary dataset file, loaded later with dataset_open
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "dataset.h"
+#include "read_csv.h"
+
+int main(int argc, char** argv) {
+    if (argc != 3 && argc != 4) {
+        printf("\nExecution syntax:\n");
+        printf("-----------------\n");
+        printf("Argument 1: Path of the csv file Ex: data/data_train.csv \n");
+        printf("Argument 2: Path of the binary dataset file to write Ex: data/data_train.mlpd \n");
+        printf("Argument 3 (optional): Number of threads parsing the csv file Ex: 8 \n\n");
+        exit(0);
+    }
+
+    int n_threads = argc == 4 ? atoi(argv[3]) : 1;
+
+    // Parse the csv, the output variable is the last column
+    int rows, cols;
+    mlp_real** table = read_csv_parallel(argv[1], &rows, &cols, n_threads);
+    if (cols < 2) {
+        printf("Error: %s needs at least one feature column and the output column\n", argv[1]);
+        exit(0);
+    }
+
+    dataset d;
+    dataset_from_table(&d, table[0], rows, cols);
+    free_csv(table);
+
+    dataset_save(&d, argv[2]);
+    printf("%s: %d rows, %d features, %d classes\n", argv[2], d.n_rows, d.n_features, d.n_classes);
+
+    dataset_destroy(&d);
+    return 0;
+}
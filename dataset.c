@@ -0,0 +1,225 @@
+/*
+Desc: Flat datasets and the binary dataset file, used in place through mmap
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "dataset.h"
+#include <limits.h>
+
+#ifdef DATASET_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static uint64_t align_up(uint64_t offset) {
+    return (offset + WEIGHT_ALIGNMENT - 1) / WEIGHT_ALIGNMENT * WEIGHT_ALIGNMENT;
+}
+
+void dataset_from_table(dataset* d, const mlp_real* table, int n_rows, int cols) {
+    d->n_rows = n_rows;
+    d->n_features = cols - 1;
+
+    // One block for the features and the labels, each starting aligned
+    size_t features_size = (size_t)n_rows * d->n_features * sizeof(mlp_real);
+    size_t labels_offset = align_up(features_size);
+    d->block = mlp_malloc(labels_offset + (size_t)n_rows * sizeof(mlp_real) + WEIGHT_ALIGNMENT);
+    if (NULL == d->block) {
+        printf("Error: Cannot allocate memory for the dataset\n");
+        exit(0);
+    }
+    d->mapping_size = 0;
+
+    mlp_real* features = (mlp_real*)(((uintptr_t)d->block + WEIGHT_ALIGNMENT - 1) & ~(uintptr_t)(WEIGHT_ALIGNMENT - 1));
+    mlp_real* labels = (mlp_real*)((char*)features + labels_offset);
+
+    // The output variable is the last column
+    int i;
+    double smallest = 0, largest = 0;
+    for (i = 0; i < n_rows; i++) {
+        const mlp_real* row = table + (size_t)i * cols;
+        memcpy(features + (size_t)i * d->n_features, row, d->n_features * sizeof(mlp_real));
+        labels[i] = row[cols-1];
+
+        if (i == 0 || labels[i] < smallest)
+            smallest = labels[i];
+        if (i == 0 || labels[i] > largest)
+            largest = labels[i];
+    }
+
+    // Labels are 0 and 1 for binary classification and 1 to k for k classes
+    d->n_classes = smallest == 0 ? (int)largest + 1 : (int)largest;
+
+    d->features = features;
+    d->labels = labels;
+}
+
+static void write_bytes(FILE* fp, const void* data, size_t size, const char* filename) {
+    if (size > 0 && fwrite(data, 1, size, fp) != size) {
+        printf("Error writing %s\n", filename);
+        exit(0);
+    }
+}
+
+void dataset_save(const dataset* d, const char* filename) {
+    // Sections are laid out one after the other, each aligned
+    dataset_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_MAGIC, 4);
+    header.version = DATASET_VERSION;
+    header.real_size = sizeof(mlp_real);
+    header.alignment = WEIGHT_ALIGNMENT;
+    header.n_rows = (uint64_t)d->n_rows;
+    header.n_features = (uint32_t)d->n_features;
+    header.n_classes = (uint32_t)d->n_classes;
+    header.features_offset = align_up(sizeof(dataset_header));
+    header.labels_offset = align_up(header.features_offset + header.n_rows * header.n_features * sizeof(mlp_real));
+    header.file_size = header.labels_offset + header.n_rows * sizeof(mlp_real);
+
+    FILE* fp = fopen(filename, "wb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+
+    static const char padding[WEIGHT_ALIGNMENT];
+    size_t features_size = (size_t)header.n_rows * header.n_features * sizeof(mlp_real);
+    write_bytes(fp, &header, sizeof(header), filename);
+    write_bytes(fp, padding, header.features_offset - sizeof(header), filename);
+    write_bytes(fp, d->features, features_size, filename);
+    write_bytes(fp, padding, header.labels_offset - header.features_offset - features_size, filename);
+    write_bytes(fp, d->labels, (size_t)header.n_rows * sizeof(mlp_real), filename);
+
+    if (fclose(fp) != 0) {
+        printf("Error writing %s\n", filename);
+        exit(0);
+    }
+}
+
+// Check that the header is of a dataset of this build and that its sections lie inside a file of size bytes
+static void dataset_check_header(const dataset_header* header, uint64_t size, const char* filename) {
+    if (size < sizeof(dataset_header) || memcmp(header->magic, DATASET_MAGIC, 4) != 0) {
+        printf("Error: %s is not a dataset file\n", filename);
+        exit(0);
+    }
+    if (header->version != DATASET_VERSION) {
+        printf("Error: %s has dataset version %u, expected %u\n", filename, header->version, DATASET_VERSION);
+        exit(0);
+    }
+    if (header->real_size != sizeof(mlp_real)) {
+        printf("Error: %s has %u-byte values, this build uses %s\n", filename, header->real_size, MLP_REAL_NAME);
+        exit(0);
+    }
+
+    uint64_t n_values = header->n_rows * header->n_features;
+    int valid = header->n_rows <= INT_MAX && header->n_features > 0 && header->n_features <= INT_MAX
+        && header->alignment >= sizeof(mlp_real) && header->alignment % sizeof(mlp_real) == 0
+        && header->features_offset % header->alignment == 0 && header->labels_offset % header->alignment == 0
+        && header->features_offset >= sizeof(dataset_header)
+        && (header->n_rows == 0 || n_values / header->n_rows == header->n_features)
+        && n_values <= (UINT64_MAX - header->features_offset) / sizeof(mlp_real)
+        && header->labels_offset >= header->features_offset + n_values * sizeof(mlp_real)
+        && header->n_rows <= (UINT64_MAX - header->labels_offset) / sizeof(mlp_real)
+        && header->file_size == header->labels_offset + header->n_rows * sizeof(mlp_real)
+        && header->file_size == size;
+    if (!valid) {
+        printf("Error: %s is truncated or corrupt\n", filename);
+        exit(0);
+    }
+}
+
+static void dataset_validate(dataset* d, const char* data, size_t size, const char* filename) {
+    const dataset_header* header = (const dataset_header*)data;
+    dataset_check_header(header, size, filename);
+
+    d->n_rows = (int)header->n_rows;
+    d->n_features = (int)header->n_features;
+    d->n_classes = (int)header->n_classes;
+    d->features = (const mlp_real*)(data + header->features_offset);
+    d->labels = (const mlp_real*)(data + header->labels_offset);
+}
+
+void dataset_open(dataset* d, const char* filename) {
+#ifdef DATASET_MMAP
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    size_t size = (size_t)st.st_size;
+
+    // Pages are read on first use, so opening takes the same time for any size of dataset
+    void* mapping = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        printf("Error: Cannot map the dataset file %s\n", filename);
+        exit(0);
+    }
+
+    d->block = mapping;
+    d->mapping_size = size;
+    dataset_validate(d, (const char*)mapping, size, filename);
+#else
+    FILE* fp = fopen(filename, "rb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t size = (size_t)ftell(fp);
+    rewind(fp);
+
+    // Without mmap the file is read whole into an aligned block, so the sections stay aligned
+    d->block = mlp_malloc(size + WEIGHT_ALIGNMENT);
+    d->mapping_size = 0;
+    char* data = (char*)(((uintptr_t)d->block + WEIGHT_ALIGNMENT - 1) & ~(uintptr_t)(WEIGHT_ALIGNMENT - 1));
+    if (fread(data, 1, size, fp) != size) {
+        printf("Error: Cannot read the dataset file %s\n", filename);
+        exit(0);
+    }
+    fclose(fp);
+
+    dataset_validate(d, data, size, filename);
+#endif
+}
+
+void dataset_read_header(dataset_header* header, const char* filename) {
+    FILE* fp = fopen(filename, "rb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+
+    // A short read leaves the size below the header's, reported as not a dataset
+    memset(header, 0, sizeof(dataset_header));
+    size_t size = fread(header, 1, sizeof(dataset_header), fp);
+    if (size == sizeof(dataset_header)) {
+#ifdef DATASET_MMAP
+        struct stat st;
+        size = fstat(fileno(fp), &st) == 0 ? (size_t)st.st_size : 0;
+#else
+        fseek(fp, 0, SEEK_END);
+        size = (size_t)ftell(fp);
+#endif
+    }
+    fclose(fp);
+
+    dataset_check_header(header, size, filename);
+}
+
+void dataset_destroy(dataset* d) {
+#ifdef DATASET_MMAP
+    if (d->mapping_size > 0)
+        munmap(d->block, d->mapping_size);
+    else
+        mlp_free(d->block);
+#else
+    mlp_free(d->block);
+#endif
+    d->block = NULL;
+    d->features = NULL;
+    d->labels = NULL;
+    d->n_rows = 0;
+}
@@ -0,0 +1,69 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mlp_alloc.h"
+#include "mlp_real.h"
+#include "weight_arena.h"
+
+// Dataset files are mapped with mmap where available, read into memory otherwise
+#if defined(__unix__) || defined(__APPLE__)
+#define DATASET_MMAP 1
+#endif
+
+#define DATASET_MAGIC "MLPD"
+#define DATASET_VERSION 1
+
+// Samples in a flat layout: the input features of all rows in one aligned block and the labels in another
+typedef struct {
+    int n_rows;
+    int n_features;         // Input features per row, without the label
+    int n_classes;          // 2 for labels 0 and 1, k for labels 1, 2, ..., k
+    const mlp_real* features; // n_rows x n_features, row-major, aligned to WEIGHT_ALIGNMENT
+    const mlp_real* labels;   // n_rows, the output variable of every row
+    void* block;            // Memory owned by the dataset, allocated or mapped
+    size_t mapping_size;    // Size of the mapped file, 0 when block is allocated
+} dataset;
+
+// Binary dataset file, in the byte order of the machine that wrote it:
+//   dataset_header
+//   zero padding up to features_offset, a multiple of alignment
+//   mlp_real features[n_rows][n_features]
+//   zero padding up to labels_offset, a multiple of alignment
+//   mlp_real labels[n_rows]
+typedef struct {
+    char magic[4];            // DATASET_MAGIC
+    uint32_t version;         // DATASET_VERSION
+    uint32_t real_size;       // Size of a value in bytes, 8 (double) or 4 (float)
+    uint32_t alignment;       // Alignment of the features and labels offsets
+    uint64_t n_rows;
+    uint32_t n_features;
+    uint32_t n_classes;
+    uint64_t features_offset;
+    uint64_t labels_offset;
+    uint64_t file_size;
+} dataset_header;
+
+// Features of row i
+static inline const mlp_real* dataset_row(const dataset* d, int i) {
+    return d->features + (size_t)i * d->n_features;
+}
+
+// Split a row-major table with the label in its last column, e.g. the block returned by read_csv_auto
+void dataset_from_table(dataset*, const mlp_real*, int, int);
+
+// Write a dataset to a binary dataset file
+void dataset_save(const dataset*, const char*);
+
+// Map a binary dataset file and validate it, the values are used in place without parsing or copying
+void dataset_open(dataset*, const char*);
+
+// Read and validate only the header of a binary dataset file, e.g. to stream the file in parts
+void dataset_read_header(dataset_header*, const char*);
+
+void dataset_destroy(dataset*);
+
+#endif
@@ -0,0 +1,250 @@
+/*
+Desc: Binary dataset file read in shards, the next shard prefetched by a background thread
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "dataset_stream.h"
+
+#ifdef MLP_THREADS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// States of a shard buffer
+#define BUFFER_FREE 0
+#define BUFFER_LOADING 1
+#define BUFFER_READY 2
+#define BUFFER_IN_USE 3
+
+static mlp_real* aligned_start(void* block) {
+    return (mlp_real*)(((uintptr_t)block + WEIGHT_ALIGNMENT - 1) & ~(uintptr_t)(WEIGHT_ALIGNMENT - 1));
+}
+
+static size_t features_bytes(int rows, int n_features) {
+    size_t bytes = (size_t)rows * n_features * sizeof(mlp_real);
+    return (bytes + WEIGHT_ALIGNMENT - 1) / WEIGHT_ALIGNMENT * WEIGHT_ALIGNMENT;
+}
+
+// Read size bytes at offset in the file
+static void read_at(dataset_stream* s, void* data, size_t size, uint64_t offset) {
+#ifdef MLP_THREADS
+    char* p = (char*)data;
+    while (size > 0) {
+        ssize_t n = pread(s->fd, p, size, (off_t)offset);
+        if (n <= 0) {
+            printf("Error: Cannot read %s\n", s->filename);
+            exit(0);
+        }
+        p += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+#else
+    if (fseek(s->fp, (long)offset, SEEK_SET) != 0 || fread(data, 1, size, s->fp) != size) {
+        printf("Error: Cannot read %s\n", s->filename);
+        exit(0);
+    }
+#endif
+}
+
+// Copy the rows of a shard from the file into a buffer
+static void load_shard(dataset_stream* s, int shard, dataset* buffer) {
+    int n_features = (int)s->header.n_features;
+    uint64_t first = (uint64_t)shard * s->shard_rows;
+    int rows = s->header.n_rows - first < (uint64_t)s->shard_rows ? (int)(s->header.n_rows - first) : s->shard_rows;
+
+    mlp_real* features = aligned_start(buffer->block);
+    mlp_real* labels = (mlp_real*)((char*)features + features_bytes(s->shard_rows, n_features));
+    read_at(s, features, (size_t)rows * n_features * sizeof(mlp_real),
+        s->header.features_offset + first * n_features * sizeof(mlp_real));
+    read_at(s, labels, (size_t)rows * sizeof(mlp_real), s->header.labels_offset + first * sizeof(mlp_real));
+
+    buffer->n_rows = rows;
+}
+
+#ifdef MLP_THREADS
+// Background reader: loads the shards of the epoch in order, each into the buffer of its position once it is free
+static void* stream_reader(void* arg) {
+    dataset_stream* s = (dataset_stream*)arg;
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        while (!s->stop && !(s->next_read < s->n_shards && s->state[s->next_read % 2] == BUFFER_FREE))
+            pthread_cond_wait(&s->changed, &s->lock);
+        if (s->stop)
+            break;
+
+        int b = s->next_read % 2;
+        int shard = s->order[s->next_read];
+        s->state[b] = BUFFER_LOADING;
+        pthread_mutex_unlock(&s->lock);
+
+        TRACE_BEGIN("read shard", shard);
+        load_shard(s, shard, &s->buffers[b]);
+        TRACE_END();
+
+        pthread_mutex_lock(&s->lock);
+        s->state[b] = BUFFER_READY;
+        s->next_read++;
+        pthread_cond_broadcast(&s->changed);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return NULL;
+}
+#endif
+
+void dataset_stream_open(dataset_stream* s, const char* filename, size_t memory_budget) {
+    dataset_read_header(&s->header, filename);
+    if (s->header.n_rows == 0) {
+        printf("Error: %s contains no data\n", filename);
+        exit(0);
+    }
+
+    s->filename = (char*)mlp_malloc(strlen(filename) + 1);
+    strcpy(s->filename, filename);
+
+    // Both buffers, each aligned, and the trainer's shuffled order of a shard fit in the budget
+    size_t row_bytes = 2 * ((size_t)s->header.n_features + 1) * sizeof(mlp_real) + sizeof(int);
+    size_t overhead = 4 * WEIGHT_ALIGNMENT;
+    size_t rows = memory_budget > overhead ? (memory_budget - overhead) / row_bytes : 0;
+    if (rows == 0) {
+        printf("Error: A memory budget of %lu bytes cannot hold one row of %s\n", (unsigned long)memory_budget, filename);
+        exit(0);
+    }
+    if (rows > s->header.n_rows)
+        rows = s->header.n_rows;
+    s->shard_rows = (int)rows;
+    s->n_shards = (int)((s->header.n_rows + rows - 1) / rows);
+
+    int b;
+    for (b = 0; b < 2; b++) {
+        dataset* buffer = &s->buffers[b];
+        size_t bytes = features_bytes(s->shard_rows, (int)s->header.n_features) + (size_t)s->shard_rows * sizeof(mlp_real);
+        buffer->block = mlp_malloc(bytes + WEIGHT_ALIGNMENT);
+        if (NULL == buffer->block) {
+            printf("Error: Cannot allocate memory for the shards of %s\n", filename);
+            exit(0);
+        }
+        buffer->mapping_size = 0;
+        buffer->n_rows = 0;
+        buffer->n_features = (int)s->header.n_features;
+        buffer->n_classes = (int)s->header.n_classes;
+        buffer->features = aligned_start(buffer->block);
+        buffer->labels = (const mlp_real*)((const char*)buffer->features + features_bytes(s->shard_rows, buffer->n_features));
+        s->state[b] = BUFFER_FREE;
+    }
+
+    // No epoch until dataset_stream_start
+    s->order = (int*)mlp_calloc(s->n_shards, sizeof(int));
+    s->next_read = s->n_shards;
+    s->next_use = s->n_shards;
+    s->in_use = -1;
+
+#ifdef MLP_THREADS
+    s->fd = open(filename, O_RDONLY);
+    if (s->fd < 0) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+
+    s->stop = 0;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->changed, NULL);
+    if (pthread_create(&s->reader, NULL, stream_reader, s) != 0) {
+        printf("Error: Cannot create the dataset reader thread\n");
+        exit(0);
+    }
+#else
+    s->fp = fopen(filename, "rb");
+    if (NULL == s->fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+#endif
+}
+
+void dataset_stream_start(dataset_stream* s, const int* order) {
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&s->lock);
+
+    // A shard still being read belongs to the previous epoch, wait for it and drop it
+    while (s->state[0] == BUFFER_LOADING || s->state[1] == BUFFER_LOADING)
+        pthread_cond_wait(&s->changed, &s->lock);
+#endif
+
+    s->state[0] = s->state[1] = BUFFER_FREE;
+    s->in_use = -1;
+    memcpy(s->order, order, s->n_shards * sizeof(int));
+    s->next_read = 0;
+    s->next_use = 0;
+
+#ifdef MLP_THREADS
+    pthread_cond_broadcast(&s->changed);
+    pthread_mutex_unlock(&s->lock);
+#endif
+}
+
+const dataset* dataset_stream_next(dataset_stream* s) {
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&s->lock);
+
+    // The trainer is done with the previous shard, its buffer can take the one after next
+    if (s->in_use >= 0) {
+        s->state[s->in_use] = BUFFER_FREE;
+        s->in_use = -1;
+        pthread_cond_broadcast(&s->changed);
+    }
+    if (s->next_use == s->n_shards) {
+        pthread_mutex_unlock(&s->lock);
+        return NULL;
+    }
+
+    // Wait for the reader, usually done already while the previous shard trained
+    int b = s->next_use % 2;
+    PERF_BEGIN(PERF_DATA_ACCESS);
+    TRACE_BEGIN("wait for shard", s->order[s->next_use]);
+    while (s->state[b] != BUFFER_READY)
+        pthread_cond_wait(&s->changed, &s->lock);
+    TRACE_END();
+    PERF_END(PERF_DATA_ACCESS);
+    s->state[b] = BUFFER_IN_USE;
+    s->in_use = b;
+    s->next_use++;
+
+    pthread_mutex_unlock(&s->lock);
+    return &s->buffers[b];
+#else
+    if (s->next_use == s->n_shards)
+        return NULL;
+
+    // Without threads the shard is read now
+    PERF_BEGIN(PERF_DATA_ACCESS);
+    TRACE_BEGIN("read shard", s->order[s->next_use]);
+    load_shard(s, s->order[s->next_use++], &s->buffers[0]);
+    TRACE_END();
+    PERF_END(PERF_DATA_ACCESS);
+    return &s->buffers[0];
+#endif
+}
+
+void dataset_stream_close(dataset_stream* s) {
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&s->lock);
+    s->stop = 1;
+    pthread_cond_broadcast(&s->changed);
+    pthread_mutex_unlock(&s->lock);
+
+    pthread_join(s->reader, NULL);
+    pthread_cond_destroy(&s->changed);
+    pthread_mutex_destroy(&s->lock);
+    close(s->fd);
+#else
+    fclose(s->fp);
+#endif
+
+    dataset_destroy(&s->buffers[0]);
+    dataset_destroy(&s->buffers[1]);
+    mlp_free(s->order);
+    mlp_free(s->filename);
+}
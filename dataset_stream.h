@@ -0,0 +1,55 @@
+#ifndef DATASET_STREAM_H
+#define DATASET_STREAM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "dataset.h"
+#include "mlp_alloc.h"
+#include "thread_pool.h"
+#include "mlp_perf.h"
+#include "mlp_trace.h"
+
+#ifdef MLP_THREADS
+#include <pthread.h>
+#endif
+
+// A binary dataset file read in shards of consecutive rows, for datasets larger than memory
+// Two shard buffers take turns: while the trainer uses one, a background thread reads the next
+// shard of the epoch into the other. Without threads, each shard is read when it is requested
+typedef struct {
+    char* filename;
+    dataset_header header;
+    int shard_rows;     // Rows per shard, the last shard may be smaller
+    int n_shards;
+    dataset buffers[2]; // The two shard buffers, rows of the file copied in
+    int* order;         // Shards of the current epoch in the order they are used
+    int next_read;      // Position in order of the next shard to read
+    int next_use;       // Position in order of the next shard handed to the trainer
+    int state[2];       // State of each buffer (free, loading, ready or in use)
+    int in_use;         // Buffer held by the trainer, -1 if none
+#ifdef MLP_THREADS
+    int fd;
+    pthread_t reader;
+    pthread_mutex_t lock;
+    pthread_cond_t changed; // Signalled whenever a buffer changes state or a new epoch starts
+    int stop;
+#else
+    FILE* fp;
+#endif
+} dataset_stream;
+
+// Open a binary dataset file for streaming, with shards sized so that both buffers
+// together take at most memory_budget bytes
+void dataset_stream_open(dataset_stream*, const char*, size_t);
+
+// Start an epoch over the shards in the given order (n_shards entries)
+// The shard buffer still held from the previous epoch is released
+void dataset_stream_start(dataset_stream*, const int*);
+
+// The next shard of the epoch, as a dataset of its rows, valid until the next call
+// Returns NULL after the last shard of the epoch
+const dataset* dataset_stream_next(dataset_stream*);
+
+void dataset_stream_close(dataset_stream*);
+
+#endif
@@ -5,7 +5,12 @@
 #include <stdlib.h>
 #include <math.h>
 #include "parameters.h"
+#include "mini_batch.h"
+#include "simd_kernels.h"
+#include "mlp_perf.h"
+#include "mlp_trace.h"
 
-void forward_propagation(parameters*, int, int, int*, double**, double**);
+void forward_propagation(parameters*, int, int, int*, mlp_real**, mlp_real**);
+void forward_propagation_batch(parameters*, int*, int, int*, mini_batch*);
 
 #endif
\ No newline at end of file
@@ -86,6 +86,7 @@ void platform_init(void);
 #define HAL_rx65n 26
 #define HAL_mpc5676r 27
 #define HAL_neorv32  28
+#define HAL_host     29 // Linux or macOS, see host_hal.h
 
 #if HAL_TYPE == HAL_avr
     #include <avr/io.h>
@@ -155,6 +156,8 @@ void platform_init(void);
     #include "neorv32/neorv32_hal.h"
 #elif HAL_TYPE == HAL_sam4s
     #include "sam4s/sam4s_hal.h"
+#elif HAL_TYPE == HAL_host
+    #include "host_hal.h"
 #else
     #error "Unsupported HAL Type"
 #endif
@@ -0,0 +1,158 @@
+/*
+Desc: SimpleSerial transport of the firmware built for a Linux or macOS host (HAL_TYPE=HAL_host)
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#define _GNU_SOURCE
+#include "host_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define HOST_BUFFER_SIZE 4096
+
+// File descriptors of the transport, -1 until a client is connected
+static int rx_fd = -1;
+static int tx_fd = -1;
+static int listen_fd = -1; // Unix socket transport only
+static int pty_slave = -1; // pty transport only, kept open so the master does not see a hang-up between clients
+
+static unsigned char rx_buffer[HOST_BUFFER_SIZE];
+static int rx_length = 0, rx_next = 0;
+static unsigned char tx_buffer[HOST_BUFFER_SIZE];
+static int tx_length = 0;
+
+void platform_init(void) {
+    // A client going away while a reply is written is not an error of the firmware
+    signal(SIGPIPE, SIG_IGN);
+}
+
+static void flush_tx(void) {
+    int sent = 0;
+    while (sent < tx_length && tx_fd >= 0) {
+        ssize_t n = write(tx_fd, tx_buffer + sent, tx_length - sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break; // The client is gone, its replies are dropped
+        sent += (int)n;
+    }
+    tx_length = 0;
+}
+
+static void open_stdio(void) {
+    // Keep the frames on their own descriptor and send everything printed to stderr
+    rx_fd = dup(STDIN_FILENO);
+    tx_fd = dup(STDOUT_FILENO);
+    fflush(stdout);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+}
+
+static void open_pty(void) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        printf("Error: Cannot create a pseudo-terminal (%s)\n", strerror(errno));
+        exit(0);
+    }
+
+    // Raw bytes both ways: no echo, no line editing and no translation of 0x00 or newlines
+    const char* name = ptsname(master);
+    pty_slave = open(name, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (pty_slave < 0 || tcgetattr(pty_slave, &tio) != 0) {
+        printf("Error: Cannot open the pseudo-terminal %s (%s)\n", name, strerror(errno));
+        exit(0);
+    }
+    cfmakeraw(&tio);
+    tcsetattr(pty_slave, TCSANOW, &tio);
+
+    rx_fd = tx_fd = master;
+    fprintf(stderr, "SimpleSerial on %s\n", name);
+}
+
+static void open_unix(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("Error: Socket path %s is too long\n", path);
+        exit(0);
+    }
+    strcpy(addr.sun_path, path);
+
+    unlink(path);
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, 1) != 0) {
+        printf("Error: Cannot listen on %s (%s)\n", path, strerror(errno));
+        exit(0);
+    }
+    fprintf(stderr, "SimpleSerial on unix:%s\n", path);
+}
+
+void init_uart(void) {
+    const char* transport = getenv("SS_TRANSPORT");
+    if (NULL == transport || transport[0] == '\0' || strcmp(transport, "stdio") == 0)
+        open_stdio();
+    else if (strcmp(transport, "pty") == 0)
+        open_pty();
+    else if (strncmp(transport, "unix:", 5) == 0)
+        open_unix(transport + 5);
+    else {
+        printf("Error: Invalid value %s for SS_TRANSPORT\n", transport);
+        printf("Input either stdio or pty or unix:<path> for SS_TRANSPORT\n");
+        exit(0);
+    }
+}
+
+void putch(char c) {
+    if (tx_length == HOST_BUFFER_SIZE)
+        flush_tx();
+    tx_buffer[tx_length++] = (unsigned char)c;
+}
+
+char getch(void) {
+    while (rx_next == rx_length) {
+        // The reply to the last command is complete once the firmware waits for input
+        flush_tx();
+
+        if (rx_fd < 0) {
+            // Wait for the next client of the Unix socket
+            rx_fd = accept(listen_fd, NULL, NULL);
+            tx_fd = rx_fd;
+            continue;
+        }
+
+        ssize_t n = read(rx_fd, rx_buffer, HOST_BUFFER_SIZE);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n > 0) {
+            rx_length = (int)n;
+            rx_next = 0;
+        }
+        else if (listen_fd >= 0) {
+            // The client hung up, serve the next one
+            close(rx_fd);
+            rx_fd = tx_fd = -1;
+        }
+        else
+            exit(0); // End of stdin, or the pty was closed
+    }
+
+    return (char)rx_buffer[rx_next++];
+}
+
+void trigger_setup(void) {
+}
+
+void trigger_high(void) {
+}
+
+void trigger_low(void) {
+}
@@ -0,0 +1,27 @@
+/*
+Desc: SimpleSerial transport of the firmware built for a Linux or macOS host (HAL_TYPE=HAL_host)
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+
+// The transport is picked at init_uart() by the SS_TRANSPORT environment variable:
+//   stdio (default)  frames on stdin and stdout, anything printed goes to stderr instead
+//   pty              a pseudo-terminal standing in for the UART, its device name is printed on stderr
+//   unix:<path>      a Unix socket listening at path, serving one client after another
+// ss_client sends commands over any of them and measures the round trips
+void init_uart(void);
+
+// Bytes written are buffered and sent once the firmware waits for the next byte
+void putch(char c);
+char getch(void);
+
+// There is no trigger pin on the host
+void trigger_setup(void);
+void trigger_high(void);
+void trigger_low(void);
+
+#endif
@@ -0,0 +1,35 @@
+/*
+Desc: Kernels of every layer chosen once per model
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "layer_plan.h"
+
+void layer_plan_create(layer_plan* plan, int n_hidden, int* hidden_activation_functions, int output_activation_function, int accuracy) {
+    // The accuracy indexes the tiers of the sigmoid, tanh and softmax kernels
+    if (accuracy < 0 || accuracy >= ACTIVATION_TIERS) {
+        printf("Error: Invalid activation accuracy %d, use ACTIVATION_EXACT, ACTIVATION_FAST or ACTIVATION_FASTEST\n", accuracy);
+        exit(0);
+    }
+
+    plan->n_layers = n_hidden + 1;
+    plan->activation = (activation_kernel*)mlp_calloc(plan->n_layers, sizeof(activation_kernel));
+    plan->dense = (dense_kernel*)mlp_calloc(plan->n_layers, sizeof(dense_kernel));
+
+    // Hidden layers, then the output layer
+    int i;
+    for (i = 0; i < plan->n_layers; i++) {
+        int activation_function = i < n_hidden ? hidden_activation_functions[i] : output_activation_function;
+        plan->activation[i] = simd_activation(activation_function, accuracy);
+        plan->dense[i] = simd_dense(activation_function, accuracy);
+    }
+}
+
+void layer_plan_destroy(layer_plan* plan) {
+    mlp_free(plan->dense);
+    mlp_free(plan->activation);
+
+    plan->n_layers = 0;
+    plan->activation = NULL;
+    plan->dense = NULL;
+}
@@ -0,0 +1,23 @@
+#ifndef LAYER_PLAN_H
+#define LAYER_PLAN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mlp_alloc.h"
+#include "simd_kernels.h"
+
+// Kernels of every layer of a model, resolved once from its activation functions and accuracy tier
+// so forward passes call them directly instead of switching on the activation of each layer
+// Entry i is the layer between layers i and i+1
+typedef struct {
+    int n_layers;                  // Layers with weights (n_hidden + 1), 0 until created
+    activation_kernel* activation; // Activation of the layer, for training which keeps the pre-activations
+    dense_kernel* dense;           // Matrix product fused with the activation, for inference
+} layer_plan;
+
+// Resolve the kernels from the hidden activation functions, the output activation function and the accuracy tier
+// The kernels are those selected by simd_init(), which is called first
+void layer_plan_create(layer_plan*, int, int*, int, int);
+void layer_plan_destroy(layer_plan*);
+
+#endif
@@ -0,0 +1,48 @@
+/*
+Desc: Buffers holding the activations and gradients of a mini-batch
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mini_batch.h"
+
+void mini_batch_create(mini_batch* batch, int capacity, int n_layers, int* layer_sizes) {
+    batch->capacity = capacity;
+    batch->size = 0;
+
+    // Create memory for the matrices of inputs, outputs and local gradients of the layers
+    batch->inputs = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+    batch->outputs = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+    batch->local_gradient = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+
+    int i, widest = 0;
+    for (i = 0; i < n_layers; i++) {
+        batch->inputs[i] = (mlp_real*)mlp_calloc((size_t)capacity * layer_sizes[i], sizeof(mlp_real));
+        batch->outputs[i] = (mlp_real*)mlp_calloc((size_t)capacity * (layer_sizes[i]+1), sizeof(mlp_real));
+        batch->local_gradient[i] = (mlp_real*)mlp_calloc((size_t)capacity * layer_sizes[i], sizeof(mlp_real));
+        widest = layer_sizes[i] > widest ? layer_sizes[i] : widest;
+    }
+
+    batch->layer_derivative = (mlp_real*)mlp_calloc(widest, sizeof(mlp_real));
+    batch->expected_output = (mlp_real*)mlp_calloc((size_t)capacity * layer_sizes[n_layers-1], sizeof(mlp_real));
+
+    // Gradients of the weights have the same layout as the weights
+    weight_arena_create(&batch->weight_correction, n_layers, layer_sizes);
+}
+
+void mini_batch_destroy(mini_batch* batch, int n_layers) {
+    weight_arena_destroy(&batch->weight_correction);
+
+    mlp_free(batch->expected_output);
+    mlp_free(batch->layer_derivative);
+
+    int i;
+    for (i = 0; i < n_layers; i++) {
+        mlp_free(batch->local_gradient[i]);
+        mlp_free(batch->outputs[i]);
+        mlp_free(batch->inputs[i]);
+    }
+
+    mlp_free(batch->local_gradient);
+    mlp_free(batch->outputs);
+    mlp_free(batch->inputs);
+}
@@ -0,0 +1,25 @@
+#ifndef MINI_BATCH_H
+#define MINI_BATCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mlp_alloc.h"
+#include "weight_arena.h"
+
+// Buffers for training on a mini-batch of samples at once
+// Every per-layer buffer is a row-major matrix with one row per sample of the batch
+typedef struct {
+    int capacity;             // Maximum number of samples in a batch
+    int size;                 // Number of samples in the current batch
+    mlp_real** inputs;          // inputs[l]: size x layer_sizes[l], inputs to layer l
+    mlp_real** outputs;         // outputs[l]: size x (layer_sizes[l]+1), outputs of layer l with the bias in column 0
+    mlp_real** local_gradient;  // local_gradient[l]: size x layer_sizes[l], local gradients (delta) of layer l
+    mlp_real* layer_derivative; // Derivatives of the activation function for one sample of the widest layer
+    mlp_real* expected_output;  // size x output_layer_size, expected outputs of the batch
+    weight_arena weight_correction; // Weight gradients summed over the batch
+} mini_batch;
+
+void mini_batch_create(mini_batch*, int, int, int*);
+void mini_batch_destroy(mini_batch*, int);
+
+#endif
@@ -0,0 +1,26 @@
+/*
+Desc: Counted heap allocation
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_alloc.h"
+
+static unsigned long heap_allocations = 0;
+
+void* mlp_malloc(size_t size) {
+    ++heap_allocations;
+    return malloc(size);
+}
+
+void* mlp_calloc(size_t n, size_t size) {
+    ++heap_allocations;
+    return calloc(n, size);
+}
+
+void mlp_free(void* ptr) {
+    free(ptr);
+}
+
+unsigned long mlp_heap_allocations(void) {
+    return heap_allocations;
+}
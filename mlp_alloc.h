@@ -0,0 +1,15 @@
+#ifndef MLP_ALLOC_H
+#define MLP_ALLOC_H
+
+#include <stdlib.h>
+
+// Heap allocation of the training code goes through these functions so that
+// allocations can be counted, e.g. to check that none happen inside the epoch loop
+void* mlp_malloc(size_t);
+void* mlp_calloc(size_t, size_t);
+void mlp_free(void*);
+
+// Number of allocations made through mlp_malloc and mlp_calloc since the start of the program
+unsigned long mlp_heap_allocations(void);
+
+#endif
@@ -0,0 +1,408 @@
+/*
+Desc: Microbenchmarks of the forward and backward hot paths, results written as JSON
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include <string.h>
+#include <time.h>
+#include "forward_propagation.h"
+#include "back_propagation.h"
+#include "workspace.h"
+
+// Every measurement is the median of BENCH_SAMPLES samples, each of enough calls to last BENCH_MIN_TIME seconds
+#define BENCH_SAMPLES 7
+#define BENCH_MIN_TIME 0.02
+
+// Layer widths from 4 up to the maximum width, multiplied by 4 each step
+#define BENCH_MIN_WIDTH 4
+#define BENCH_MAX_WIDTH 4096
+
+// Batch sizes of the batched kernels, run on widths up to BENCH_BATCH_WIDTH
+#define BENCH_N_BATCHES 3
+#define BENCH_BATCH_WIDTH 1024
+static const int bench_batches[BENCH_N_BATCHES] = { 8, 32, 128 };
+
+// Compiler flags of the build, recorded with the results
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS ""
+#endif
+#ifdef __VERSION__
+#define BENCH_COMPILER __VERSION__
+#else
+#define BENCH_COMPILER "unknown"
+#endif
+
+// Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+static const char* activation_names[6] = { "", "identity", "sigmoid", "tanh", "relu", "softmax" };
+// Nominal operations per element of each activation and of its derivative, exp and tanh counting as one
+static const int activation_flops[6] = { 0, 0, 3, 1, 1, 4 };
+static const int derivative_flops[6] = { 0, 0, 2, 2, 1, 2 };
+static const char* tier_names[ACTIVATION_TIERS] = { "exact", "fast", "fastest" };
+
+// Weight update of every optimizer: operations and values read or written per weight, sqrt counting as one
+static const char* optimizer_names[OPTIMIZERS] = { "sgd", "momentum", "nesterov", "rmsprop", "adam" };
+static const int update_flops[OPTIMIZERS] = { 2, 4, 6, 10, 14 };
+static const int update_reals[OPTIMIZERS] = { 3, 5, 5, 5, 7 };
+
+// A network of three layers of the same width: input, a sigmoid hidden layer and a softmax output,
+// with every buffer a kernel works on
+typedef struct {
+    int width;
+    int layer_sizes[3];
+    int hidden_layers_size[1];
+    int hidden_activation_functions[1];
+    parameters param;
+    training_workspace ws;
+    mini_batch batch;       // Only created for widths up to BENCH_BATCH_WIDTH
+    optimizer_state adam;   // Both averages an update kernel reads and writes
+    update_step step;       // Coefficients of the timed updates
+    int indices[128];       // Training examples of a batch, the largest in bench_batches
+} bench_network;
+
+// Arguments of the kernel being timed
+typedef struct {
+    bench_network* net;
+    int batch;
+    int activation;
+    int tier;
+    int optimizer;
+} bench_case;
+
+typedef void (*bench_fn)(bench_case*);
+
+static double now(void) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+// Deterministic values in [-scale, scale], the same on every run
+static void fill(mlp_real* a, size_t n, double scale, unsigned int* seed) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        *seed = *seed * 1103515245u + 12345u;
+        a[i] = (mlp_real)(scale * (((*seed >> 8) & 0xffff) / 32767.5 - 1.0));
+    }
+}
+
+static void bench_network_create(bench_network* net, int width) {
+    memset(net, 0, sizeof(bench_network));
+    net->width = width;
+    net->layer_sizes[0] = net->layer_sizes[1] = net->layer_sizes[2] = width;
+    net->hidden_layers_size[0] = width;
+    net->hidden_activation_functions[0] = 2;
+
+    parameters* param = &net->param;
+    param->n_hidden = 1;
+    param->hidden_layers_size = net->hidden_layers_size;
+    param->hidden_activation_functions = net->hidden_activation_functions;
+    param->output_layer_size = width;
+    param->output_activation_function = 5;
+    param->activation_accuracy = ACTIVATION_EXACT;
+    param->batch_size = 1;
+    // Small enough that the repeated updates of a measurement leave the weights in range
+    param->learning_rate = 1e-6;
+
+    // Weights scaled by the fan-in, so the layer inputs stay in the range of the activations
+    unsigned int seed = 1;
+    weight_arena_create(&param->weight, 3, net->layer_sizes);
+    layer_plan_create(&param->plan, param->n_hidden, param->hidden_activation_functions, param->output_activation_function,
+        param->activation_accuracy);
+    optimizer_create(&param->moments, OPTIMIZER_SGD, 0, 0, 3, net->layer_sizes);
+    optimizer_create(&net->adam, OPTIMIZER_ADAM, 0, 0, 3, net->layer_sizes);
+    // Adam moves every weight by about the learning rate per update, kept small for the millions of timed updates
+    optimizer_step(&net->adam, 1e-9, 1, &net->step);
+    int i, j;
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < width+1; j++)
+            fill(weight_matrix(&param->weight, i) + (size_t)j * param->weight.stride[i], width, 1.0 / width, &seed);
+
+    // Training examples with random features and labels spread over all the classes
+    int rows = sizeof(net->indices) / sizeof(net->indices[0]);
+    mlp_real* table = (mlp_real*)mlp_calloc((size_t)rows * (width+1), sizeof(mlp_real));
+    for (i = 0; i < rows; i++) {
+        fill(table + (size_t)i * (width+1), width, 1.0, &seed);
+        table[(size_t)i * (width+1) + width] = 1 + i % width;
+        net->indices[i] = i;
+    }
+    dataset_from_table(&param->data_train, table, rows, width+1);
+    mlp_free(table);
+
+    training_workspace_create(&net->ws, param, 3, net->layer_sizes);
+    for (i = 0; i < 3; i++) {
+        fill(net->ws.layer_inputs[i], width, 4.0, &seed);
+        net->ws.layer_outputs[i][0] = 1;
+        simd->sigmoid[ACTIVATION_EXACT](width, net->ws.layer_inputs[i], net->ws.layer_outputs[i]);
+        fill(net->ws.local_gradient[i], width, 1.0, &seed);
+    }
+
+    net->batch.capacity = 0;
+    if (width <= BENCH_BATCH_WIDTH) {
+        mini_batch_create(&net->batch, rows, 3, net->layer_sizes);
+        net->batch.size = rows;
+        forward_propagation_batch(param, net->indices, 3, net->layer_sizes, &net->batch);
+    }
+}
+
+static void bench_network_destroy(bench_network* net) {
+    if (net->batch.capacity > 0)
+        mini_batch_destroy(&net->batch, 3);
+    training_workspace_destroy(&net->ws, 3);
+    dataset_destroy(&net->param.data_train);
+    optimizer_destroy(&net->adam);
+    optimizer_destroy(&net->param.moments);
+    layer_plan_destroy(&net->param.plan);
+    weight_arena_destroy(&net->param.weight);
+}
+
+/*----------------- Kernels being timed -------------------------------------*/
+// Forward product of the hidden layer: (1 x width+1) * (width+1 x width)
+static void run_mat_mul(bench_case* c) {
+    bench_network* net = c->net;
+    simd->mat_mul(net->ws.layer_outputs[0], weight_matrix(&net->param.weight, 0), net->param.weight.stride[0],
+        net->ws.layer_inputs[1], net->width+1, net->width);
+}
+
+// The same product for a batch: (batch x width+1) * (width+1 x width)
+static void run_mat_mul_batch(bench_case* c) {
+    bench_network* net = c->net;
+    simd->mat_mul_batch(net->batch.outputs[0], net->width+1, weight_matrix(&net->param.weight, 0), net->param.weight.stride[0],
+        net->batch.inputs[1], net->width, c->batch, net->width+1, net->width);
+}
+
+// The product and the sigmoid of the hidden layer as training computes them, the pre-activations stored
+static void run_unfused_batch(bench_case* c) {
+    bench_network* net = c->net;
+    simd->mat_mul_batch(net->batch.outputs[0], net->width+1, weight_matrix(&net->param.weight, 0), net->param.weight.stride[0],
+        net->batch.inputs[1], net->width, c->batch, net->width+1, net->width);
+    int i;
+    for (i = 0; i < c->batch; i++)
+        simd->sigmoid[ACTIVATION_EXACT](net->width, net->batch.inputs[1] + (size_t)i * net->width,
+            net->batch.outputs[1] + (size_t)i * (net->width+1));
+}
+
+// The same layer as inference computes it, one dense kernel with the sigmoid in its epilogue
+static void run_dense_batch(bench_case* c) {
+    bench_network* net = c->net;
+    net->param.plan.dense[0](net->batch.outputs[0], net->width+1, weight_matrix(&net->param.weight, 0), net->param.weight.stride[0],
+        net->batch.outputs[1], net->width+1, c->batch, net->width+1, net->width);
+}
+
+static void run_activation(bench_case* c) {
+    bench_network* net = c->net;
+    mlp_real* input = net->ws.layer_inputs[1];
+    mlp_real* output = net->ws.layer_outputs[1];
+    switch (c->activation) {
+        case 1: simd->identity(net->width, input, output); break;
+        case 2: simd->sigmoid[c->tier](net->width, input, output); break;
+        case 3: simd->tan_h[c->tier](net->width, input, output); break;
+        case 4: simd->relu(net->width, input, output); break;
+        case 5: simd->softmax[c->tier](net->width, input, output); break;
+    }
+}
+
+static void run_derivative(bench_case* c) {
+    bench_network* net = c->net;
+    mlp_real* input = net->ws.layer_inputs[1];
+    mlp_real* output = net->ws.layer_outputs[1];
+    mlp_real* derivative = net->ws.layer_derivatives[1];
+    switch (c->activation) {
+        case 1: d_identity(net->width, input, output, derivative); break;
+        case 2: d_sigmoid(net->width, input, output, derivative); break;
+        case 3: d_tanh(net->width, input, output, derivative); break;
+        case 4: d_relu(net->width, input, output, derivative); break;
+        case 5: d_softmax(net->width, input, output, derivative); break;
+    }
+}
+
+// Local gradients of the hidden layer from those of the output layer
+static void run_local_gradient(bench_case* c) {
+    bench_network* net = c->net;
+    calculate_local_gradient(&net->param, 1, 3, net->layer_sizes, &net->ws);
+}
+
+// Backward pass of one sample and the weight update
+static void run_back_propagation(bench_case* c) {
+    bench_network* net = c->net;
+    back_propagation(&net->param, 0, 3, net->layer_sizes, &net->ws);
+}
+
+// Backward pass of a batch and one weight update, after a forward pass of the batch done once
+static void run_back_propagation_batch(bench_case* c) {
+    bench_network* net = c->net;
+    net->batch.size = c->batch;
+    back_propagation_batch(&net->param, net->indices, 3, net->layer_sizes, &net->batch);
+}
+
+// Update of every weight of the network by the kernel of one optimizer, from the gradient left by back_propagation
+static void run_update(bench_case* c) {
+    bench_network* net = c->net;
+    mlp_real* velocity = c->optimizer == OPTIMIZER_SGD || c->optimizer == OPTIMIZER_RMSPROP ? NULL : net->adam.velocity.data;
+    mlp_real* square = c->optimizer == OPTIMIZER_RMSPROP || c->optimizer == OPTIMIZER_ADAM ? net->adam.square.data : NULL;
+    simd->update[c->optimizer](net->param.weight.size, net->param.weight.data, net->ws.weight_correction.data,
+        velocity, square, &net->step);
+}
+
+/*----------------- Measurement and report -------------------------------------*/
+static double time_calls(bench_fn fn, bench_case* c, long calls) {
+    long i;
+    double start = now();
+    for (i = 0; i < calls; i++)
+        fn(c);
+    return now() - start;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Median and minimum time of one call in nanoseconds
+static void measure(bench_fn fn, bench_case* c, double* median, double* best) {
+    // Double the number of calls until a sample lasts long enough, which also warms up the caches
+    long calls = 1;
+    while (time_calls(fn, c, calls) < BENCH_MIN_TIME && calls < (1L << 30))
+        calls *= 2;
+
+    double samples[BENCH_SAMPLES];
+    int i;
+    for (i = 0; i < BENCH_SAMPLES; i++)
+        samples[i] = time_calls(fn, c, calls) / calls * 1e9;
+    qsort(samples, BENCH_SAMPLES, sizeof(double), compare_doubles);
+
+    *median = samples[BENCH_SAMPLES / 2];
+    *best = samples[0];
+}
+
+// Time one kernel and write its result; flops and bytes are the work of one call, bytes the
+// minimum data it has to read and write once
+static void bench(FILE* json, int* n_results, const char* kernel, const char* variant, bench_fn fn, bench_case* c,
+    double flops, double bytes) {
+    double median, best;
+    measure(fn, c, &median, &best);
+
+    printf("%-26s %-8s width %5d batch %4d  %12.1f ns/op  %8.3f GFLOP/s  %8.3f GB/s\n",
+        kernel, variant, c->net->width, c->batch, median, flops / median, bytes / median);
+
+    fprintf(json, "%s\n    {\"kernel\": \"%s\", \"variant\": \"%s\", \"width\": %d, \"batch\": %d, "
+        "\"ns_per_op\": %.1f, \"ns_per_op_min\": %.1f, \"flops_per_op\": %.0f, \"gflops\": %.4f, "
+        "\"bytes_per_op\": %.0f, \"gbytes_per_s\": %.4f}",
+        *n_results > 0 ? "," : "", kernel, variant, c->net->width, c->batch,
+        median, best, flops, flops / median, bytes, bytes / median);
+    (*n_results)++;
+}
+
+static void bench_width(FILE* json, int* n_results, int width) {
+    bench_network net;
+    bench_network_create(&net, width);
+
+    double w = width;
+    double real = sizeof(mlp_real);
+    // Weights of the network, two matrices of (width+1) x width
+    double n_weights = 2 * (w+1) * w;
+
+    bench_case c = { &net, 1, 0, ACTIVATION_EXACT, OPTIMIZER_SGD };
+    bench(json, n_results, "mat_mul", "", run_mat_mul, &c, 2 * (w+1) * w, ((w+1) + (w+1) * w + w) * real);
+
+    int a, t;
+    for (a = 1; a <= 5; a++) {
+        c.activation = a;
+        // sigmoid, tanh and softmax have one kernel per accuracy tier
+        int n_tiers = a == 2 || a == 3 || a == 5 ? ACTIVATION_TIERS : 1;
+        for (t = 0; t < n_tiers; t++) {
+            c.tier = t;
+            bench(json, n_results, activation_names[a], n_tiers > 1 ? tier_names[t] : "", run_activation, &c,
+                activation_flops[a] * w, (w + w+1) * real);
+        }
+        c.tier = ACTIVATION_EXACT;
+
+        // d_identity only writes, d_relu reads the inputs and the others the outputs
+        char name[16];
+        sprintf(name, "d_%s", activation_names[a]);
+        bench(json, n_results, name, "", run_derivative, &c, derivative_flops[a] * w, (a == 1 ? w : 2 * w) * real);
+    }
+
+    // Error of every hidden unit summed over the next layer, times the sigmoid derivative
+    bench(json, n_results, "calculate_local_gradient", "", run_local_gradient, &c,
+        2 * w * w + 3 * w, (w * w + 4 * w) * real);
+
+    // Local gradients of both layers, a correction for every weight, and the update: the corrections
+    // are written and read back and the weights read and written, the hidden error reads one matrix again
+    bench(json, n_results, "back_propagation", "", run_back_propagation, &c,
+        3 * n_weights + 2 * w * w + 7 * w, (4 * n_weights + w * w + 6 * w) * real);
+
+    // The update of each optimizer, one fused pass over the weights, the gradient and the averages it keeps
+    int o;
+    for (o = 0; o < OPTIMIZERS; o++) {
+        c.optimizer = o;
+        bench(json, n_results, "update", optimizer_names[o], run_update, &c,
+            update_flops[o] * n_weights, update_reals[o] * n_weights * real);
+    }
+
+    if (net.batch.capacity > 0) {
+        int b;
+        for (b = 0; b < BENCH_N_BATCHES; b++) {
+            double m = bench_batches[b];
+            c.batch = bench_batches[b];
+            bench(json, n_results, "mat_mul_batch", "", run_mat_mul_batch, &c,
+                2 * m * (w+1) * w, (m * (w+1) + (w+1) * w + m * w) * real);
+            // Hidden layer with its sigmoid, the pre-activations written and read back or kept in registers
+            bench(json, n_results, "mat_mul_batch+sigmoid", "", run_unfused_batch, &c,
+                2 * m * (w+1) * w + activation_flops[2] * m * w, (m * (w+1) + (w+1) * w + 2 * m * w + m * (w+1)) * real);
+            bench(json, n_results, "dense_sigmoid", "", run_dense_batch, &c,
+                2 * m * (w+1) * w + activation_flops[2] * m * w, (m * (w+1) + (w+1) * w + m * (w+1)) * real);
+            // The hidden error and the weight gradients are matrix products over the batch
+            bench(json, n_results, "back_propagation_batch", "", run_back_propagation_batch, &c,
+                2 * m * n_weights + 2 * m * w * w + 7 * m * w + 2 * n_weights,
+                (4 * n_weights + w * w + 2 * m * (w+1) + 4 * m * w) * real);
+        }
+    }
+
+    bench_network_destroy(&net);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 3) {
+        printf("\nExecution syntax:\n");
+        printf("-----------------\n");
+        printf("Argument 1 (optional): Path of the JSON file to write the results to Ex: bench.json \n");
+        printf("Argument 2 (optional): Largest layer width, widths go from 4 up by factors of 4 Ex: 4096 \n\n");
+        exit(0);
+    }
+
+    const char* filename = argc > 1 ? argv[1] : "bench.json";
+    int max_width = argc > 2 ? atoi(argv[2]) : BENCH_MAX_WIDTH;
+
+    // Kernels of the widest instruction set, capped by MLP_SIMD
+    simd_init();
+
+    FILE* json = fopen(filename, "w");
+    if (NULL == json) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+
+    fprintf(json, "{\n  \"simd\": \"%s\",\n  \"real\": \"%s\",\n  \"compiler\": \"%s\",\n  \"cflags\": \"%s\",\n",
+        simd->name, MLP_REAL_NAME, BENCH_COMPILER, BENCH_CFLAGS);
+    fprintf(json, "  \"samples\": %d,\n  \"min_sample_seconds\": %g,\n  \"results\": [", BENCH_SAMPLES, BENCH_MIN_TIME);
+
+    printf("Kernels: %s, %s\n", simd->name, MLP_REAL_NAME);
+
+    int n_results = 0;
+    int width;
+    for (width = BENCH_MIN_WIDTH; width <= max_width; width *= 4)
+        bench_width(json, &n_results, width);
+
+    fprintf(json, "\n  ]\n}\n");
+    if (fclose(json) != 0) {
+        printf("Error writing %s\n", filename);
+        exit(0);
+    }
+
+    printf("%d results written to %s\n", n_results, filename);
+    return 0;
+}
@@ -9,165 +9,45 @@ GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
 #include "simpleserial.h"
 #include "hal.h"
 
-#define max(x, y) (x > y ? x : y)
-
-void mat_mul_classify(double* a, double** b, double* result, int n, int p) {
-    // matrix a of size 1 x n (array)
-    // matrix b of size n x p
-    // matrix result of size 1 x p (array)
-    // result = a * b
-    int j, k;
-    for (j = 0; j < p; j++) {
-        result[j] = 0.0;
-        for (k = 0; k < n; k++)
-            result[j] += (a[k] * b[k][j]);
-    }
-}
-
-void identity_classify(int n, double* input, double* output) {
-    output[0] = 1; // Bias term
-
-    int i;
-    for (i = 0; i < n; i++) 
-        output[i+1] = input[i]; // Identity function
-}
-
-void sigmoid_classify(int n, double* input, double* output) {
-    output[0] = 1; // Bias term
-
-    int i;
-    for (i = 0; i < n; i++) 
-        output[i+1] = 1.0 / (1.0 + exp(-input[i])); // Sigmoid function
-}
-
-void tan_h_classify(int n, double* input, double* output) {
-    output[0] = 1; // Bias term
-
-    int i;
-    for (i = 0; i < n; i++) 
-        output[i+1] = tanh(input[i]); // tanh function
-}
-
-void relu_classify(int n, double* input, double* output) {
-    output[0] = 1; // Bias term
-
-    int i;
-    for (i = 0; i < n; i++) 
-        output[i+1] = max(0.0, input[i]); // ReLU function
-}
-
-void softmax_classify(int n, double* input, double* output) {
-    output[0] = 1; // Bias term
-
-    int i;
-    double sum = 0.0;
-    for (i = 0; i < n; i++)
-        sum += exp(input[i]);
-
-    for (i = 0; i < n; i++) 
-        output[i+1] = exp(input[i]) / sum; // Softmax function
-}
-
 uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
     int n_layers = param->n_hidden + 2;
 
-    // Create memory for arrays of inputs to the layers
-    double** layer_inputs = (double**)calloc(n_layers, sizeof(double*));
-
-    int i;
-    for (i = 0; i < n_layers; i++)
-        layer_inputs[i] = (double*)calloc(layer_sizes[i], sizeof(double));
-
-    // Create memory for arrays of outputs from the layers
-    double** layer_outputs = (double**)calloc(n_layers, sizeof(double*));
-
-    for (i = 0; i < n_layers; i++)
-        layer_outputs[i] = (double*)calloc(layer_sizes[i]+1, sizeof(double));
+    // Pick the kernels for this CPU, and those of every layer
+    simd_init();
+    layer_plan_create(&param->plan, param->n_hidden, param->hidden_activation_functions, param->output_activation_function,
+        param->activation_accuracy);
 
     // Create memory to store final outputs
-    double** final_output = (double**)calloc(param->test_sample_size, sizeof(double*));
-    for (i = 0; i < param->test_sample_size; i++)
-        final_output[i] = (double*)calloc(param->output_layer_size, sizeof(double));
-
+    mlp_real** final_output = (mlp_real**)calloc(param->data_test.n_rows, sizeof(mlp_real*));
+    int i;
+    for (i = 0; i < param->data_test.n_rows; i++)
+        final_output[i] = (mlp_real*)calloc(param->output_layer_size, sizeof(mlp_real));
+
+    // Create the pool of threads and a block of layer activations for each thread
+    int n_threads = param->n_threads > 1 ? param->n_threads : 1;
+    thread_pool* pool = thread_pool_create(n_threads);
+    n_threads = thread_pool_size(pool);
+
+    int block_size = param->data_test.n_rows < INFERENCE_BLOCK ? param->data_test.n_rows : INFERENCE_BLOCK;
+    if (block_size < 1)
+        block_size = 1;
+    inference_block* blocks = (inference_block*)calloc(n_threads, sizeof(inference_block));
+    for (i = 0; i < n_threads; i++)
+        inference_block_create(&blocks[i], block_size, n_layers, layer_sizes);
+
+    // Classify the test dataset, each layer one matrix product over a block of test samples
+    TRACE_BEGIN("classify", param->data_test.n_rows);
+    trigger_high();
+    mlp_classify_batch(param, layer_sizes, param->data_test.features, param->data_test.n_rows, pool, blocks, final_output);
+    trigger_low();
+    TRACE_END();
+    PERF_REPORT("Classification");
 
-    // Classify the test dataset on the test samples
     int test_example;
-    for (test_example = 0; test_example < param->test_sample_size; test_example++) {
-        printf("Classifying test example %d of %d\r", test_example+1, param->test_sample_size);
-        // Fill the input layer's input and output (both are equal) from data_test matrix for the given test example
-        layer_outputs[0][0] = 1; // Bias term of input layer
-        for (i = 0; i < param->feature_size-1; i++)
-            layer_outputs[0][i+1] = layer_inputs[0][i] = param->data_test[test_example][i];
-
-        // Perform forward propagation for each hidden layer
-        // Calculate input and output of each hidden layer
-        trigger_high();
-        for (i = 1; i < n_layers-1; i++) {
-            // Compute layer_inputs[i]
-            mat_mul_classify(layer_outputs[i-1], param->weight[i-1], layer_inputs[i], layer_sizes[i-1]+1, layer_sizes[i]);
-
-            // Compute layer_outputs[i]
-            // Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
-            switch (param->hidden_activation_functions[i-1]) {
-                case 1: // identity
-                    identity_classify(layer_sizes[i], layer_inputs[i], layer_outputs[i]);
-                    break;
-                case 2: // sigmoid
-                    sigmoid_classify(layer_sizes[i], layer_inputs[i], layer_outputs[i]);
-                    break;
-                case 3: // tanh
-                    tan_h_classify(layer_sizes[i], layer_inputs[i], layer_outputs[i]);
-                    break;
-                case 4: // relu
-                    relu_classify(layer_sizes[i], layer_inputs[i], layer_outputs[i]);
-                    break;
-                case 5: // softmax
-                    softmax_classify(layer_sizes[i], layer_inputs[i], layer_outputs[i]);
-                    break;
-                default:
-                    printf("Forward propagation: Invalid hidden activation function\n");
-                    exit(0);
-                    break;
-            }
-        }
-        trigger_low();
-
-        // Fill the output layers's input and output
-        mat_mul_classify(layer_outputs[n_layers-2], param->weight[n_layers-2], layer_inputs[n_layers-1], layer_sizes[n_layers-2]+1, layer_sizes[n_layers-1]);
-
-        // Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
-        switch (param->output_activation_function) {
-            case 1: // identity
-                identity_classify(layer_sizes[n_layers-1], layer_inputs[n_layers-1], layer_outputs[n_layers-1]);
-                break;
-            case 2: // sigmoid
-                sigmoid_classify(layer_sizes[n_layers-1], layer_inputs[n_layers-1], layer_outputs[n_layers-1]);
-                break;
-            case 3: // tanh
-                tan_h_classify(layer_sizes[n_layers-1], layer_inputs[n_layers-1], layer_outputs[n_layers-1]);
-                break;
-            case 4: // relu
-                relu_classify(layer_sizes[n_layers-1], layer_inputs[n_layers-1], layer_outputs[n_layers-1]);
-                break;
-            case 5: // softmax
-                softmax_classify(layer_sizes[n_layers-1], layer_inputs[n_layers-1], layer_outputs[n_layers-1]);
-                break;
-            default:
-                printf("Forward propagation: Invalid hidden activation function\n");
-                exit(0);
-                break;
-        }
-
-        // Save the computed output into a output matrix
-        // Final computed output is present in layer_outputs[n_layers-1] from index 1
-        for (i = 0; i < param->output_layer_size; i++)
-            final_output[test_example][i] = layer_outputs[n_layers-1][i+1];
-    }
-
     //simpleserial_put('r', 1, (uint8_t*)final_output[0]);
     // Find the output class for each test example
     if (param->output_layer_size == 1) { // Binary classification
-        for (test_example = 0; test_example < param->test_sample_size; test_example++) {
+        for (test_example = 0; test_example < param->data_test.n_rows; test_example++) {
             if (final_output[test_example][0] < 0.5)
                 final_output[test_example][0] = 0;
             else
@@ -175,7 +55,7 @@ uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
         }
     }
     else { // Multi-class classification
-        for (test_example = 0; test_example < param->test_sample_size; test_example++) {
+        for (test_example = 0; test_example < param->data_test.n_rows; test_example++) {
             double max = -1;
             int max_class;
             for (i = 0; i < param->output_layer_size; i++) {
@@ -193,15 +73,15 @@ uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
     // Calculate the confusion matrix
     if (param->output_layer_size == 1) { // Binary classification
         int true_positive = 0, true_negative = 0, false_positive = 0, false_negative = 0;
-        for (test_example = 0; test_example < param->test_sample_size; test_example++) {
+        for (test_example = 0; test_example < param->data_test.n_rows; test_example++) {
             if (final_output[test_example][0] == 0) {
-                if (param->data_test[test_example][param->feature_size-1] == 0)
+                if (param->data_test.labels[test_example] == 0)
                     ++true_negative;
                 else
                     ++false_positive;
             }
             else {
-                if (param->data_test[test_example][param->feature_size-1] == 1)
+                if (param->data_test.labels[test_example] == 1)
                     ++true_positive;
                 else
                     ++false_negative;
@@ -209,7 +89,7 @@ uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
         }
 
         // Find the accuracy
-        accuracy = (double)(true_positive + true_negative) / param->test_sample_size;
+        accuracy = (double)(true_positive + true_negative) / param->data_test.n_rows;
 
         // Print confusion matrix
         //printf("\n\nConfusion matrix\n");
@@ -230,8 +110,8 @@ uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
 
         // Fill the confusion matrix
         int actual_class, predicted_class;
-        for (test_example = 0; test_example < param->test_sample_size; test_example++) {
-            actual_class = param->data_test[test_example][param->feature_size-1] - 1;
+        for (test_example = 0; test_example < param->data_test.n_rows; test_example++) {
+            actual_class = param->data_test.labels[test_example] - 1;
             predicted_class = final_output[test_example][0] - 1;
 
             ++confusion_matrix[actual_class][predicted_class];
@@ -253,7 +133,7 @@ uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
         // Find the accuracy
         for (i = 0; i < param->output_layer_size; i++)
             accuracy += confusion_matrix[i][i];
-        accuracy /= param->test_sample_size;
+        accuracy /= param->data_test.n_rows;
 
         // Print the accuracy
         //printf("\nAccuracy: %.2lf\n\n", accuracy * 100);
@@ -266,23 +146,22 @@ uint8_t mlp_classifier(parameters* param, int* layer_sizes) {
 
     // Write the final output into a csv file
     //char* output_file_name = "data/data_test_output.csv";
-    //write_csv(output_file_name, param->test_sample_size, param->output_layer_size, final_output);
+    //write_csv(output_file_name, param->data_test.n_rows, param->output_layer_size, final_output);
 
     // Free the memory allocated in Heap
-    for (i = 0; i < param->test_sample_size; i++)
+    for (i = 0; i < param->data_test.n_rows; i++)
         free(final_output[i]);
 
     free(final_output);
 
-    for (i = 0; i < n_layers; i++)
-        free(layer_outputs[i]);
+    for (i = 0; i < n_threads; i++)
+        inference_block_destroy(&blocks[i], n_layers);
 
-    free(layer_outputs);
+    free(blocks);
 
-    for (i = 0; i < n_layers; i++)
-        free(layer_inputs[i]);
+    thread_pool_destroy(pool);
 
-    free(layer_inputs);
+    layer_plan_destroy(&param->plan);
     
     uint8_t accuracy_uint8 = (uint8_t)(accuracy * 100);
     return accuracy_uint8;
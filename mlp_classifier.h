@@ -1,12 +1,18 @@
 #ifndef MLP_CLASSIFIER_H
 #define MLP_CLASSIFIER_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include "read_csv.h"
 #include "write_csv.h"
 #include "parameters.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+#include "mlp_inference.h"
+#include "mlp_perf.h"
+#include "mlp_trace.h"
 
 uint8_t mlp_classifier(parameters*, int*);
 
@@ -0,0 +1,245 @@
+/*
+Desc: Generate a C forward pass specialized to the topology, activations and weights of a model file
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_model.h"
+#include "weight_arena.h"
+
+// Layers with at most this many weights are unrolled into one statement per neuron,
+// larger ones become loops with constant bounds
+#ifndef CODEGEN_UNROLL
+#define CODEGEN_UNROLL 1024
+#endif
+
+// Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+static const char* activation_names[] = { "none", "identity", "sigmoid", "tanh", "relu", "softmax" };
+
+// Write statement once per element first to n-1 of an array, with every # replaced by the index:
+// one statement per element when unrolled, one loop over j otherwise
+static void emit_each(FILE* fp, int unroll, int first, int n, const char* statement) {
+    int i;
+    const char* c;
+    if (!unroll)
+        fprintf(fp, "    for (j = %d; j < %d; j++)\n    ", first, n);
+    for (i = first; i < (unroll ? n : first + 1); i++) {
+        fprintf(fp, "    ");
+        for (c = statement; *c != '\0'; c++) {
+            if (*c != '#')
+                fputc(*c, fp);
+            else if (unroll)
+                fprintf(fp, "%d", i);
+            else
+                fputc('j', fp);
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+// Weight matrix between layers i and i+1 as a constant array, row 0 holding the bias weights
+static void emit_weights(FILE* fp, const weight_arena* w, int i) {
+    // Enough digits for the weights to read back exactly
+    int digits = sizeof(mlp_real) == sizeof(float) ? 9 : 17;
+    const mlp_real* matrix = weight_matrix(w, i);
+
+    fprintf(fp, "static const mlp_real w%d[%d][%d] = {\n", i+1, w->rows[i], w->cols[i]);
+    int j, k;
+    for (j = 0; j < w->rows[i]; j++) {
+        fprintf(fp, "    {");
+        for (k = 0; k < w->cols[i]; k++)
+            fprintf(fp, "%s%.*g", k > 0 ? ", " : "", digits, (double)matrix[(size_t)j * w->stride[i] + k]);
+        fprintf(fp, "}%s\n", j < w->rows[i]-1 ? "," : "");
+    }
+    fprintf(fp, "};\n\n");
+}
+
+// Layer i (1 to n_layers-1) of the forward pass: the products with its weights in the same order as
+// mat_mul_batch (bias first, then every input), followed by the activation function in place
+static void emit_layer(FILE* fp, int i, int n_in, int n_out, int activation, const char* in, const char* out) {
+    int unroll = (n_in + 1) * n_out <= CODEGEN_UNROLL;
+    char statement[256];
+    int j, k;
+
+    fprintf(fp, "    // Layer %d: %d inputs, %d neurons, %s\n", i, n_in, n_out, activation_names[activation]);
+    if (unroll)
+        for (j = 0; j < n_out; j++) {
+            fprintf(fp, "    %s[%d] = w%d[0][%d]", out, j, i, j);
+            for (k = 0; k < n_in; k++)
+                fprintf(fp, "%s+ %s[%d] * w%d[%d][%d]", k % 4 == 3 ? "\n        " : " ", in, k, i, k+1, j);
+            fprintf(fp, ";\n");
+        }
+    else {
+        snprintf(statement, sizeof(statement), "%s[#] = w%d[0][#];", out, i);
+        emit_each(fp, 0, 0, n_out, statement);
+        fprintf(fp, "    for (k = 0; k < %d; k++)\n", n_in);
+        fprintf(fp, "        for (j = 0; j < %d; j++)\n", n_out);
+        fprintf(fp, "            %s[j] += %s[k] * w%d[k+1][j];\n", out, in, i);
+    }
+
+    switch (activation) {
+        case 1: // identity
+            break;
+        case 2: // sigmoid
+            snprintf(statement, sizeof(statement), "%s[#] = 1 / (1 + real_exp(-%s[#]));", out, out);
+            emit_each(fp, unroll, 0, n_out, statement);
+            break;
+        case 3: // tanh
+            snprintf(statement, sizeof(statement), "%s[#] = real_tanh(%s[#]);", out, out);
+            emit_each(fp, unroll, 0, n_out, statement);
+            break;
+        case 4: // relu
+            snprintf(statement, sizeof(statement), "%s[#] = %s[#] > 0 ? %s[#] : 0;", out, out, out);
+            emit_each(fp, unroll, 0, n_out, statement);
+            break;
+        case 5: // softmax, shifted by the largest input like softmax_scalar
+            fprintf(fp, "    largest = %s[0];\n", out);
+            snprintf(statement, sizeof(statement), "largest = %s[#] > largest ? %s[#] : largest;", out, out);
+            emit_each(fp, unroll, 1, n_out, statement);
+            fprintf(fp, "    sum = 0;\n");
+            snprintf(statement, sizeof(statement), "%s[#] = real_exp(%s[#] - largest);", out, out);
+            emit_each(fp, unroll, 0, n_out, statement);
+            snprintf(statement, sizeof(statement), "sum += %s[#];", out);
+            emit_each(fp, unroll, 0, n_out, statement);
+            snprintf(statement, sizeof(statement), "%s[#] /= sum;", out);
+            emit_each(fp, unroll, 0, n_out, statement);
+            break;
+        default:
+            printf("Error: Layer %d has the invalid activation function %d\n", i, activation);
+            exit(0);
+    }
+    fprintf(fp, "\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3 && argc != 4) {
+        printf("\nExecution syntax:\n");
+        printf("-----------------\n");
+        printf("Argument 1: Model file written by model_save() Ex: model.bin \n");
+        printf("Argument 2: C file to write, its header is written next to it with the extension .h Ex: mlp_generated.c \n");
+        printf("Argument 3 (optional): Prefix of the generated names Ex: mlp_generated \n\n");
+        exit(0);
+    }
+
+    const char* prefix = argc == 4 ? argv[3] : "mlp_generated";
+    size_t len = strlen(argv[2]);
+    if (len < 3 || strcmp(argv[2] + len - 2, ".c") != 0) {
+        printf("Error: %s should be a .c file\n", argv[2]);
+        exit(0);
+    }
+
+    // Names of the header, the header guard and the macros
+    char* header_path = strdup(argv[2]);
+    header_path[len-1] = 'h';
+    const char* header_name = strrchr(header_path, '/') != NULL ? strrchr(header_path, '/') + 1 : header_path;
+    char* upper = strdup(prefix);
+    char* c;
+    for (c = upper; *c != '\0'; c++)
+        *c = (*c >= 'a' && *c <= 'z') ? *c - 'a' + 'A' : *c;
+
+    // The model is validated, and its weights laid out, exactly as for inference
+    mlp_model model;
+    model_open(&model, argv[1]);
+    int n_layers = (int)model.header->n_layers;
+    int* layer_sizes = (int*)malloc(n_layers * sizeof(int));
+    int i;
+    for (i = 0; i < n_layers; i++)
+        layer_sizes[i] = model.layer_sizes[i];
+    weight_arena w;
+    weight_arena_attach(&w, n_layers, layer_sizes, model.weights);
+
+    // Only the activation functions the generator knows are emitted
+    for (i = 1; i < n_layers; i++)
+        if (model.activations[i] < 1 || model.activations[i] > 5) {
+            printf("Error: Layer %d has the invalid activation function %d\n", i, model.activations[i]);
+            exit(0);
+        }
+
+    // Topology and activations as in the description of model_blob.h
+    char topology[512];
+    int n = snprintf(topology, sizeof(topology), "%d", layer_sizes[0]);
+    for (i = 1; i < n_layers && n < (int)sizeof(topology); i++)
+        n += snprintf(topology + n, sizeof(topology) - n, "-%d", layer_sizes[i]);
+    char activations[512];
+    n = 0;
+    activations[0] = '\0';
+    for (i = 1; i < n_layers-1 && n < (int)sizeof(activations); i++)
+        n += snprintf(activations + n, sizeof(activations) - n, "%s%s", i > 1 ? ", " : "", activation_names[model.activations[i]]);
+
+    // Header: the sizes of the network and the forward pass
+    FILE* fp = fopen(header_path, "w");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", header_path);
+        exit(0);
+    }
+    fprintf(fp, "/*\nDesc: Forward pass of %s generated by mlp_codegen, do not edit\n", argv[1]);
+    fprintf(fp, "      Network %s (%s; %s output)\n", topology, activations, activation_names[model.activations[n_layers-1]]);
+    fprintf(fp, "GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c\n*/\n\n");
+    fprintf(fp, "#ifndef %s_H\n#define %s_H\n\n#include \"mlp_real.h\"\n\n", upper, upper);
+    fprintf(fp, "#define %s_INPUTS %d\n", upper, layer_sizes[0]);
+    fprintf(fp, "#define %s_OUTPUTS %d\n", upper, layer_sizes[n_layers-1]);
+    fprintf(fp, "// Checksum of the model file, as reported for a resident model\n");
+    fprintf(fp, "#define %s_CHECKSUM 0x%016llxULL\n\n", upper, (unsigned long long)model.header->checksum);
+    fprintf(fp, "// Forward pass of one sample of %s_INPUTS features, the network outputs are written to output\n", upper);
+    fprintf(fp, "// Returns its class (0 or 1 for a single output, 1 to k for k outputs)\n");
+    fprintf(fp, "int %s_classify(const mlp_real*, mlp_real*);\n\n#endif\n", prefix);
+    fclose(fp);
+
+    // Source: the weights as constant arrays, which stay in flash, and the unrolled forward pass
+    fp = fopen(argv[2], "w");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", argv[2]);
+        exit(0);
+    }
+    fprintf(fp, "/*\nDesc: Forward pass of %s generated by mlp_codegen, do not edit\n", argv[1]);
+    fprintf(fp, "      Regenerate with: ./mlp_codegen %s %s %s\n", argv[1], argv[2], prefix);
+    fprintf(fp, "GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c\n*/\n\n");
+    fprintf(fp, "#include \"%s\"\n\n", header_name);
+    fprintf(fp, "// Weight matrix i sits between layers i-1 and i, row 0 holding the bias weights\n");
+    for (i = 0; i < n_layers-1; i++)
+        emit_weights(fp, &w, i);
+
+    fprintf(fp, "int %s_classify(const mlp_real* features, mlp_real* output) {\n", prefix);
+    for (i = 1; i < n_layers-1; i++)
+        fprintf(fp, "    mlp_real a%d[%d];\n", i, layer_sizes[i]);
+    int has_softmax = 0, has_loops = 0;
+    for (i = 1; i < n_layers; i++) {
+        has_softmax |= model.activations[i] == 5;
+        has_loops |= (layer_sizes[i-1] + 1) * layer_sizes[i] > CODEGEN_UNROLL;
+    }
+    if (has_softmax)
+        fprintf(fp, "    mlp_real largest, sum;\n");
+    if (has_loops)
+        fprintf(fp, "    int j, k;\n");
+    fprintf(fp, "\n");
+
+    char in[16], out[16];
+    for (i = 1; i < n_layers; i++) {
+        snprintf(in, sizeof(in), i == 1 ? "features" : "a%d", i-1);
+        snprintf(out, sizeof(out), i == n_layers-1 ? "output" : "a%d", i);
+        emit_layer(fp, i, layer_sizes[i-1], layer_sizes[i], model.activations[i], in, out);
+    }
+
+    // Binary classification thresholds the single output, multi-class takes the largest output
+    int n_outputs = layer_sizes[n_layers-1];
+    if (n_outputs == 1)
+        fprintf(fp, "    return output[0] < 0.5 ? 0 : 1;\n}\n");
+    else {
+        fprintf(fp, "    int predicted_class = 1;\n");
+        for (i = 1; i < n_outputs; i++)
+            fprintf(fp, "    if (output[%d] > output[predicted_class-1])\n        predicted_class = %d;\n", i, i+1);
+        fprintf(fp, "    return predicted_class;\n}\n");
+    }
+    fclose(fp);
+
+    int n_weights = 0;
+    for (i = 0; i < n_layers-1; i++)
+        n_weights += w.rows[i] * w.cols[i];
+    printf("%s, %s: network %s, %d weights\n", argv[2], header_path, topology, n_weights);
+
+    weight_arena_destroy(&w);
+    model_close(&model);
+    free(layer_sizes);
+    free(upper);
+    free(header_path);
+    return 0;
+}
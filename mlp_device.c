@@ -0,0 +1,189 @@
+/*
+Desc: Model kept resident in the firmware between SimpleSerial commands, loaded once and classified many times
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_device.h"
+
+uint8_t device_model_load(device_model* dm, const void* data, size_t size, int source) {
+    // Validate before anything of the resident model is touched
+    mlp_model model;
+    if (!model_open_buffer(&model, data, size))
+        return DEVICE_ERR_INVALID_MODEL;
+    int n_layers = (int)model.header->n_layers;
+    if (n_layers > DEVICE_MAX_LAYERS) {
+        printf("Error: The model has %d layers, at most %d are supported\n", n_layers, DEVICE_MAX_LAYERS);
+        return DEVICE_ERR_INVALID_MODEL;
+    }
+
+    device_model_unload(dm);
+    dm->model = model;
+    dm->n_layers = n_layers;
+
+    // The network is configured from the topology and activations stored in the model
+    int i;
+    for (i = 0; i < n_layers; i++)
+        dm->layer_sizes[i] = model.layer_sizes[i];
+    for (i = 1; i < n_layers-1; i++) {
+        dm->hidden_layers_size[i-1] = model.layer_sizes[i];
+        dm->hidden_activation_functions[i-1] = model.activations[i];
+    }
+
+    parameters* param = &dm->param;
+    memset(param, 0, sizeof(parameters));
+    param->n_hidden = n_layers - 2;
+    param->hidden_layers_size = dm->hidden_layers_size;
+    param->hidden_activation_functions = dm->hidden_activation_functions;
+    param->output_layer_size = model.layer_sizes[n_layers-1];
+    param->output_activation_function = model.activations[n_layers-1];
+
+    // Classify on a single thread with the exact activation functions
+    param->parallel_mode = TRAIN_SERIAL;
+    param->n_threads = 1;
+    param->batch_size = 1;
+    param->activation_accuracy = ACTIVATION_EXACT;
+
+    // The weights are used in place, and the kernels of every layer and the buffers of one sample are set up once
+    model_attach(&dm->model, param, dm->layer_sizes);
+    layer_plan_create(&param->plan, param->n_hidden, param->hidden_activation_functions, param->output_activation_function,
+        param->activation_accuracy);
+    inference_block_create(&dm->block, 1, n_layers, dm->layer_sizes);
+    dm->output = (mlp_real*)mlp_calloc(param->output_layer_size, sizeof(mlp_real));
+    dm->row = (mlp_real*)mlp_calloc(dm->layer_sizes[0] + 1, sizeof(mlp_real));
+
+    dm->source = source;
+    return 0;
+}
+
+void device_model_unload(device_model* dm) {
+    if (dm->source == DEVICE_MODEL_NONE)
+        return;
+
+    mlp_free(dm->row);
+    mlp_free(dm->output);
+    inference_block_destroy(&dm->block, dm->n_layers);
+    layer_plan_destroy(&dm->param.plan);
+    weight_arena_destroy(&dm->param.weight);
+    model_close(&dm->model);
+
+    dm->output = NULL;
+    dm->row = NULL;
+    dm->source = DEVICE_MODEL_NONE;
+}
+
+uint8_t device_upload_begin(device_model* dm, uint32_t size) {
+    if (size == 0 || size > DEVICE_MODEL_MAX) {
+        dm->upload_size = 0;
+        return DEVICE_ERR_TOO_LARGE;
+    }
+
+    // The buffer is about to be overwritten, so an uploaded model cannot stay resident
+    if (dm->source == DEVICE_MODEL_UPLOADED)
+        device_model_unload(dm);
+
+    dm->upload_size = size;
+    dm->upload_received = 0;
+    return 0;
+}
+
+uint8_t device_upload_chunk(device_model* dm, const uint8_t* data, int len) {
+    if (dm->upload_size == 0)
+        return DEVICE_ERR_PAYLOAD;
+    if (dm->upload_received + (uint32_t)len > dm->upload_size)
+        return DEVICE_ERR_TOO_LARGE;
+
+    memcpy(dm->upload + dm->upload_received, data, len);
+    dm->upload_received += len;
+    return 0;
+}
+
+uint8_t device_upload_finish(device_model* dm) {
+    if (dm->upload_size == 0 || dm->upload_received != dm->upload_size)
+        return DEVICE_ERR_PAYLOAD;
+
+    uint32_t size = dm->upload_size;
+    dm->upload_size = 0;
+    return device_model_load(dm, dm->upload, size, DEVICE_MODEL_UPLOADED);
+}
+
+static void device_quantized_unload(device_model* dm) {
+    if (!dm->quantized_loaded)
+        return;
+
+    mlp_free(dm->quantized_output);
+    quantized_model_destroy(&dm->quantized);
+    dm->quantized_output = NULL;
+    dm->quantized_loaded = 0;
+}
+
+uint8_t device_quantized_finish(device_model* dm) {
+    if (dm->upload_size == 0 || dm->upload_received != dm->upload_size)
+        return DEVICE_ERR_PAYLOAD;
+
+    uint32_t size = dm->upload_size;
+    dm->upload_size = 0;
+
+    // Validate before the resident quantized model is replaced
+    quantized_model q;
+    if (!quantized_model_load_buffer(&q, dm->upload, size))
+        return DEVICE_ERR_INVALID_MODEL;
+
+    device_quantized_unload(dm);
+    dm->quantized = q;
+    dm->quantized_output = (mlp_real*)mlp_calloc(q.layer_sizes[q.n_layers-1], sizeof(mlp_real));
+    dm->quantized_loaded = 1;
+    return 0;
+}
+
+uint8_t device_evaluate_begin(device_model* dm, uint32_t size) {
+    if (dm->source == DEVICE_MODEL_NONE)
+        return DEVICE_ERR_NO_MODEL;
+    if (size % ((dm->layer_sizes[0] + 1) * sizeof(mlp_real)) != 0)
+        return DEVICE_ERR_PAYLOAD;
+
+    dm->row_received = 0;
+    dm->n_evaluated = 0;
+    dm->n_correct = 0;
+    return 0;
+}
+
+uint8_t device_evaluate_chunk(device_model* dm, const uint8_t* data, int len) {
+    if (dm->source == DEVICE_MODEL_NONE)
+        return DEVICE_ERR_NO_MODEL;
+
+    // Samples may be split across chunks
+    int row_size = (dm->layer_sizes[0] + 1) * sizeof(mlp_real);
+    while (len > 0) {
+        int n = row_size - dm->row_received < len ? row_size - dm->row_received : len;
+        memcpy((uint8_t*)dm->row + dm->row_received, data, n);
+        dm->row_received += n;
+        data += n;
+        len -= n;
+
+        if (dm->row_received == row_size) {
+            dm->n_correct += device_model_classify(dm, dm->row) == (int)dm->row[dm->layer_sizes[0]];
+            dm->n_evaluated++;
+            dm->row_received = 0;
+        }
+    }
+    return 0;
+}
+
+int device_model_classify(device_model* dm, const mlp_real* features) {
+    parameters* param = &dm->param;
+    mlp_classify_block(param, dm->layer_sizes, features, 1, &dm->block, &dm->output);
+
+    // Binary classification thresholds the single output, multi-class takes the largest output
+    if (param->output_layer_size == 1)
+        return dm->output[0] < 0.5 ? 0 : 1;
+
+    int i, max_class = 1;
+    for (i = 1; i < param->output_layer_size; i++)
+        if (dm->output[i] > dm->output[max_class-1])
+            max_class = i+1;
+    return max_class;
+}
+
+int device_quantized_classify(device_model* dm, const mlp_real* features) {
+    return quantized_model_classify(&dm->quantized, features, dm->quantized_output);
+}
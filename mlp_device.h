@@ -0,0 +1,90 @@
+#ifndef MLP_DEVICE_H
+#define MLP_DEVICE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "parameters.h"
+#include "mlp_model.h"
+#include "mlp_inference.h"
+#include "mlp_quantized.h"
+
+// Largest model file that can be uploaded, in bytes
+#ifndef DEVICE_MODEL_MAX
+#define DEVICE_MODEL_MAX 4096
+#endif
+
+// Most layers of a resident model, input and output layers included
+#ifndef DEVICE_MAX_LAYERS
+#define DEVICE_MAX_LAYERS 16
+#endif
+
+// Where the resident model comes from
+#define DEVICE_MODEL_NONE 0
+#define DEVICE_MODEL_EMBEDDED 1 // Compiled into the firmware (model_blob.h)
+#define DEVICE_MODEL_UPLOADED 2 // Received over SimpleSerial
+
+// Payloads streamed to the firmware with ss_stream.h
+#define DEVICE_STREAM_MODEL 0   // A model file written by model_save(), uploaded and loaded at the end
+#define DEVICE_STREAM_SAMPLES 1 // Samples with labels, see device_evaluate_begin
+#define DEVICE_STREAM_QUANTIZED 2 // A quantized model file written by quantized_model_save(), uploaded and loaded at the end
+
+// Status codes of the device commands, after those of ss_err_cmd
+#define DEVICE_ERR_NO_MODEL 0x10      // No model is loaded
+#define DEVICE_ERR_INVALID_MODEL 0x11 // The model failed validation or has too many layers
+#define DEVICE_ERR_TOO_LARGE 0x12     // The upload does not fit in DEVICE_MODEL_MAX
+#define DEVICE_ERR_PAYLOAD 0x13       // The payload has the wrong length or order
+
+// A model loaded once and kept between commands, with every buffer classification needs,
+// so a classification allocates nothing and only runs the forward pass
+typedef struct {
+    int source; // DEVICE_MODEL_NONE, DEVICE_MODEL_EMBEDDED or DEVICE_MODEL_UPLOADED
+    mlp_model model;
+    parameters param;
+    int n_layers;
+    int layer_sizes[DEVICE_MAX_LAYERS];
+    int hidden_layers_size[DEVICE_MAX_LAYERS];
+    int hidden_activation_functions[DEVICE_MAX_LAYERS];
+    inference_block block;      // Activations of one sample
+    mlp_real* output;           // Network outputs of the last classification
+    mlp_real* row;              // Sample being received for evaluation, its features then its label
+    int row_received;           // Bytes of row received so far
+    uint32_t n_evaluated, n_correct;
+    quantized_model quantized;  // Resident quantized model, kept beside the resident model
+    int quantized_loaded;
+    mlp_real* quantized_output; // Network outputs of the last quantized classification
+    uint32_t upload_size;       // Size announced for the upload in progress, 0 for none
+    uint32_t upload_received;
+    // Model file being uploaded, aligned like the weight arena so the model is used in place
+    uint8_t upload[DEVICE_MODEL_MAX] __attribute__((aligned(WEIGHT_ALIGNMENT)));
+} device_model;
+
+// Make the model in data, validated and used in place, the resident one
+// Returns 0 or a DEVICE_ERR_* code, the previous model stays loaded on error
+uint8_t device_model_load(device_model*, const void*, size_t, int);
+void device_model_unload(device_model*);
+
+// Upload of a model file in chunks: begin with its size, append the chunks in order, then load it
+// Beginning an upload unloads a previously uploaded model, whose file is overwritten
+uint8_t device_upload_begin(device_model*, uint32_t);
+uint8_t device_upload_chunk(device_model*, const uint8_t*, int);
+uint8_t device_upload_finish(device_model*);
+
+// Validate the upload as a quantized model file and make it the resident quantized model
+// Its data is copied, so it stays loaded when the upload buffer is reused; the previous one stays loaded on error
+uint8_t device_quantized_finish(device_model*);
+
+// Evaluation of samples received in chunks, each sample layer_sizes[0] features followed by its label,
+// all of type mlp_real; every sample is classified as soon as it is complete
+uint8_t device_evaluate_begin(device_model*, uint32_t);
+uint8_t device_evaluate_chunk(device_model*, const uint8_t*, int);
+
+// Forward pass of one sample of layer_sizes[0] features
+// Returns its class (0 or 1 for a single output, 1 to k for k outputs), the outputs are left in output
+int device_model_classify(device_model*, const mlp_real*);
+
+// Same with the resident quantized model, the outputs are left in quantized_output
+int device_quantized_classify(device_model*, const mlp_real*);
+
+#endif
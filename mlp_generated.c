@@ -0,0 +1,117 @@
+/*
+Desc: Forward pass of model.bin generated by mlp_codegen, do not edit
+      Regenerate with: ./mlp_codegen model.bin mlp_generated.c mlp_generated
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_generated.h"
+
+// Weight matrix i sits between layers i-1 and i, row 0 holding the bias weights
+static const mlp_real w1[5][4] = {
+    {0.72586499999999998, 0.44153599999999998, -0.79910000000000003, 0.0097190000000000002},
+    {0.44564300000000001, -0.59506199999999998, -0.25017899999999998, 0.208894},
+    {0.27672200000000002, 0.19003999999999999, -0.046663999999999997, 0.76302499999999995},
+    {-0.214591, -0.39962399999999998, -0.74352399999999996, 0.73505699999999996},
+    {0.20419599999999999, -0.51530600000000004, 0.64172300000000004, -0.26766800000000002}
+};
+
+static const mlp_real w2[5][5] = {
+    {0.011292999999999999, 0.24047199999999999, 0.45236500000000002, 0.14905399999999999, -0.471252},
+    {0.58452999999999999, -0.20887800000000001, -0.344829, 0.16048200000000001, 0.039267999999999997},
+    {0.68692900000000001, 0.069850999999999996, -0.33569199999999999, 0.70432600000000001, -0.736927},
+    {-0.70654600000000001, -0.707233, -0.17060900000000001, 0.31884499999999999, 0.385986},
+    {-0.79706600000000005, -0.54431600000000002, 0.33251399999999998, -0.19516, -0.127443}
+};
+
+static const mlp_real w3[6][5] = {
+    {0.40548699999999999, -0.27659899999999998, -0.73974300000000004, 0.706677, -0.42820999999999998},
+    {-0.181118, -0.093470999999999999, 0.57451799999999997, -0.526563, -0.72666200000000003},
+    {-0.64714700000000003, -0.74662600000000001, -0.150224, -0.199683, 0.18021699999999999},
+    {0.66162500000000002, -0.322602, -0.52811300000000005, -0.43143700000000001, -0.42901699999999998},
+    {-0.452627, -0.327129, -0.32535999999999998, 0.16011600000000001, 0.74995100000000003},
+    {-0.73377800000000004, 0.17854999999999999, -0.54102899999999998, 0.35626999999999998, 0.76800199999999996}
+};
+
+static const mlp_real w4[6][1] = {
+    {0.112665},
+    {-0.033647999999999997},
+    {-0.26900000000000002},
+    {0.185479},
+    {-0.17794099999999999},
+    {0.099906999999999996}
+};
+
+int mlp_generated_classify(const mlp_real* features, mlp_real* output) {
+    mlp_real a1[4];
+    mlp_real a2[5];
+    mlp_real a3[5];
+    mlp_real largest, sum;
+
+    // Layer 1: 4 inputs, 4 neurons, softmax
+    a1[0] = w1[0][0] + features[0] * w1[1][0] + features[1] * w1[2][0] + features[2] * w1[3][0]
+        + features[3] * w1[4][0];
+    a1[1] = w1[0][1] + features[0] * w1[1][1] + features[1] * w1[2][1] + features[2] * w1[3][1]
+        + features[3] * w1[4][1];
+    a1[2] = w1[0][2] + features[0] * w1[1][2] + features[1] * w1[2][2] + features[2] * w1[3][2]
+        + features[3] * w1[4][2];
+    a1[3] = w1[0][3] + features[0] * w1[1][3] + features[1] * w1[2][3] + features[2] * w1[3][3]
+        + features[3] * w1[4][3];
+    largest = a1[0];
+    largest = a1[1] > largest ? a1[1] : largest;
+    largest = a1[2] > largest ? a1[2] : largest;
+    largest = a1[3] > largest ? a1[3] : largest;
+    sum = 0;
+    a1[0] = real_exp(a1[0] - largest);
+    a1[1] = real_exp(a1[1] - largest);
+    a1[2] = real_exp(a1[2] - largest);
+    a1[3] = real_exp(a1[3] - largest);
+    sum += a1[0];
+    sum += a1[1];
+    sum += a1[2];
+    sum += a1[3];
+    a1[0] /= sum;
+    a1[1] /= sum;
+    a1[2] /= sum;
+    a1[3] /= sum;
+
+    // Layer 2: 4 inputs, 5 neurons, relu
+    a2[0] = w2[0][0] + a1[0] * w2[1][0] + a1[1] * w2[2][0] + a1[2] * w2[3][0]
+        + a1[3] * w2[4][0];
+    a2[1] = w2[0][1] + a1[0] * w2[1][1] + a1[1] * w2[2][1] + a1[2] * w2[3][1]
+        + a1[3] * w2[4][1];
+    a2[2] = w2[0][2] + a1[0] * w2[1][2] + a1[1] * w2[2][2] + a1[2] * w2[3][2]
+        + a1[3] * w2[4][2];
+    a2[3] = w2[0][3] + a1[0] * w2[1][3] + a1[1] * w2[2][3] + a1[2] * w2[3][3]
+        + a1[3] * w2[4][3];
+    a2[4] = w2[0][4] + a1[0] * w2[1][4] + a1[1] * w2[2][4] + a1[2] * w2[3][4]
+        + a1[3] * w2[4][4];
+    a2[0] = a2[0] > 0 ? a2[0] : 0;
+    a2[1] = a2[1] > 0 ? a2[1] : 0;
+    a2[2] = a2[2] > 0 ? a2[2] : 0;
+    a2[3] = a2[3] > 0 ? a2[3] : 0;
+    a2[4] = a2[4] > 0 ? a2[4] : 0;
+
+    // Layer 3: 5 inputs, 5 neurons, tanh
+    a3[0] = w3[0][0] + a2[0] * w3[1][0] + a2[1] * w3[2][0] + a2[2] * w3[3][0]
+        + a2[3] * w3[4][0] + a2[4] * w3[5][0];
+    a3[1] = w3[0][1] + a2[0] * w3[1][1] + a2[1] * w3[2][1] + a2[2] * w3[3][1]
+        + a2[3] * w3[4][1] + a2[4] * w3[5][1];
+    a3[2] = w3[0][2] + a2[0] * w3[1][2] + a2[1] * w3[2][2] + a2[2] * w3[3][2]
+        + a2[3] * w3[4][2] + a2[4] * w3[5][2];
+    a3[3] = w3[0][3] + a2[0] * w3[1][3] + a2[1] * w3[2][3] + a2[2] * w3[3][3]
+        + a2[3] * w3[4][3] + a2[4] * w3[5][3];
+    a3[4] = w3[0][4] + a2[0] * w3[1][4] + a2[1] * w3[2][4] + a2[2] * w3[3][4]
+        + a2[3] * w3[4][4] + a2[4] * w3[5][4];
+    a3[0] = real_tanh(a3[0]);
+    a3[1] = real_tanh(a3[1]);
+    a3[2] = real_tanh(a3[2]);
+    a3[3] = real_tanh(a3[3]);
+    a3[4] = real_tanh(a3[4]);
+
+    // Layer 4: 5 inputs, 1 neurons, sigmoid
+    output[0] = w4[0][0] + a3[0] * w4[1][0] + a3[1] * w4[2][0] + a3[2] * w4[3][0]
+        + a3[3] * w4[4][0] + a3[4] * w4[5][0];
+    output[0] = 1 / (1 + real_exp(-output[0]));
+
+    return output[0] < 0.5 ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/*
+Desc: Forward pass of model.bin generated by mlp_codegen, do not edit
+      Network 4-4-5-5-1 (softmax, relu, tanh; sigmoid output)
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#ifndef MLP_GENERATED_H
+#define MLP_GENERATED_H
+
+#include "mlp_real.h"
+
+#define MLP_GENERATED_INPUTS 4
+#define MLP_GENERATED_OUTPUTS 1
+// Checksum of the model file, as reported for a resident model
+#define MLP_GENERATED_CHECKSUM 0xa3d7893d8358f69fULL
+
+// Forward pass of one sample of MLP_GENERATED_INPUTS features, the network outputs are written to output
+// Returns its class (0 or 1 for a single output, 1 to k for k outputs)
+int mlp_generated_classify(const mlp_real*, mlp_real*);
+
+#endif
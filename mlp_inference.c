@@ -0,0 +1,92 @@
+/*
+Desc: Batched inference, every layer computed as one matrix product over a block of samples
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_inference.h"
+
+void inference_block_create(inference_block* block, int capacity, int n_layers, int* layer_sizes) {
+    block->capacity = capacity;
+
+    // Create memory for the matrices of outputs of the layers, the dense kernels store no pre-activations
+    block->outputs = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+
+    int i;
+    for (i = 0; i < n_layers; i++)
+        block->outputs[i] = (mlp_real*)mlp_calloc((size_t)capacity * (layer_sizes[i]+1), sizeof(mlp_real));
+}
+
+void inference_block_destroy(inference_block* block, int n_layers) {
+    int i;
+    for (i = 0; i < n_layers; i++)
+        mlp_free(block->outputs[i]);
+
+    mlp_free(block->outputs);
+}
+
+void mlp_classify_block(parameters* param, int* layer_sizes, const mlp_real* samples, int n_samples, inference_block* block, mlp_real** final_output) {
+    int n_layers = param->n_hidden + 2;
+
+    int start, i, j;
+    for (start = 0; start < n_samples; start += block->capacity) {
+        int m = n_samples - start < block->capacity ? n_samples - start : block->capacity;
+
+        // Fill the input layer's outputs with the features, one row per sample
+        PERF_BEGIN(PERF_DATA_ACCESS);
+        for (i = 0; i < m; i++) {
+            const mlp_real* features = samples + (size_t)(start+i) * layer_sizes[0];
+            mlp_real* output = block->outputs[0] + (size_t)i * (layer_sizes[0]+1);
+            output[0] = 1; // Bias term of input layer
+            for (j = 0; j < layer_sizes[0]; j++)
+                output[j+1] = features[j];
+        }
+        PERF_END(PERF_DATA_ACCESS);
+
+        // Each layer is one matrix product over the block with the activation function in its epilogue
+        for (i = 1; i < n_layers; i++) {
+            TRACE_BEGIN("forward", i);
+            PERF_BEGIN(PERF_FORWARD_MATMUL);
+            param->plan.dense[i-1](block->outputs[i-1], layer_sizes[i-1]+1, weight_matrix(&param->weight, i-1), param->weight.stride[i-1],
+                block->outputs[i], layer_sizes[i]+1, m, layer_sizes[i-1]+1, layer_sizes[i]);
+            PERF_END(PERF_FORWARD_MATMUL);
+            TRACE_END();
+        }
+
+        // Final computed outputs are in the output layer's outputs from column 1
+        PERF_BEGIN(PERF_DATA_ACCESS);
+        for (i = 0; i < m; i++)
+            for (j = 0; j < param->output_layer_size; j++)
+                final_output[start+i][j] = block->outputs[n_layers-1][(size_t)i * (param->output_layer_size+1) + j+1];
+        PERF_END(PERF_DATA_ACCESS);
+    }
+}
+
+// Work of the threads of the pool for one call of mlp_classify_batch
+typedef struct {
+    parameters* param;
+    int* layer_sizes;
+    const mlp_real* samples;
+    int n_samples;
+    inference_block* blocks; // One block of activations per thread
+    mlp_real** final_output;
+} classify_task;
+
+static void classify_worker(void* arg, int thread_id, int n_threads) {
+    classify_task* task = (classify_task*)arg;
+    inference_block* block = &task->blocks[thread_id];
+
+    // Blocks of samples are dealt round-robin to the threads
+    int start;
+    for (start = thread_id * block->capacity; start < task->n_samples; start += n_threads * block->capacity) {
+        int m = task->n_samples - start < block->capacity ? task->n_samples - start : block->capacity;
+        TRACE_BEGIN("classify block", start);
+        mlp_classify_block(task->param, task->layer_sizes, task->samples + (size_t)start * task->layer_sizes[0], m, block, task->final_output + start);
+        TRACE_END();
+    }
+}
+
+void mlp_classify_batch(parameters* param, int* layer_sizes, const mlp_real* samples, int n_samples, thread_pool* pool,
+    inference_block* blocks, mlp_real** final_output) {
+    classify_task task = { param, layer_sizes, samples, n_samples, blocks, final_output };
+    thread_pool_run(pool, classify_worker, &task);
+}
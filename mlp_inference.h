@@ -0,0 +1,36 @@
+#ifndef MLP_INFERENCE_H
+#define MLP_INFERENCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mlp_alloc.h"
+#include "parameters.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+#include "mlp_perf.h"
+#include "mlp_trace.h"
+
+// Number of samples pushed through the network together
+#ifndef INFERENCE_BLOCK
+#define INFERENCE_BLOCK 64
+#endif
+
+// Activations of a block of samples, one row per sample
+typedef struct {
+    int capacity;     // Maximum number of samples in the block
+    mlp_real** outputs; // outputs[l]: capacity x (layer_sizes[l]+1), outputs of layer l with the bias in column 0
+} inference_block;
+
+void inference_block_create(inference_block*, int, int, int*);
+void inference_block_destroy(inference_block*, int);
+
+// Forward pass of n samples through the network, every layer one dense kernel of param->plan over the block
+// The samples are n rows of layer_sizes[0] features one after the other, as in a dataset
+// The network outputs of sample i are written to final_output[i]
+void mlp_classify_block(parameters*, int*, const mlp_real*, int, inference_block*, mlp_real**);
+
+// Forward pass of n samples in blocks of INFERENCE_BLOCK split across the threads of the pool
+// blocks holds one inference_block per thread of the pool
+void mlp_classify_batch(parameters*, int*, const mlp_real*, int, thread_pool*, inference_block*, mlp_real**);
+
+#endif
@@ -0,0 +1,246 @@
+/*
+Desc: Versioned binary model file, used in place through mmap or from a blob in flash
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_model.h"
+
+#ifdef MLP_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Words summed between two reductions, small enough that the sums cannot overflow 64 bits
+#define CHECKSUM_BLOCK 1024
+
+uint64_t model_checksum(const uint8_t* data, size_t size) {
+    uint64_t sum1 = 0, sum2 = 0;
+    size_t i = 0;
+    while (i < size) {
+        size_t end = size - i > 4 * CHECKSUM_BLOCK ? i + 4 * CHECKSUM_BLOCK : size;
+        for (; i + 4 <= end; i += 4) {
+            uint32_t word;
+            memcpy(&word, data + i, sizeof(word));
+            sum1 += word;
+            sum2 += sum1;
+        }
+        sum1 %= 0xFFFFFFFF;
+        sum2 %= 0xFFFFFFFF;
+    }
+    return (sum2 << 32) | sum1;
+}
+
+// Elements of the weight arena of the given topology, as laid out by weight_arena
+static size_t model_arena_size(const int32_t* layer_sizes, int n_layers) {
+    size_t align = WEIGHT_ALIGNMENT / sizeof(mlp_real);
+    size_t size = 0;
+    int i;
+    for (i = 0; i < n_layers-1; i++) {
+        size_t stride = ((size_t)layer_sizes[i+1] + align - 1) / align * align;
+        size += (size_t)(layer_sizes[i] + 1) * stride;
+    }
+    return size;
+}
+
+#ifndef MLP_FIRMWARE
+void model_save(const char* filename, parameters* param, int* layer_sizes) {
+    int n_layers = param->n_hidden + 2;
+    weight_arena* w = &param->weight;
+
+    // Header, topology and padding up to the aligned weights
+    model_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+    header.version = MODEL_VERSION;
+    header.real_size = sizeof(mlp_real);
+    header.alignment = WEIGHT_ALIGNMENT;
+    header.n_layers = n_layers;
+    header.topology_offset = sizeof(model_header);
+    size_t topology_end = header.topology_offset + 2 * (size_t)n_layers * sizeof(int32_t);
+    header.weights_offset = (topology_end + WEIGHT_ALIGNMENT - 1) / WEIGHT_ALIGNMENT * WEIGHT_ALIGNMENT;
+    header.weights_size = w->size * sizeof(mlp_real);
+    header.file_size = header.weights_offset + header.weights_size;
+
+    // Assemble the whole file in memory
+    uint8_t* file = (uint8_t*)mlp_calloc(header.file_size, 1);
+    int32_t* sizes = (int32_t*)(file + header.topology_offset);
+    int32_t* activations = sizes + n_layers;
+    int i;
+    for (i = 0; i < n_layers; i++) {
+        sizes[i] = layer_sizes[i];
+        if (i == 0)
+            activations[i] = 0;
+        else if (i < n_layers-1)
+            activations[i] = param->hidden_activation_functions[i-1];
+        else
+            activations[i] = param->output_activation_function;
+    }
+    memcpy(file + header.weights_offset, w->data, header.weights_size);
+
+    header.checksum = model_checksum(file + header.topology_offset, header.file_size - header.topology_offset);
+    memcpy(file, &header, sizeof(header));
+
+    FILE* fp = fopen(filename, "wb");
+    if (NULL == fp) {
+        printf("Cannot create/open file %s. Make sure you have permission to create/open a file in the directory\n", filename);
+        exit(0);
+    }
+    if (fwrite(file, 1, header.file_size, fp) != header.file_size) {
+        printf("Error: Cannot write the model to %s\n", filename);
+        exit(0);
+    }
+    fclose(fp);
+
+    mlp_free(file);
+}
+#endif
+
+// Check the model in data and point model at its parts, returns 0 after printing the error otherwise
+static int model_check(mlp_model* model, const void* data, size_t size) {
+    const model_header* header = (const model_header*)data;
+    if (size < sizeof(model_header) || memcmp(header->magic, MODEL_MAGIC, sizeof(header->magic)) != 0) {
+        printf("Error: Not a model file\n");
+        return 0;
+    }
+    if (header->version != MODEL_VERSION) {
+        printf("Error: Unsupported model version %u (or model written with the other byte order)\n", (unsigned)header->version);
+        return 0;
+    }
+    if (header->real_size != sizeof(mlp_real)) {
+        printf("Error: Model has %u-byte weights, this build uses %s\n", (unsigned)header->real_size, MLP_REAL_NAME);
+        return 0;
+    }
+    if (header->alignment != WEIGHT_ALIGNMENT) {
+        printf("Error: Model weights are aligned to %u bytes, this build uses %d\n", (unsigned)header->alignment, WEIGHT_ALIGNMENT);
+        return 0;
+    }
+
+    // Layout of the parts within the file
+    size_t topology_end = header->topology_offset + 2 * (size_t)header->n_layers * sizeof(int32_t);
+    if (header->file_size != size || header->topology_offset != sizeof(model_header) || header->n_layers < 2
+        || header->n_layers > size || topology_end > header->weights_offset
+        || header->weights_offset % WEIGHT_ALIGNMENT != 0 || header->weights_offset + header->weights_size != size) {
+        printf("Error: Model file is truncated or corrupt\n");
+        return 0;
+    }
+    if (model_checksum((const uint8_t*)data + header->topology_offset, size - header->topology_offset) != header->checksum) {
+        printf("Error: Model checksum mismatch\n");
+        return 0;
+    }
+
+    model->header = header;
+    model->layer_sizes = (const int32_t*)((const uint8_t*)data + header->topology_offset);
+    model->activations = model->layer_sizes + header->n_layers;
+    model->weights = (mlp_real*)((uint8_t*)data + header->weights_offset);
+
+    int i;
+    for (i = 0; i < (int)header->n_layers; i++) {
+        if (model->layer_sizes[i] <= 0 || (i > 0 && (model->activations[i] < 1 || model->activations[i] > 5))) {
+            printf("Error: Invalid topology in the model\n");
+            return 0;
+        }
+    }
+    if (model_arena_size(model->layer_sizes, header->n_layers) * sizeof(mlp_real) != header->weights_size) {
+        printf("Error: Model weights do not match its topology\n");
+        return 0;
+    }
+    if ((uintptr_t)model->weights % sizeof(mlp_real) != 0) {
+        printf("Error: Model weights are not aligned in memory\n");
+        return 0;
+    }
+    return 1;
+}
+
+static void model_validate(mlp_model* model, const void* data, size_t size) {
+    if (!model_check(model, data, size))
+        exit(0);
+}
+
+#ifndef MLP_FIRMWARE
+void model_open(mlp_model* model, const char* filename) {
+#ifdef MLP_MMAP
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    size_t size = (size_t)st.st_size;
+
+    // A private mapping: inference reads the weights in place, training copies only the pages it writes
+    void* mapping = size > 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        printf("Error: Cannot map the model file %s\n", filename);
+        exit(0);
+    }
+#else
+    FILE* fp = fopen(filename, "rb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t size = (size_t)ftell(fp);
+    rewind(fp);
+
+    // Without mmap the file is read whole, malloc alignment suffices for the weights
+    void* mapping = mlp_malloc(size > 0 ? size : 1);
+    if (fread(mapping, 1, size, fp) != size) {
+        printf("Error: Cannot read the model file %s\n", filename);
+        exit(0);
+    }
+    fclose(fp);
+#endif
+
+    model_validate(model, mapping, size);
+    model->mapping = mapping;
+    model->mapping_size = size;
+}
+#endif
+
+void model_open_blob(mlp_model* model, const void* blob, size_t size) {
+    model_validate(model, blob, size);
+    model->mapping = NULL;
+    model->mapping_size = 0;
+}
+
+int model_open_buffer(mlp_model* model, const void* data, size_t size) {
+    if (!model_check(model, data, size))
+        return 0;
+    model->mapping = NULL;
+    model->mapping_size = 0;
+    return 1;
+}
+
+void model_attach(mlp_model* model, parameters* param, int* layer_sizes) {
+    int n_layers = param->n_hidden + 2;
+    int i;
+
+    // The network configured in param must be the one in the model
+    int match = (int)model->header->n_layers == n_layers;
+    for (i = 0; match && i < n_layers; i++) {
+        match = model->layer_sizes[i] == layer_sizes[i];
+        if (i > 0 && i < n_layers-1)
+            match = match && model->activations[i] == param->hidden_activation_functions[i-1];
+    }
+    if (!match || model->activations[n_layers-1] != param->output_activation_function) {
+        printf("Error: The model does not match the configured network\n");
+        exit(0);
+    }
+
+    weight_arena_attach(&param->weight, n_layers, layer_sizes, model->weights);
+}
+
+void model_close(mlp_model* model) {
+#ifdef MLP_MMAP
+    if (model->mapping != NULL)
+        munmap(model->mapping, model->mapping_size);
+#else
+    mlp_free(model->mapping);
+#endif
+    model->mapping = NULL;
+    model->header = NULL;
+}
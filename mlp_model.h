@@ -0,0 +1,75 @@
+#ifndef MLP_MODEL_H
+#define MLP_MODEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mlp_alloc.h"
+#include "mlp_real.h"
+#include "parameters.h"
+
+// Model files are mapped with mmap where available, read into memory otherwise
+#if defined(__unix__) || defined(__APPLE__)
+#define MLP_MMAP 1
+#endif
+
+#define MODEL_MAGIC "MLPM"
+#define MODEL_VERSION 1
+
+// Binary model file, in the byte order of the machine that wrote it:
+//   model_header
+//   int32 layer_sizes[n_layers]
+//   int32 activations[n_layers]   Activation function of each layer, 0 for the input layer
+//   zero padding up to weights_offset, a multiple of alignment
+//   weight arena                  The matrices exactly as in weight_arena, row padding included
+typedef struct {
+    char magic[4];            // MODEL_MAGIC
+    uint32_t version;         // MODEL_VERSION
+    uint32_t real_size;       // Size of a weight in bytes, 8 (double) or 4 (float)
+    uint32_t alignment;       // WEIGHT_ALIGNMENT of the writer, which sets the row strides
+    uint32_t n_layers;
+    uint32_t topology_offset; // Start of layer_sizes, sizeof(model_header)
+    uint64_t weights_offset;  // Start of the weight arena
+    uint64_t weights_size;    // Bytes of the weight arena
+    uint64_t file_size;
+    uint64_t checksum;        // Fletcher-64 of the bytes from topology_offset to file_size
+} model_header;
+
+// A validated model, used in place
+typedef struct {
+    const model_header* header;
+    const int32_t* layer_sizes;
+    const int32_t* activations;
+    mlp_real* weights;        // Start of the weight arena inside the model
+    void* mapping;            // Memory owned by the model (mapped or read file), NULL for a blob
+    size_t mapping_size;
+} mlp_model;
+
+// Model files are host only, the firmware (MLP_FIRMWARE) opens the embedded blob and uploaded buffers
+#ifndef MLP_FIRMWARE
+// Write the topology, activations and weights of param to a model file
+void model_save(const char*, parameters*, int*);
+
+// Map a model file and validate it, without parsing or copying the weights
+void model_open(mlp_model*, const char*);
+#endif
+
+// Validate a model already in memory, e.g. embedded in flash, and use it in place
+// The weights must be aligned to the size of mlp_real
+void model_open_blob(mlp_model*, const void*, size_t);
+
+// Same for a model received at run time, e.g. uploaded to the firmware
+// Returns 1 for a valid model, 0 after printing the error, and does not stop the program
+int model_open_buffer(mlp_model*, const void*, size_t);
+
+// Point the weight arena of param at the model's weights
+// The topology and activations of param must match the model
+void model_attach(mlp_model*, parameters*, int*);
+
+void model_close(mlp_model*);
+
+// Fletcher-64 over 32-bit words, size a multiple of 4, also the checksum of quantized model files
+uint64_t model_checksum(const uint8_t*, size_t);
+
+#endif
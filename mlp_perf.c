@@ -0,0 +1,341 @@
+/*
+Desc: Per-phase time and hardware performance counters of training and classification
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_perf.h"
+
+#ifdef MLP_PERF
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "thread_pool.h"
+
+#ifdef MLP_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PERF_EVENTS 1
+#endif
+
+// Threads with counters at the same time, further threads are left out of the report
+#define PERF_MAX_THREADS 64
+
+// Counters opened for every thread
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_CACHE_MISSES 2
+#define PERF_BRANCH_MISSES 3
+#define PERF_COUNTERS 4
+
+static const char* phase_names[PERF_PHASES] = { "data access", "forward matmul", "activation", "local gradient", "weight update" };
+
+// Time and counters of one thread, only ever written by that thread
+typedef struct {
+    int fd[PERF_COUNTERS];  // -1 for a counter that could not be opened
+#ifdef PERF_EVENTS
+    struct perf_event_mmap_page* page[PERF_COUNTERS]; // Read with rdpmc when the kernel allows it
+#endif
+    double start_time;
+    uint64_t start[PERF_COUNTERS];
+    double seconds[PERF_PHASES];
+    uint64_t count[PERF_PHASES][PERF_COUNTERS];
+    unsigned long calls[PERF_PHASES];
+    int in_use;             // Slot taken by a running thread
+} perf_thread;
+
+// The counters of every thread live in a static slot: a thread opens them on its first phase,
+// often inside the epoch loop, which must not allocate
+static perf_thread perf_slots[PERF_MAX_THREADS];
+static perf_thread* perf_threads[PERF_MAX_THREADS]; // Slots in use
+static int perf_n_threads = 0;
+static int perf_error = 0; // errno of the first counter that could not be opened
+// Totals of the threads that exited since the last report, e.g. the workers of a destroyed pool
+static perf_thread perf_retired;
+static int perf_n_retired = 0;
+#ifdef MLP_THREADS
+static pthread_mutex_t perf_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t perf_once = PTHREAD_ONCE_INIT;
+static pthread_key_t perf_key; // Its destructor retires the counters of an exiting thread
+#endif
+
+// Counters of the calling thread, opened on its first phase
+static __thread perf_thread* perf_self = NULL;
+static __thread int perf_untracked = 0;
+
+static double perf_now(void) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+#ifdef PERF_EVENTS
+static void open_counters(perf_thread* t) {
+    static const uint64_t configs[PERF_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    int k;
+    for (k = 0; k < PERF_COUNTERS; k++) {
+        // User code of this thread only, on any CPU
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[k];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        t->fd[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        t->page[k] = NULL;
+        if (t->fd[k] < 0) {
+            if (perf_error == 0)
+                perf_error = errno;
+            continue;
+        }
+
+        void* page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, t->fd[k], 0);
+        if (page != MAP_FAILED)
+            t->page[k] = (struct perf_event_mmap_page*)page;
+    }
+}
+
+// Current value of counter k, with rdpmc from user space when possible, read() otherwise
+static uint64_t read_counter(perf_thread* t, int k) {
+#if defined(__x86_64__) || defined(__i386__)
+    struct perf_event_mmap_page* pc = t->page[k];
+    if (pc != NULL) {
+        // The kernel updates the page under a sequence lock, retry if it changed meanwhile
+        uint32_t seq, index;
+        uint64_t count;
+        do {
+            seq = pc->lock;
+            __asm__ volatile("" ::: "memory");
+            index = pc->index;
+            count = pc->offset;
+            if (pc->cap_user_rdpmc && index != 0) {
+                uint32_t low, high;
+                __asm__ volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+                int64_t pmc = (int64_t)(((uint64_t)high << 32) | low);
+                pmc = (int64_t)((uint64_t)pmc << (64 - pc->pmc_width)) >> (64 - pc->pmc_width);
+                count += pmc;
+            }
+            __asm__ volatile("" ::: "memory");
+        } while (pc->lock != seq);
+
+        if (pc->cap_user_rdpmc && index != 0)
+            return count;
+    }
+#endif
+    uint64_t value;
+    if (read(t->fd[k], &value, sizeof(value)) != sizeof(value))
+        return 0;
+    return value;
+}
+#endif
+
+// Add the totals of a thread to those of another
+static void perf_add(perf_thread* sum, const perf_thread* t) {
+    int p, k;
+    for (p = 0; p < PERF_PHASES; p++) {
+        sum->seconds[p] += t->seconds[p];
+        sum->calls[p] += t->calls[p];
+        for (k = 0; k < PERF_COUNTERS; k++)
+            sum->count[p][k] += t->count[p][k];
+    }
+}
+
+static int perf_has_calls(const perf_thread* t) {
+    int p;
+    for (p = 0; p < PERF_PHASES; p++)
+        if (t->calls[p] > 0)
+            return 1;
+    return 0;
+}
+
+#ifdef MLP_THREADS
+// Close the counters of an exiting thread, keep its totals for the next report and free its slot
+static void perf_thread_exit(void* arg) {
+    perf_thread* t = (perf_thread*)arg;
+
+#ifdef PERF_EVENTS
+    long page_size = sysconf(_SC_PAGESIZE);
+    int k;
+    for (k = 0; k < PERF_COUNTERS; k++) {
+        if (t->page[k] != NULL)
+            munmap(t->page[k], page_size);
+        if (t->fd[k] >= 0)
+            close(t->fd[k]);
+    }
+#endif
+
+    pthread_mutex_lock(&perf_lock);
+    perf_add(&perf_retired, t);
+    if (perf_has_calls(t))
+        perf_n_retired++;
+    int i;
+    for (i = 0; i < perf_n_threads; i++)
+        if (perf_threads[i] == t)
+            perf_threads[i] = perf_threads[--perf_n_threads];
+    t->in_use = 0;
+    pthread_mutex_unlock(&perf_lock);
+}
+
+static void perf_key_create(void) {
+    pthread_key_create(&perf_key, perf_thread_exit);
+}
+#endif
+
+static perf_thread* perf_thread_create(void) {
+    perf_thread* t = NULL;
+
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&perf_lock);
+#endif
+    // A slot is free whenever fewer threads than slots are running
+    int i, k;
+    for (i = 0; i < PERF_MAX_THREADS && t == NULL; i++)
+        if (!perf_slots[i].in_use)
+            t = &perf_slots[i];
+    if (t != NULL) {
+        memset(t, 0, sizeof(perf_thread));
+        t->in_use = 1;
+        for (k = 0; k < PERF_COUNTERS; k++)
+            t->fd[k] = -1;
+        perf_threads[perf_n_threads++] = t;
+#ifdef PERF_EVENTS
+        open_counters(t);
+#endif
+    }
+#ifdef MLP_THREADS
+    pthread_mutex_unlock(&perf_lock);
+
+    if (t != NULL) {
+        pthread_once(&perf_once, perf_key_create);
+        pthread_setspecific(perf_key, t);
+    }
+#endif
+
+    return t;
+}
+
+void perf_begin(int phase) {
+    perf_thread* t = perf_self;
+    if (t == NULL) {
+        if (perf_untracked)
+            return;
+        t = perf_self = perf_thread_create();
+        if (t == NULL) {
+            perf_untracked = 1;
+            return;
+        }
+    }
+
+#ifdef PERF_EVENTS
+    int k;
+    for (k = 0; k < PERF_COUNTERS; k++)
+        if (t->fd[k] >= 0)
+            t->start[k] = read_counter(t, k);
+#endif
+    t->start_time = perf_now();
+}
+
+void perf_end(int phase) {
+    perf_thread* t = perf_self;
+    if (t == NULL)
+        return;
+
+    // Time first, so the counter reads stay out of it
+    t->seconds[phase] += perf_now() - t->start_time;
+#ifdef PERF_EVENTS
+    int k;
+    for (k = 0; k < PERF_COUNTERS; k++)
+        if (t->fd[k] >= 0)
+            t->count[phase][k] += read_counter(t, k) - t->start[k];
+#endif
+    t->calls[phase]++;
+}
+
+void perf_report(const char* title) {
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&perf_lock);
+#endif
+
+    // Sum the phases over all threads, and reset them for the next report
+    // The threads of the pool are idle between runs, so their totals are not being written
+    perf_thread sum = perf_retired;
+    int n_threads = perf_n_retired;
+#ifdef PERF_EVENTS
+    int counters = perf_n_threads > 0 && perf_error == 0;
+#else
+    int counters = 0;
+#endif
+    int i, p, k;
+    for (i = 0; i < perf_n_threads; i++) {
+        perf_thread* t = perf_threads[i];
+        perf_add(&sum, t);
+        if (perf_has_calls(t))
+            n_threads++;
+        memset(t->seconds, 0, sizeof(t->seconds));
+        memset(t->count, 0, sizeof(t->count));
+        memset(t->calls, 0, sizeof(t->calls));
+    }
+    memset(&perf_retired, 0, sizeof(perf_retired));
+    perf_n_retired = 0;
+
+#ifdef MLP_THREADS
+    pthread_mutex_unlock(&perf_lock);
+#endif
+
+    double total_seconds = 0;
+    uint64_t total[PERF_COUNTERS] = { 0 };
+    for (p = 0; p < PERF_PHASES; p++) {
+        total_seconds += sum.seconds[p];
+        for (k = 0; k < PERF_COUNTERS; k++)
+            total[k] += sum.count[p][k];
+    }
+
+    printf("\n%s: time and counters per phase, summed over %d thread(s)\n", title, n_threads);
+    if (!counters)
+        printf("Hardware counters unavailable (%s), times only\n", perf_error != 0 ? strerror(perf_error) : "not supported");
+    printf("%-16s %12s %10s %6s", "phase", "calls", "time (ms)", "time%");
+    if (counters)
+        printf(" %14s %14s %5s %12s %6s %12s", "cycles", "instructions", "IPC", "cache-misses", "MPKI", "branch-miss");
+    printf("\n");
+
+    // IPC well below 1 with many cache misses per thousand instructions (MPKI) points to a memory-bound phase
+    for (p = 0; p <= PERF_PHASES; p++) {
+        const char* name = p < PERF_PHASES ? phase_names[p] : "total";
+        double s = p < PERF_PHASES ? sum.seconds[p] : total_seconds;
+        const uint64_t* c = p < PERF_PHASES ? sum.count[p] : total;
+        unsigned long n = 0;
+        if (p < PERF_PHASES)
+            n = sum.calls[p];
+        else
+            for (i = 0; i < PERF_PHASES; i++)
+                n += sum.calls[i];
+
+        printf("%-16s %12lu %10.2f %5.1f%%", name, n, s * 1e3, total_seconds > 0 ? 100 * s / total_seconds : 0);
+        if (counters)
+            printf(" %14llu %14llu %5.2f %12llu %6.2f %12llu", (unsigned long long)c[PERF_CYCLES], (unsigned long long)c[PERF_INSTRUCTIONS],
+                c[PERF_CYCLES] > 0 ? (double)c[PERF_INSTRUCTIONS] / c[PERF_CYCLES] : 0, (unsigned long long)c[PERF_CACHE_MISSES],
+                c[PERF_INSTRUCTIONS] > 0 ? 1000.0 * c[PERF_CACHE_MISSES] / c[PERF_INSTRUCTIONS] : 0, (unsigned long long)c[PERF_BRANCH_MISSES]);
+        printf("\n");
+    }
+}
+
+#endif
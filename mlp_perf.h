@@ -0,0 +1,35 @@
+#ifndef MLP_PERF_H
+#define MLP_PERF_H
+
+// Phases of training and classification that time and hardware counters are attributed to
+#define PERF_DATA_ACCESS 0    // Copying samples and labels out of the dataset, waiting for streamed shards
+#define PERF_FORWARD_MATMUL 1 // Matrix products of the forward pass, with the activations fused in when classifying
+#define PERF_ACTIVATION 2     // Activation functions of the forward pass
+#define PERF_LOCAL_GRADIENT 3 // Errors, activation derivatives and local gradients of the backward pass
+#define PERF_WEIGHT_UPDATE 4  // Weight corrections or gradients and the update of the weights
+#define PERF_PHASES 5
+
+// Built with -DMLP_PERF (make MLP_PERF=1) every phase is timed and, on Linux, counted with
+// perf_event_open: cycles, instructions, cache misses and branch misses of the user code of each thread.
+// Without it the macros expand to nothing and the instrumentation costs nothing
+#ifdef MLP_PERF
+
+void perf_begin(int);
+void perf_end(int);
+
+// Print the per-phase totals of all threads since the last report, then start again from zero
+void perf_report(const char*);
+
+#define PERF_BEGIN(phase) perf_begin(phase)
+#define PERF_END(phase) perf_end(phase)
+#define PERF_REPORT(title) perf_report(title)
+
+#else
+
+#define PERF_BEGIN(phase) ((void)0)
+#define PERF_END(phase) ((void)0)
+#define PERF_REPORT(title) ((void)0)
+
+#endif
+
+#endif
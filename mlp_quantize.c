@@ -0,0 +1,78 @@
+/*
+Desc: Quantize a model file to q7 or q15, calibrated on a dataset, into a quantized model file for the firmware
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_model.h"
+#include "mlp_quantized.h"
+#include "read_csv.h"
+
+int main(int argc, char** argv) {
+    if (argc != 5) {
+        printf("\nExecution syntax:\n");
+        printf("-----------------\n");
+        printf("Argument 1: Model file written by model_save() Ex: model.bin \n");
+        printf("Argument 2: Dataset the activations are calibrated on, a .csv or binary dataset file Ex: data/data_train.csv \n");
+        printf("Argument 3: Format, q7 or q15 Ex: q15 \n");
+        printf("Argument 4: Quantized model file to write Ex: model_q15.bin \n\n");
+        exit(0);
+    }
+
+    int bits = strcmp(argv[3], "q7") == 0 ? QUANT_Q7 : strcmp(argv[3], "q15") == 0 ? QUANT_Q15 : 0;
+    if (bits == 0) {
+        printf("Error: Invalid quantization format %s, use q7 or q15\n", argv[3]);
+        exit(0);
+    }
+
+    // The network is configured from the topology and activations stored in the model
+    mlp_model model;
+    model_open(&model, argv[1]);
+    int n_layers = (int)model.header->n_layers;
+    int* layer_sizes = (int*)malloc(n_layers * sizeof(int));
+    int* hidden_activation_functions = (int*)malloc(n_layers * sizeof(int));
+    int i;
+    for (i = 0; i < n_layers; i++)
+        layer_sizes[i] = model.layer_sizes[i];
+    for (i = 1; i < n_layers-1; i++)
+        hidden_activation_functions[i-1] = model.activations[i];
+
+    parameters param;
+    memset(&param, 0, sizeof(parameters));
+    param.n_hidden = n_layers - 2;
+    param.hidden_layers_size = layer_sizes + 1;
+    param.hidden_activation_functions = hidden_activation_functions;
+    param.output_layer_size = layer_sizes[n_layers-1];
+    param.output_activation_function = model.activations[n_layers-1];
+    param.n_threads = 1;
+    param.batch_size = 1;
+    param.activation_accuracy = ACTIVATION_EXACT;
+    model_attach(&model, &param, layer_sizes);
+
+    // The scales of the activations are calibrated on the dataset as data_train
+    size_t name_len = strlen(argv[2]);
+    if (name_len > 4 && strcmp(argv[2] + name_len - 4, ".csv") == 0) {
+        int rows, cols;
+        mlp_real** table = read_csv_auto(argv[2], &rows, &cols);
+        dataset_from_table(&param.data_train, table[0], rows, cols);
+        free_csv(table);
+    }
+    else
+        dataset_open(&param.data_train, argv[2]);
+    if (param.data_train.n_features != layer_sizes[0]) {
+        printf("Error: The dataset has %d features, the model %d inputs\n", param.data_train.n_features, layer_sizes[0]);
+        exit(0);
+    }
+
+    quantized_model q;
+    quantized_model_create(&q, &param, layer_sizes, bits);
+    quantized_model_save(&q, argv[4]);
+    printf("%s: q%d network of %s\n", argv[4], bits-1, argv[1]);
+
+    quantized_model_destroy(&q);
+    dataset_destroy(&param.data_train);
+    weight_arena_destroy(&param.weight);
+    model_close(&model);
+    free(hidden_activation_functions);
+    free(layer_sizes);
+    return 0;
+}
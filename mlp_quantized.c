@@ -0,0 +1,532 @@
+/*
+Desc: Fixed-point (q7/q15) inference with power-of-two scales calibrated on the train dataset
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_quantized.h"
+
+// sigmoid(-8 + i/16) in Q15 for i = 0..256, interpolated linearly in between
+#define SIGMOID_TABLE_SIZE 257
+static const int32_t sigmoid_table[SIGMOID_TABLE_SIZE] = {
+    11, 12, 12, 13, 14, 15, 16, 17, 18, 19, 21, 22,
+    23, 25, 26, 28, 30, 32, 34, 36, 38, 41, 43, 46,
+    49, 52, 56, 59, 63, 67, 72, 76, 81, 86, 92, 98,
+    104, 111, 118, 125, 133, 142, 151, 161, 171, 182, 194, 206,
+    219, 233, 248, 264, 281, 299, 318, 338, 360, 383, 407, 433,
+    461, 490, 521, 554, 589, 627, 666, 708, 753, 800, 851, 904,
+    961, 1021, 1084, 1152, 1223, 1299, 1379, 1464, 1554, 1649, 1750, 1856,
+    1969, 2088, 2213, 2346, 2486, 2633, 2789, 2952, 3124, 3306, 3496, 3696,
+    3906, 4126, 4357, 4599, 4851, 5115, 5391, 5678, 5978, 6289, 6613, 6949,
+    7297, 7658, 8031, 8416, 8813, 9221, 9641, 10072, 10513, 10964, 11424, 11894,
+    12371, 12856, 13348, 13845, 14347, 14852, 15361, 15872, 16384, 16896, 17407, 17916,
+    18421, 18923, 19420, 19912, 20397, 20874, 21344, 21804, 22255, 22696, 23127, 23547,
+    23955, 24352, 24737, 25110, 25471, 25819, 26155, 26479, 26790, 27090, 27377, 27653,
+    27917, 28169, 28411, 28642, 28862, 29072, 29272, 29462, 29644, 29816, 29979, 30135,
+    30282, 30422, 30555, 30680, 30799, 30912, 31018, 31119, 31214, 31304, 31389, 31469,
+    31545, 31616, 31684, 31747, 31807, 31864, 31917, 31968, 32015, 32060, 32102, 32141,
+    32179, 32214, 32247, 32278, 32307, 32335, 32361, 32385, 32408, 32430, 32450, 32469,
+    32487, 32504, 32520, 32535, 32549, 32562, 32574, 32586, 32597, 32607, 32617, 32626,
+    32635, 32643, 32650, 32657, 32664, 32670, 32676, 32682, 32687, 32692, 32696, 32701,
+    32705, 32709, 32712, 32716, 32719, 32722, 32725, 32727, 32730, 32732, 32734, 32736,
+    32738, 32740, 32742, 32743, 32745, 32746, 32747, 32749, 32750, 32751, 32752, 32753,
+    32754, 32755, 32756, 32756, 32757
+};
+
+// v / 2^shift rounded to nearest, halves away from zero; a negative shift multiplies
+static int64_t round_shift(int64_t v, int shift) {
+    if (shift <= 0)
+        return v * ((int64_t)1 << -shift);
+
+    int64_t half = (int64_t)1 << (shift-1);
+    return v >= 0 ? (v + half) >> shift : -((-v + half) >> shift);
+}
+
+// Clamp to the range of the integer format
+static int16_t saturate(int64_t v, int bits) {
+    int64_t largest = ((int64_t)1 << (bits-1)) - 1;
+    if (v > largest)
+        return (int16_t)largest;
+    if (v < -largest-1)
+        return (int16_t)(-largest-1);
+    return (int16_t)v;
+}
+
+// Sigmoid in Q15 of z with f fractional bits
+static int32_t sigmoid_q15(int64_t z, int f) {
+    // (z + 8) * 16, the position in the table with f fractional bits
+    int64_t position = z * 16 + ((int64_t)128 << f);
+    if (position <= 0)
+        return sigmoid_table[0];
+
+    int64_t index = position >> f;
+    if (index >= SIGMOID_TABLE_SIZE-1)
+        return sigmoid_table[SIGMOID_TABLE_SIZE-1];
+
+    int64_t rest = position - (index << f);
+    return sigmoid_table[index] + (int32_t)(((sigmoid_table[index+1] - sigmoid_table[index]) * rest) >> f);
+}
+
+#ifndef MLP_FIRMWARE
+// Largest number of fractional bits, up to QUANT_MAX_FRAC, that fits values up to largest in the format
+static int choose_frac(double largest, int bits) {
+    double limit = (double)(((int64_t)1 << (bits-1)) - 1);
+    int frac = QUANT_MAX_FRAC;
+    while (frac > 0 && largest * ldexp(1.0, frac) > limit)
+        frac--;
+    return frac;
+}
+#endif
+
+// Predicted class as in mlp_classifier: 0/1 for one output, 1..n otherwise
+static int predicted_class(mlp_real* output, int n) {
+    if (n == 1)
+        return output[0] < 0.5 ? 0 : 1;
+
+    int i, best = 0;
+    for (i = 1; i < n; i++)
+        if (output[i] > output[best])
+            best = i;
+    return best+1;
+}
+
+static void quantized_forward(quantized_model* q, const mlp_real* features, mlp_real* final_output) {
+    int i, j, k;
+    int bits = q->bits;
+    int16_t* input = q->layer_input;
+    int16_t* output = q->layer_output;
+    int64_t* z = q->accumulator;
+
+    // Quantize the features
+    for (k = 0; k < q->layer_sizes[0]; k++)
+        input[k] = saturate(llround(ldexp(features[k], q->frac[0])), bits);
+
+    for (i = 1; i < q->n_layers; i++) {
+        int n = q->layer_sizes[i-1];
+        int p = q->layer_sizes[i];
+
+        // Integer multiply-accumulate, in 32 bits for q7 and 64 bits for q15
+        for (j = 0; j < p; j++) {
+            if (bits == QUANT_Q7) {
+                int8_t* w = q->weights_q7[i-1] + (size_t)j * n;
+                int32_t acc = 0;
+                for (k = 0; k < n; k++)
+                    acc += (int32_t)input[k] * w[k];
+                z[j] = q->bias[i-1][j] + acc;
+            }
+            else {
+                int16_t* w = q->weights_q15[i-1] + (size_t)j * n;
+                int64_t acc = q->bias[i-1][j];
+                for (k = 0; k < n; k++)
+                    acc += (int32_t)input[k] * w[k];
+                z[j] = acc;
+            }
+        }
+
+        // Requantize through the activation function
+        // Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+        int fz = q->frac[i-1] + q->weight_frac[i-1];
+        int fo = q->frac[i];
+        switch (q->activation[i]) {
+            case 1: // identity
+                for (j = 0; j < p; j++)
+                    output[j] = saturate(round_shift(z[j], fz - fo), bits);
+                break;
+            case 2: // sigmoid
+                for (j = 0; j < p; j++)
+                    output[j] = saturate(round_shift(sigmoid_q15(z[j], fz), 15 - fo), bits);
+                break;
+            case 3: // tanh(x) = 2 * sigmoid(2x) - 1
+                for (j = 0; j < p; j++) {
+                    int32_t s = fz > 0 ? sigmoid_q15(z[j], fz-1) : sigmoid_q15(z[j] * 2, fz);
+                    output[j] = saturate(round_shift(2 * (int64_t)s - 32768, 15 - fo), bits);
+                }
+                break;
+            case 4: // relu
+                for (j = 0; j < p; j++)
+                    output[j] = z[j] > 0 ? saturate(round_shift(z[j], fz - fo), bits) : 0;
+                break;
+            case 5: { // softmax
+                // exp(z - max) = s / (1 - s) with s = sigmoid(z - max) <= 1/2, in Q15
+                int64_t largest = z[0];
+                for (j = 1; j < p; j++)
+                    if (z[j] > largest)
+                        largest = z[j];
+
+                int64_t sum = 0;
+                for (j = 0; j < p; j++) {
+                    int64_t s = sigmoid_q15(z[j] - largest, fz);
+                    z[j] = s * 32768 / (32768 - s);
+                    sum += z[j];
+                }
+
+                for (j = 0; j < p; j++)
+                    output[j] = saturate((z[j] * ((int64_t)1 << fo) + sum / 2) / sum, bits);
+                break;
+            }
+            default:
+                printf("Quantized inference: Invalid activation function\n");
+                exit(0);
+                break;
+        }
+
+        // Outputs of this layer are the inputs of the next
+        int16_t* swap = input;
+        input = output;
+        output = swap;
+    }
+
+    // Fixed-point outputs, exactly representable as mlp_real
+    for (j = 0; j < q->layer_sizes[q->n_layers-1]; j++)
+        final_output[j] = ldexp(input[j], -q->frac[q->n_layers-1]);
+}
+
+void quantized_classify(quantized_model* q, const mlp_real* samples, int n_samples, mlp_real** final_output) {
+    int i;
+    for (i = 0; i < n_samples; i++)
+        quantized_forward(q, samples + (size_t)i * q->layer_sizes[0], final_output[i]);
+}
+
+int quantized_model_classify(quantized_model* q, const mlp_real* features, mlp_real* final_output) {
+    quantized_forward(q, features, final_output);
+    return predicted_class(final_output, q->layer_sizes[q->n_layers-1]);
+}
+
+// Allocate the arrays of a network of the given format and topology, zeroed, and copy the topology
+static void quantized_model_alloc(quantized_model* q, int bits, int n_layers, const int* layer_sizes) {
+    int i;
+    q->bits = bits;
+    q->n_layers = n_layers;
+    q->layer_sizes = (int*)mlp_calloc(n_layers, sizeof(int));
+    q->activation = (int*)mlp_calloc(n_layers, sizeof(int));
+    q->frac = (int*)mlp_calloc(n_layers, sizeof(int));
+    q->weight_frac = (int*)mlp_calloc(n_layers, sizeof(int));
+
+    int widest = 0;
+    for (i = 0; i < n_layers; i++) {
+        q->layer_sizes[i] = layer_sizes[i];
+        if (layer_sizes[i] > widest)
+            widest = layer_sizes[i];
+    }
+
+    // Only the weights of the chosen format are allocated
+    q->weights_q7 = (int8_t**)mlp_calloc(n_layers-1, sizeof(int8_t*));
+    q->weights_q15 = (int16_t**)mlp_calloc(n_layers-1, sizeof(int16_t*));
+    q->bias = (int64_t**)mlp_calloc(n_layers-1, sizeof(int64_t*));
+    for (i = 0; i < n_layers-1; i++) {
+        size_t n_weights = (size_t)layer_sizes[i+1] * layer_sizes[i];
+        if (bits == QUANT_Q7)
+            q->weights_q7[i] = (int8_t*)mlp_calloc(n_weights, sizeof(int8_t));
+        else
+            q->weights_q15[i] = (int16_t*)mlp_calloc(n_weights, sizeof(int16_t));
+        q->bias[i] = (int64_t*)mlp_calloc(layer_sizes[i+1], sizeof(int64_t));
+    }
+
+    q->layer_input = (int16_t*)mlp_calloc(widest, sizeof(int16_t));
+    q->layer_output = (int16_t*)mlp_calloc(widest, sizeof(int16_t));
+    q->accumulator = (int64_t*)mlp_calloc(widest, sizeof(int64_t));
+}
+
+#ifndef MLP_FIRMWARE
+void quantized_model_create(quantized_model* q, parameters* param, int* layer_sizes, int bits) {
+    if (bits != QUANT_Q7 && bits != QUANT_Q15) {
+        printf("Error: Invalid quantization format, use QUANT_Q7 or QUANT_Q15\n");
+        exit(0);
+    }
+
+    int n_layers = param->n_hidden + 2;
+    int i, j, k;
+
+    quantized_model_alloc(q, bits, n_layers, layer_sizes);
+    for (i = 1; i < n_layers-1; i++)
+        q->activation[i] = param->hidden_activation_functions[i-1];
+    q->activation[n_layers-1] = param->output_activation_function;
+
+    // Run the network over the train dataset to find the range of every layer's outputs
+    simd_init();
+    layer_plan_create(&param->plan, param->n_hidden, param->hidden_activation_functions, param->output_activation_function,
+        param->activation_accuracy);
+    double* largest = (double*)mlp_calloc(n_layers, sizeof(double));
+    int n_samples = param->data_train.n_rows;
+    int block_size = n_samples < INFERENCE_BLOCK ? n_samples : INFERENCE_BLOCK;
+    if (block_size < 1)
+        block_size = 1;
+    inference_block block;
+    inference_block_create(&block, block_size, n_layers, layer_sizes);
+
+    mlp_real** float_output = (mlp_real**)mlp_calloc(n_samples, sizeof(mlp_real*));
+    for (i = 0; i < n_samples; i++)
+        float_output[i] = (mlp_real*)mlp_calloc(param->output_layer_size, sizeof(mlp_real));
+
+    int start;
+    for (start = 0; start < n_samples; start += block_size) {
+        int m = n_samples - start < block_size ? n_samples - start : block_size;
+        mlp_classify_block(param, layer_sizes, dataset_row(&param->data_train, start), m, &block, float_output + start);
+
+        for (i = 0; i < n_layers; i++)
+            for (j = 0; j < m; j++)
+                for (k = 1; k <= layer_sizes[i]; k++)
+                    largest[i] = fmax(largest[i], fabs(block.outputs[i][(size_t)j * (layer_sizes[i]+1) + k]));
+    }
+
+    // Bounded activations use all the bits of the format, the others their calibrated range
+    for (i = 0; i < n_layers; i++) {
+        if (i > 0 && (q->activation[i] == 2 || q->activation[i] == 3 || q->activation[i] == 5))
+            q->frac[i] = bits-1;
+        else
+            q->frac[i] = choose_frac(largest[i], bits);
+    }
+
+    // Quantize the weights, transposed to one row per output, and the biases at the accumulator's scale
+    for (i = 0; i < n_layers-1; i++) {
+        mlp_real* w = weight_matrix(&param->weight, i);
+        int stride = param->weight.stride[i];
+        int n = layer_sizes[i];
+        int p = layer_sizes[i+1];
+
+        // Row 0 of the weight matrix holds the biases
+        double largest_weight = 0.0;
+        for (j = 1; j <= n; j++)
+            for (k = 0; k < p; k++)
+                largest_weight = fmax(largest_weight, fabs(w[j * stride + k]));
+        q->weight_frac[i] = choose_frac(largest_weight, bits);
+
+        for (k = 0; k < p; k++) {
+            q->bias[i][k] = llround(ldexp(w[k], q->frac[i] + q->weight_frac[i]));
+            for (j = 0; j < n; j++) {
+                int16_t v = saturate(llround(ldexp(w[(j+1) * stride + k], q->weight_frac[i])), bits);
+                if (bits == QUANT_Q7)
+                    q->weights_q7[i][(size_t)k * n + j] = (int8_t)v;
+                else
+                    q->weights_q15[i][(size_t)k * n + j] = v;
+            }
+        }
+    }
+
+    // Report the accuracy lost against the network on the train dataset
+    mlp_real* output = (mlp_real*)mlp_calloc(param->output_layer_size, sizeof(mlp_real));
+    int float_correct = 0, quantized_correct = 0, agree = 0;
+    double max_error = 0.0;
+    for (i = 0; i < n_samples; i++) {
+        quantized_forward(q, dataset_row(&param->data_train, i), output);
+
+        int actual_class = (int)param->data_train.labels[i];
+        int float_class = predicted_class(float_output[i], param->output_layer_size);
+        int quantized_class = predicted_class(output, param->output_layer_size);
+        float_correct += float_class == actual_class;
+        quantized_correct += quantized_class == actual_class;
+        agree += float_class == quantized_class;
+
+        for (j = 0; j < param->output_layer_size; j++)
+            max_error = fmax(max_error, fabs(output[j] - float_output[i][j]));
+    }
+
+    if (n_samples > 0) {
+        printf("Quantized to q%d on %d train samples\n", bits-1, n_samples);
+        printf("Accuracy: %.2lf (%s) %.2lf (q%d), same class for %.2lf\n", 100.0 * float_correct / n_samples,
+            MLP_REAL_NAME, 100.0 * quantized_correct / n_samples, bits-1, 100.0 * agree / n_samples);
+        printf("Largest output error: %g\n", max_error);
+    }
+
+    // Free the memory of the calibration
+    mlp_free(output);
+    for (i = 0; i < n_samples; i++)
+        mlp_free(float_output[i]);
+    mlp_free(float_output);
+    inference_block_destroy(&block, n_layers);
+    layer_plan_destroy(&param->plan);
+    mlp_free(largest);
+}
+#endif
+
+// Size in bytes of the quantized model file of the given format and topology, padding included
+static size_t quantized_file_size(int bits, int n_layers, const int* layer_sizes) {
+    size_t size = sizeof(quantized_header) + 4 * (size_t)n_layers * sizeof(int32_t);
+    int i;
+    for (i = 0; i < n_layers-1; i++)
+        size += (size_t)layer_sizes[i+1] * (sizeof(int64_t) + (size_t)layer_sizes[i] * (bits / 8));
+    return (size + 3) / 4 * 4;
+}
+
+// Copy n values to and from int32 fields of a file, which need not be aligned
+#ifndef MLP_FIRMWARE
+static void put_int32(uint8_t** at, const int* values, int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        int32_t v = values[i];
+        memcpy(*at, &v, sizeof(v));
+        *at += sizeof(v);
+    }
+}
+#endif
+
+static void get_int32(const uint8_t** at, int* values, int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        int32_t v;
+        memcpy(&v, *at, sizeof(v));
+        values[i] = v;
+        *at += sizeof(v);
+    }
+}
+
+#ifndef MLP_FIRMWARE
+void quantized_model_save(quantized_model* q, const char* filename) {
+    int n_layers = q->n_layers;
+    int weight_size = q->bits / 8;
+
+    quantized_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, QUANT_MAGIC, sizeof(header.magic));
+    header.version = QUANT_VERSION;
+    header.bits = q->bits;
+    header.n_layers = n_layers;
+    header.file_size = quantized_file_size(q->bits, n_layers, q->layer_sizes);
+
+    // Assemble the whole file in memory
+    uint8_t* file = (uint8_t*)mlp_calloc(header.file_size, 1);
+    uint8_t* at = file + sizeof(header);
+    put_int32(&at, q->layer_sizes, n_layers);
+    put_int32(&at, q->activation, n_layers);
+    put_int32(&at, q->frac, n_layers);
+    put_int32(&at, q->weight_frac, n_layers);
+    int i;
+    for (i = 0; i < n_layers-1; i++) {
+        memcpy(at, q->bias[i], q->layer_sizes[i+1] * sizeof(int64_t));
+        at += q->layer_sizes[i+1] * sizeof(int64_t);
+    }
+    for (i = 0; i < n_layers-1; i++) {
+        size_t size = (size_t)q->layer_sizes[i+1] * q->layer_sizes[i] * weight_size;
+        memcpy(at, q->bits == QUANT_Q7 ? (const void*)q->weights_q7[i] : (const void*)q->weights_q15[i], size);
+        at += size;
+    }
+
+    header.checksum = model_checksum(file + sizeof(header), header.file_size - sizeof(header));
+    memcpy(file, &header, sizeof(header));
+
+    FILE* fp = fopen(filename, "wb");
+    if (NULL == fp) {
+        printf("Cannot create/open file %s. Make sure you have permission to create/open a file in the directory\n", filename);
+        exit(0);
+    }
+    if (fwrite(file, 1, header.file_size, fp) != header.file_size) {
+        printf("Error: Cannot write the quantized model to %s\n", filename);
+        exit(0);
+    }
+    fclose(fp);
+
+    mlp_free(file);
+}
+#endif
+
+int quantized_model_load_buffer(quantized_model* q, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    quantized_header header;
+    if (size < sizeof(header) || memcmp(bytes, QUANT_MAGIC, sizeof(header.magic)) != 0) {
+        printf("Error: Not a quantized model file\n");
+        return 0;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (header.version != QUANT_VERSION) {
+        printf("Error: Unsupported quantized model version %u (or file written with the other byte order)\n", (unsigned)header.version);
+        return 0;
+    }
+    if (header.bits != QUANT_Q7 && header.bits != QUANT_Q15) {
+        printf("Error: Invalid quantization format in the quantized model\n");
+        return 0;
+    }
+    if (header.file_size != size || size % 4 != 0 || header.n_layers < 2
+        || header.n_layers > (size - sizeof(header)) / (4 * sizeof(int32_t))) {
+        printf("Error: Quantized model file is truncated or corrupt\n");
+        return 0;
+    }
+    if (model_checksum(bytes + sizeof(header), size - sizeof(header)) != header.checksum) {
+        printf("Error: Quantized model checksum mismatch\n");
+        return 0;
+    }
+
+    // Topology, activations and scales, checked before anything is allocated for them
+    int n_layers = (int)header.n_layers;
+    int* fields = (int*)mlp_calloc(4 * (size_t)n_layers, sizeof(int));
+    int* layer_sizes = fields;
+    int* activation = fields + n_layers;
+    int* frac = fields + 2 * n_layers;
+    int* weight_frac = fields + 3 * n_layers;
+    const uint8_t* at = bytes + sizeof(header);
+    get_int32(&at, fields, 4 * n_layers);
+
+    int i, valid = 1;
+    for (i = 0; i < n_layers; i++)
+        valid = valid && layer_sizes[i] > 0 && (size_t)layer_sizes[i] <= size && (i == 0 || (activation[i] >= 1 && activation[i] <= 5))
+            && frac[i] >= 0 && frac[i] <= QUANT_MAX_FRAC && weight_frac[i] >= 0 && weight_frac[i] <= QUANT_MAX_FRAC;
+    if (!valid) {
+        printf("Error: Invalid topology in the quantized model\n");
+        mlp_free(fields);
+        return 0;
+    }
+    if (quantized_file_size((int)header.bits, n_layers, layer_sizes) != size) {
+        printf("Error: Quantized model does not match its topology\n");
+        mlp_free(fields);
+        return 0;
+    }
+
+    quantized_model_alloc(q, (int)header.bits, n_layers, layer_sizes);
+    memcpy(q->activation, activation, n_layers * sizeof(int));
+    memcpy(q->frac, frac, n_layers * sizeof(int));
+    memcpy(q->weight_frac, weight_frac, n_layers * sizeof(int));
+    for (i = 0; i < n_layers-1; i++) {
+        memcpy(q->bias[i], at, layer_sizes[i+1] * sizeof(int64_t));
+        at += layer_sizes[i+1] * sizeof(int64_t);
+    }
+    for (i = 0; i < n_layers-1; i++) {
+        size_t n_bytes = (size_t)layer_sizes[i+1] * layer_sizes[i] * (header.bits / 8);
+        memcpy(q->bits == QUANT_Q7 ? (void*)q->weights_q7[i] : (void*)q->weights_q15[i], at, n_bytes);
+        at += n_bytes;
+    }
+
+    mlp_free(fields);
+    return 1;
+}
+
+#ifndef MLP_FIRMWARE
+void quantized_model_open(quantized_model* q, const char* filename) {
+    FILE* fp = fopen(filename, "rb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t size = (size_t)ftell(fp);
+    rewind(fp);
+
+    uint8_t* data = (uint8_t*)mlp_malloc(size > 0 ? size : 1);
+    if (fread(data, 1, size, fp) != size) {
+        printf("Error: Cannot read the quantized model file %s\n", filename);
+        exit(0);
+    }
+    fclose(fp);
+
+    if (!quantized_model_load_buffer(q, data, size))
+        exit(0);
+    mlp_free(data);
+}
+#endif
+
+void quantized_model_destroy(quantized_model* q) {
+    int i;
+    for (i = 0; i < q->n_layers-1; i++) {
+        mlp_free(q->weights_q7[i]);
+        mlp_free(q->weights_q15[i]);
+        mlp_free(q->bias[i]);
+    }
+
+    mlp_free(q->weights_q7);
+    mlp_free(q->weights_q15);
+    mlp_free(q->bias);
+    mlp_free(q->accumulator);
+    mlp_free(q->layer_output);
+    mlp_free(q->layer_input);
+    mlp_free(q->weight_frac);
+    mlp_free(q->frac);
+    mlp_free(q->activation);
+    mlp_free(q->layer_sizes);
+}
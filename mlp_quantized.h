@@ -0,0 +1,89 @@
+#ifndef MLP_QUANTIZED_H
+#define MLP_QUANTIZED_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "mlp_alloc.h"
+#include "parameters.h"
+#include "mlp_model.h"
+#include "mlp_inference.h"
+
+// Integer formats of the quantized weights and activations
+#define QUANT_Q7 8   // int8, 7 fractional bits at most for values below 1
+#define QUANT_Q15 16 // int16, 15 fractional bits at most for values below 1
+
+// Largest number of fractional bits of a weight or activation, for tiny values
+#define QUANT_MAX_FRAC 24
+
+#define QUANT_MAGIC "MLPQ"
+#define QUANT_VERSION 1
+
+// Binary quantized model file, in the byte order of the machine that wrote it:
+//   quantized_header
+//   int32 layer_sizes[n_layers]
+//   int32 activation[n_layers]    Activation function of each layer, 0 for the input layer
+//   int32 frac[n_layers]
+//   int32 weight_frac[n_layers]   0 for the output layer
+//   int64 bias[l][layer_sizes[l+1]] for every layer l from 0 to n_layers-2
+//   int8 (q7) or int16 (q15) weights[l][layer_sizes[l+1]][layer_sizes[l]], one row per output
+//   zero padding up to a multiple of 4 bytes
+// The file holds no mlp_real, so the same file serves double and float builds
+typedef struct {
+    char magic[4];      // QUANT_MAGIC
+    uint32_t version;   // QUANT_VERSION
+    uint32_t bits;      // QUANT_Q7 or QUANT_Q15
+    uint32_t n_layers;
+    uint64_t file_size;
+    uint64_t checksum;  // Fletcher-64 (model_checksum) of the bytes after the header
+} quantized_header;
+
+// Fixed-point network: every value v is stored as round(v * 2^frac) with a power-of-two scale per layer,
+// so requantization is a rounded shift and inference uses integer arithmetic only
+// The results are bit-exact on every target
+typedef struct {
+    int bits;             // QUANT_Q7 or QUANT_Q15
+    int n_layers;
+    int* layer_sizes;
+    int* activation;      // activation[l]: activation function of layer l (l >= 1)
+    int* frac;            // frac[l]: fractional bits of the outputs of layer l
+    int* weight_frac;     // weight_frac[l]: fractional bits of the weights from layer l to layer l+1
+    int8_t** weights_q7;  // weights_q7[l]: layer_sizes[l+1] x layer_sizes[l], one row per output (QUANT_Q7)
+    int16_t** weights_q15; // Same layout for QUANT_Q15
+    int64_t** bias;       // bias[l]: bias of layer l+1 with frac[l] + weight_frac[l] fractional bits
+    int16_t* layer_input; // Scratch: quantized outputs of the previous layer, widest layer
+    int16_t* layer_output; // Scratch: quantized outputs of the current layer, widest layer
+    int64_t* accumulator; // Scratch: integer pre-activations of the current layer, widest layer
+} quantized_model;
+
+// Quantize the trained weights of param to the given format
+// The scales of the activations are calibrated on param->data_train, and the accuracies of the
+// unquantized and quantized networks on it are reported
+// Host only, like the file functions below: the firmware (MLP_FIRMWARE) only loads and classifies
+#ifndef MLP_FIRMWARE
+void quantized_model_create(quantized_model*, parameters*, int*, int);
+#endif
+void quantized_model_destroy(quantized_model*);
+
+// Classify n samples (rows of features one after the other) with the quantized network, one sample at a time
+// The outputs of sample i are written to final_output[i] as mlp_real, exactly the fixed-point values
+void quantized_classify(quantized_model*, const mlp_real*, int, mlp_real**);
+
+// Forward pass of one sample of layer_sizes[0] features, the outputs are written to final_output
+// Returns its class (0 or 1 for a single output, 1 to k for k outputs)
+int quantized_model_classify(quantized_model*, const mlp_real*, mlp_real*);
+
+#ifndef MLP_FIRMWARE
+// Write the quantized network to a file
+void quantized_model_save(quantized_model*, const char*);
+
+// Read a file written by quantized_model_save, stops the program on error
+void quantized_model_open(quantized_model*, const char*);
+#endif
+
+// Same for a file received at run time, e.g. uploaded to the firmware; the data is copied
+// Returns 1 for a valid file, 0 after printing the error, and does not stop the program
+int quantized_model_load_buffer(quantized_model*, const void*, size_t);
+
+#endif
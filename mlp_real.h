@@ -0,0 +1,26 @@
+#ifndef MLP_REAL_H
+#define MLP_REAL_H
+
+#include <math.h>
+
+// Numeric type of the weights, activations and datasets
+// double by default, float when built with -DMLP_FLOAT
+#ifdef MLP_FLOAT
+typedef float mlp_real;
+#define MLP_REAL_NAME "float"
+#define real_exp expf
+#define real_tanh tanhf
+#define real_fabs fabsf
+#define real_copysign copysignf
+#define real_sqrt sqrtf
+#else
+typedef double mlp_real;
+#define MLP_REAL_NAME "double"
+#define real_exp exp
+#define real_tanh tanh
+#define real_fabs fabs
+#define real_copysign copysign
+#define real_sqrt sqrt
+#endif
+
+#endif
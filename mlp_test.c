@@ -0,0 +1,222 @@
+/*
+Desc: Tests of the training modes: no heap allocation inside the epoch loop, data-parallel weights
+      identical for any thread count, reproducible seeds, and a network that learns
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_trainer.h"
+#include "mlp_inference.h"
+#include "read_csv.h"
+
+#define TEST_SEED 7
+#define TEST_EPOCHS 10
+
+// A learning rate large enough to saturate the sigmoids within a few epochs, after which the validation loss stops falling
+#define PLATEAU_LR 4.0
+#define PLATEAU_EPOCHS 100
+
+// Binary dataset file written for the streaming test and removed afterwards, read in shards of a few hundred rows
+#define TEST_DATASET "mlp_test.mlpd"
+#define TEST_STREAM_BUDGET 16384
+
+static int failures = 0;
+
+static void check(int ok, const char* name, const char* what) {
+    printf("%s: %s %s\n", ok ? "PASS" : "FAIL", name, what);
+    failures += !ok;
+}
+
+// A 4-6-1 sigmoid network trained on data with a fixed seed
+typedef struct {
+    parameters param;
+    int hidden_layers_size[1];
+    int hidden_activation_functions[1];
+    int layer_sizes[3];
+} test_network;
+
+static void network_create(test_network* net, const dataset* data, int batch_size, int parallel_mode, int n_threads) {
+    memset(net, 0, sizeof(test_network));
+    parameters* param = &net->param;
+
+    net->hidden_layers_size[0] = 6;
+    net->hidden_activation_functions[0] = 2;
+    net->layer_sizes[0] = data->n_features;
+    net->layer_sizes[1] = 6;
+    net->layer_sizes[2] = 1;
+
+    param->n_hidden = 1;
+    param->hidden_layers_size = net->hidden_layers_size;
+    param->hidden_activation_functions = net->hidden_activation_functions;
+    param->output_layer_size = 1;
+    param->output_activation_function = 2;
+    param->learning_rate = 0.05;
+    param->n_iterations_max = TEST_EPOCHS;
+    param->seed = TEST_SEED;
+    param->batch_size = batch_size;
+    param->parallel_mode = parallel_mode;
+    param->n_threads = n_threads;
+    param->gradient_shards = 8;
+
+    // The dataset is shared by the tests, not owned by the network
+    param->data_train = *data;
+    weight_arena_create(&param->weight, 3, net->layer_sizes);
+}
+
+static void network_destroy(test_network* net) {
+    weight_arena_destroy(&net->param.weight);
+}
+
+// Fraction of the rows of data the trained network classifies correctly
+static double network_accuracy(test_network* net, const dataset* data) {
+    parameters* param = &net->param;
+    simd_init();
+    layer_plan_create(&param->plan, param->n_hidden, param->hidden_activation_functions, param->output_activation_function,
+        param->activation_accuracy);
+
+    inference_block block;
+    inference_block_create(&block, INFERENCE_BLOCK, 3, net->layer_sizes);
+    mlp_real* output = (mlp_real*)mlp_calloc(data->n_rows, sizeof(mlp_real));
+    mlp_real** outputs = (mlp_real**)mlp_calloc(data->n_rows, sizeof(mlp_real*));
+    int i, correct = 0;
+    for (i = 0; i < data->n_rows; i++)
+        outputs[i] = output + i;
+
+    mlp_classify_block(param, net->layer_sizes, data->features, data->n_rows, &block, outputs);
+    for (i = 0; i < data->n_rows; i++)
+        correct += (output[i] < 0.5 ? 0 : 1) == (int)data->labels[i];
+
+    mlp_free(outputs);
+    mlp_free(output);
+    inference_block_destroy(&block, 3);
+    layer_plan_destroy(&param->plan);
+    return (double)correct / data->n_rows;
+}
+
+int main(void) {
+    // The banknote train dataset, labels 0 and 1
+    int rows, cols;
+    mlp_real** table = read_csv_auto("data/data_train.csv", &rows, &cols);
+    dataset data;
+    dataset_from_table(&data, table[0], rows, cols);
+    free_csv(table);
+
+    test_network net;
+    unsigned long allocations;
+
+    // Per-sample and mini-batch training
+    network_create(&net, &data, 1, TRAIN_SERIAL, 1);
+    allocations = mlp_trainer(&net.param, net.layer_sizes);
+    check(allocations == 0, "serial", "allocates nothing inside the epoch loop");
+    check(network_accuracy(&net, &data) > 0.9, "serial", "classifies 90% of the train dataset");
+    network_destroy(&net);
+
+    network_create(&net, &data, 16, TRAIN_SERIAL, 1);
+    allocations = mlp_trainer(&net.param, net.layer_sizes);
+    check(allocations == 0, "batch", "allocates nothing inside the epoch loop");
+    check(network_accuracy(&net, &data) > 0.9, "batch", "classifies 90% of the train dataset");
+    network_destroy(&net);
+
+    network_create(&net, &data, 1, TRAIN_HOGWILD, 4);
+    allocations = mlp_trainer(&net.param, net.layer_sizes);
+    check(allocations == 0, "hogwild", "allocates nothing inside the epoch loop");
+    check(network_accuracy(&net, &data) > 0.9, "hogwild", "classifies 90% of the train dataset");
+    network_destroy(&net);
+
+    // Hogwild threads share the state of Adam, every update of every thread is counted once in its step
+    network_create(&net, &data, 1, TRAIN_HOGWILD, 4);
+    net.param.optimizer = OPTIMIZER_ADAM;
+    net.param.learning_rate = 0.01;
+    allocations = mlp_trainer(&net.param, net.layer_sizes);
+    check(allocations == 0, "hogwild adam", "allocates nothing inside the epoch loop");
+    check(net.param.moments.step == (long)data.n_rows * TEST_EPOCHS, "hogwild adam", "counts the step of every update");
+    check(network_accuracy(&net, &data) > 0.9, "hogwild adam", "classifies 90% of the train dataset");
+    network_destroy(&net);
+
+    // Data-parallel training gives the same weights for any number of threads
+    int thread_counts[] = { 1, 3, 8 };
+    weight_arena first;
+    weight_arena_create(&first, 3, net.layer_sizes);
+    int t;
+    for (t = 0; t < 3; t++) {
+        char name[32];
+        snprintf(name, sizeof(name), "data-parallel x%d", thread_counts[t]);
+        network_create(&net, &data, 32, TRAIN_DATA_PARALLEL, thread_counts[t]);
+        allocations = mlp_trainer(&net.param, net.layer_sizes);
+        check(allocations == 0, name, "allocates nothing inside the epoch loop");
+        check(network_accuracy(&net, &data) > 0.9, name, "classifies 90% of the train dataset");
+        if (t == 0)
+            memcpy(first.data, net.param.weight.data, first.size * sizeof(mlp_real));
+        else
+            check(memcmp(first.data, net.param.weight.data, first.size * sizeof(mlp_real)) == 0, name,
+                "trains the same weights as one thread");
+        network_destroy(&net);
+    }
+
+    // Per-sample weights depend on the order of the samples, so a second run with the same seed
+    // only trains the same weights if it draws the same initial weights and the same shuffle in
+    // every epoch, and a run with another seed trains other weights
+    network_create(&net, &data, 1, TRAIN_SERIAL, 1);
+    mlp_trainer(&net.param, net.layer_sizes);
+    memcpy(first.data, net.param.weight.data, first.size * sizeof(mlp_real));
+    network_destroy(&net);
+    network_create(&net, &data, 1, TRAIN_SERIAL, 1);
+    mlp_trainer(&net.param, net.layer_sizes);
+    check(memcmp(first.data, net.param.weight.data, first.size * sizeof(mlp_real)) == 0, "seed",
+        "shuffles the samples in the same order on every run");
+    network_destroy(&net);
+    network_create(&net, &data, 1, TRAIN_SERIAL, 1);
+    net.param.seed = TEST_SEED + 1;
+    mlp_trainer(&net.param, net.layer_sizes);
+    check(memcmp(first.data, net.param.weight.data, first.size * sizeof(mlp_real)) != 0, "seed",
+        "trains other weights with another seed");
+    network_destroy(&net);
+    weight_arena_destroy(&first);
+
+    // Held-out validation rows scored every epoch, with early stopping
+    network_create(&net, &data, 16, TRAIN_DATA_PARALLEL, 3);
+    net.param.validation_fraction = 0.2;
+    net.param.validation_interval = 1;
+    net.param.patience = 2;
+    allocations = mlp_trainer(&net.param, net.layer_sizes);
+    check(allocations == 0, "validation", "allocates nothing inside the epoch loop");
+    network_destroy(&net);
+
+    // Per-sample weights are reproducible with the same seed, so the weights kept after an early stop
+    // must be those of a second run that trains exactly best_epoch epochs
+    network_create(&net, &data, 1, TRAIN_SERIAL, 1);
+    net.param.learning_rate = PLATEAU_LR;
+    net.param.n_iterations_max = PLATEAU_EPOCHS;
+    net.param.validation_fraction = 0.2;
+    net.param.validation_interval = 1;
+    net.param.patience = 2;
+    mlp_trainer(&net.param, net.layer_sizes);
+    int best_epoch = net.param.best_epoch;
+    check(net.param.epochs_trained < PLATEAU_EPOCHS, "early stopping", "stops once the validation loss plateaus");
+    check(best_epoch > 0 && best_epoch == net.param.epochs_trained - 2, "early stopping", "keeps the epoch of the lowest loss");
+    weight_arena best;
+    weight_arena_create(&best, 3, net.layer_sizes);
+    memcpy(best.data, net.param.weight.data, best.size * sizeof(mlp_real));
+    network_destroy(&net);
+    network_create(&net, &data, 1, TRAIN_SERIAL, 1);
+    net.param.learning_rate = PLATEAU_LR;
+    net.param.n_iterations_max = best_epoch;
+    net.param.validation_fraction = 0.2;
+    mlp_trainer(&net.param, net.layer_sizes);
+    check(memcmp(best.data, net.param.weight.data, best.size * sizeof(mlp_real)) == 0, "early stopping",
+        "restores the weights of the best epoch");
+    weight_arena_destroy(&best);
+    network_destroy(&net);
+
+    // Training streamed from a binary dataset file
+    dataset_save(&data, TEST_DATASET);
+    network_create(&net, &data, 16, TRAIN_SERIAL, 1);
+    allocations = mlp_trainer_stream(&net.param, net.layer_sizes, TEST_DATASET, TEST_STREAM_BUDGET);
+    check(allocations == 0, "stream", "allocates nothing inside the epoch loop");
+    network_destroy(&net);
+    remove(TEST_DATASET);
+
+    dataset_destroy(&data);
+
+    printf("%d failed\n", failures);
+    return failures > 0;
+}
@@ -0,0 +1,206 @@
+/*
+Desc: Timeline of training and inference as Chrome trace events, recorded in per-thread ring buffers
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "mlp_trace.h"
+
+#ifdef MLP_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "thread_pool.h"
+
+#ifdef MLP_THREADS
+#include <pthread.h>
+#endif
+
+// Threads with a ring buffer, further threads are not traced
+#define TRACE_MAX_THREADS 256
+
+// Depth of nested scopes per thread
+#define TRACE_MAX_DEPTH 32
+
+// A finished scope, written as one complete ("X") event
+typedef struct {
+    const char* name;
+    int arg;
+    uint64_t start;    // ns since the first event
+    uint64_t duration; // ns
+} trace_event;
+
+// Events of one thread, written only by that thread until the trace is written
+// Rings of exited threads are kept until then
+typedef struct {
+    int tid;
+    uint64_t n_events; // Events recorded since the last write, the last TRACE_RING_EVENTS of them are kept
+    int depth;
+    const char* open_name[TRACE_MAX_DEPTH];
+    int open_arg[TRACE_MAX_DEPTH];
+    uint64_t open_start[TRACE_MAX_DEPTH];
+    trace_event events[TRACE_RING_EVENTS];
+} trace_thread;
+
+static trace_thread* trace_threads[TRACE_MAX_THREADS];
+static int trace_n_threads = 0;
+static trace_thread* trace_spare[TRACE_MAX_THREADS]; // Rings created by trace_reserve, not taken by a thread yet
+static int trace_n_spare = 0;
+static uint64_t trace_origin = 0; // Time of the first event
+#ifdef MLP_THREADS
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static __thread trace_thread* trace_self = NULL;
+static __thread int trace_untracked = 0;
+
+static uint64_t trace_now(void) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+#else
+    return (uint64_t)((double)clock() / CLOCKS_PER_SEC * 1e9);
+#endif
+}
+
+// Write the trace at exit to the file named by MLP_TRACE
+static void trace_at_exit(void) {
+    const char* filename = getenv("MLP_TRACE");
+    trace_write(filename != NULL && filename[0] != '\0' ? filename : "mlp_trace.json");
+}
+
+// Ring of a thread recording its first event, a spare one when trace_reserve left one
+static trace_thread* trace_thread_create(void) {
+    trace_thread* t = NULL;
+
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&trace_lock);
+#endif
+    if (trace_n_threads == 0 && trace_origin == 0) {
+        trace_origin = trace_now();
+        atexit(trace_at_exit);
+    }
+    if (trace_n_threads < TRACE_MAX_THREADS) {
+        t = trace_n_spare > 0 ? trace_spare[--trace_n_spare] : (trace_thread*)mlp_calloc(1, sizeof(trace_thread));
+        if (t != NULL) {
+            t->tid = trace_n_threads;
+            trace_threads[trace_n_threads++] = t;
+        }
+    }
+#ifdef MLP_THREADS
+    pthread_mutex_unlock(&trace_lock);
+#endif
+
+    return t;
+}
+
+void trace_reserve(int n_threads) {
+    // The calling thread takes its ring at once
+    if (trace_self == NULL && !trace_untracked) {
+        trace_self = trace_thread_create();
+        trace_untracked = trace_self == NULL;
+    }
+
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&trace_lock);
+#endif
+    // Spare rings for the other threads, within TRACE_MAX_THREADS with those already taken
+    while (trace_n_spare < n_threads - 1 && trace_n_threads + trace_n_spare < TRACE_MAX_THREADS) {
+        trace_thread* t = (trace_thread*)mlp_calloc(1, sizeof(trace_thread));
+        if (NULL == t)
+            break;
+        trace_spare[trace_n_spare++] = t;
+    }
+#ifdef MLP_THREADS
+    pthread_mutex_unlock(&trace_lock);
+#endif
+}
+
+void trace_begin(const char* name, int arg) {
+    trace_thread* t = trace_self;
+    if (t == NULL) {
+        if (trace_untracked)
+            return;
+        t = trace_self = trace_thread_create();
+        if (t == NULL) {
+            trace_untracked = 1;
+            return;
+        }
+    }
+
+    // Scopes nested deeper than TRACE_MAX_DEPTH are counted but not recorded
+    if (t->depth < TRACE_MAX_DEPTH) {
+        t->open_name[t->depth] = name;
+        t->open_arg[t->depth] = arg;
+        t->open_start[t->depth] = trace_now();
+    }
+    t->depth++;
+}
+
+void trace_end(void) {
+    trace_thread* t = trace_self;
+    if (t == NULL || t->depth == 0)
+        return;
+
+    t->depth--;
+    if (t->depth < TRACE_MAX_DEPTH) {
+        uint64_t end = trace_now();
+        trace_event* e = &t->events[t->n_events % TRACE_RING_EVENTS];
+        e->name = t->open_name[t->depth];
+        e->arg = t->open_arg[t->depth];
+        e->start = t->open_start[t->depth] - trace_origin;
+        e->duration = end - t->open_start[t->depth];
+        t->n_events++;
+    }
+}
+
+void trace_write(const char* filename) {
+    FILE* fp = fopen(filename, "w");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        return;
+    }
+
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&trace_lock);
+#endif
+
+    // Timestamps and durations in microseconds, one track per thread
+    fprintf(fp, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    fprintf(fp, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"mlp\"}}");
+
+    unsigned long dropped = 0;
+    int i;
+    for (i = 0; i < trace_n_threads; i++) {
+        trace_thread* t = trace_threads[i];
+        fprintf(fp, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"thread %d\"}}", t->tid, t->tid);
+
+        // Only the newest TRACE_RING_EVENTS events of a thread are still in its ring
+        uint64_t first = t->n_events > TRACE_RING_EVENTS ? t->n_events - TRACE_RING_EVENTS : 0;
+        dropped += (unsigned long)first;
+        uint64_t k;
+        for (k = first; k < t->n_events; k++) {
+            const trace_event* e = &t->events[k % TRACE_RING_EVENTS];
+            fprintf(fp, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f",
+                e->name, t->tid, e->start / 1e3, e->duration / 1e3);
+            if (e->arg >= 0)
+                fprintf(fp, ", \"args\": {\"n\": %d}", e->arg);
+            fprintf(fp, "}");
+        }
+        t->n_events = 0;
+    }
+    fprintf(fp, "\n]}\n");
+
+#ifdef MLP_THREADS
+    pthread_mutex_unlock(&trace_lock);
+#endif
+
+    if (fclose(fp) != 0)
+        printf("Error writing %s\n", filename);
+    if (dropped > 0)
+        printf("Trace: the oldest %lu events did not fit in the ring buffers of %d events\n", dropped, TRACE_RING_EVENTS);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef MLP_TRACE_H
+#define MLP_TRACE_H
+
+// Built with -DMLP_TRACE (make MLP_TRACE=1) the scopes marked with TRACE_BEGIN and TRACE_END are
+// recorded into a ring buffer of the calling thread, without locks, and written at exit as a
+// Chrome trace (chrome://tracing, ui.perfetto.dev) to the file named by the MLP_TRACE environment
+// variable, mlp_trace.json by default. Without it the macros expand to nothing
+#ifdef MLP_TRACE
+
+// Events kept per thread, the oldest are overwritten once the ring is full
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 65536
+#endif
+
+// Start a scope named by a string literal, arg (e.g. an epoch or layer number) is shown when >= 0
+void trace_begin(const char*, int);
+// End the innermost scope of the calling thread
+void trace_end(void);
+// Write the events of all threads recorded so far to a trace file and clear them
+void trace_write(const char*);
+// Create the ring of the calling thread, and spare rings until n_threads - 1 threads that have not
+// recorded an event yet can start without allocating, e.g. inside the epoch loop
+void trace_reserve(int);
+
+#define TRACE_BEGIN(name, arg) trace_begin(name, arg)
+#define TRACE_END() trace_end()
+#define TRACE_RESERVE(n_threads) trace_reserve(n_threads)
+
+#else
+
+#define TRACE_BEGIN(name, arg) ((void)0)
+#define TRACE_END() ((void)0)
+#define TRACE_RESERVE(n_threads) ((void)0)
+
+#endif
+
+#endif
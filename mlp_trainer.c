@@ -8,89 +8,494 @@ GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
 #include "mlp_trainer.h"
 
 void initialize_weights(parameters* param, int n_layers, int* layer_sizes) {
-    srand(time(0));
-
     // epsilon = sqrt(6/(layer_size[i] + layer_size[i+1])) used for random initialization
-    double* epsilon = (double*)calloc(n_layers-1, sizeof(double));
+    mlp_real* epsilon = (mlp_real*)mlp_calloc(n_layers-1, sizeof(mlp_real));
     int i;
     for (i = 0; i < n_layers-1; i++)
         epsilon[i] = sqrt(6.0 / (layer_sizes[i] + layer_sizes[i+1]));
 
     // Random initialization between [-epsilon[i], epsilon[i]] for weight[i]
     int j, k;
-    for (i = 0; i < n_layers-1; i++)
+    for (i = 0; i < n_layers-1; i++) {
+        mlp_real* weight = weight_matrix(&param->weight, i);
         for (j = 0; j < layer_sizes[i]+1; j++)
             for (k = 0; k < layer_sizes[i+1]; k++)
-                param->weight[i][j][k] = -epsilon[i] + ((double)rand() / ((double)RAND_MAX / (2.0 * epsilon[i])));
+                weight[j * param->weight.stride[i] + k] = -epsilon[i] + ((double)rand() / ((double)RAND_MAX / (2.0 * epsilon[i])));
+    }
 
     // Free the memory allocated in Heap for epsilon array
-    free(epsilon);
+    mlp_free(epsilon);
 }
 
-void randomly_shuffle(int* a, int n) {
+// Fisher-Yates shuffle continuing the sequence of rand() seeded by training_run_create
+static void shuffle(int* a, int n) {
+    TRACE_BEGIN("shuffle", n);
     int i, j;
-    srand(time(NULL));
     for (i = n-1; i > 0; i--) {
         j = rand() % (i+1);
         int temp = a[i];
         a[i] = a[j];
         a[j] = temp;
     }
+    TRACE_END();
+}
+
+void train_samples(parameters* param, int n_layers, int* layer_sizes, training_workspace* ws, int* indices, int n_samples) {
+    int training_example, j;
+    if (param->batch_size > 1) {
+        // Train on consecutive batches of the shuffled data, the last one may be smaller
+        mini_batch* batch = &ws->batch;
+        for (j = 0; j < n_samples; j += batch->size) {
+            batch->size = n_samples - j < batch->capacity ? n_samples - j : batch->capacity;
+            TRACE_BEGIN("batch", j);
+
+            // Perform forward propagation on the whole batch
+            forward_propagation_batch(param, indices + j, n_layers, layer_sizes, batch);
+
+            // Perform back propagation and update weights once for the batch
+            back_propagation_batch(param, indices + j, n_layers, layer_sizes, batch);
+            TRACE_END();
+        }
+    }
+    else {
+        for (j = 0; j < n_samples; j++) {
+            TRACE_BEGIN("batch", j);
+            training_example = indices[j];
+            // Perform forward propagation on the jth training example
+            forward_propagation(param, training_example, n_layers, layer_sizes, ws->layer_inputs, ws->layer_outputs);
+
+            // Calculate the error
+
+            // Perform back propagation and update weights
+            back_propagation(param, training_example, n_layers, layer_sizes, ws);
+            TRACE_END();
+        }
+    }
+}
+
+// Work of one Hogwild thread in an epoch
+typedef struct {
+    parameters* param;
+    int n_layers;
+    int* layer_sizes;
+    training_workspace* ws; // One workspace per thread
+    int* indices;
+    int n_rows;             // Number of training examples in indices
+} hogwild_task;
+
+void hogwild_worker(void* arg, int thread_id, int n_threads) {
+    hogwild_task* task = (hogwild_task*)arg;
+
+    // Every thread trains on its own contiguous slice of the shuffled epoch
+    int n = task->n_rows;
+    int start = (int)((long long)n * thread_id / n_threads);
+    int end = (int)((long long)n * (thread_id+1) / n_threads);
+
+    // The weights are shared and updated without locks, as in Hogwild: concurrent updates
+    // may overwrite each other, which SGD tolerates when the updates are small
+    // The state of the optimizer is shared the same way
+    TRACE_BEGIN("hogwild slice", thread_id);
+    train_samples(task->param, task->n_layers, task->layer_sizes, &task->ws[thread_id], task->indices + start, end - start);
+    TRACE_END();
+}
+
+// Work of the threads for one batch of synchronous data-parallel training
+typedef struct {
+    parameters* param;
+    int n_layers;
+    int* layer_sizes;
+    mini_batch* shards;  // gradient_shards fixed shards of the batch, each with its own gradient accumulator
+    int n_shards;
+    int* batch_indices;  // Training examples of the current batch
+    int batch_size;      // Number of samples in the current batch
+    update_step step;    // Coefficients of the update of the current batch, the same for every thread
+} data_parallel_task;
+
+void data_parallel_gradients(void* arg, int thread_id, int n_threads) {
+    data_parallel_task* task = (data_parallel_task*)arg;
+
+    // Shards are assigned round-robin; the samples of a shard do not depend on the thread count
+    int s;
+    for (s = thread_id; s < task->n_shards; s += n_threads) {
+        mini_batch* shard = &task->shards[s];
+        int start = s * shard->capacity;
+        int end = start + shard->capacity < task->batch_size ? start + shard->capacity : task->batch_size;
+        shard->size = end > start ? end - start : 0;
+        if (shard->size == 0)
+            start = 0;
+
+        // Gradient of the shard summed over its samples in order, the weights are not touched
+        TRACE_BEGIN("shard gradients", s);
+        forward_propagation_batch(task->param, task->batch_indices + start, task->n_layers, task->layer_sizes, shard);
+        weight_gradient_batch(task->param, task->batch_indices + start, task->n_layers, task->layer_sizes, shard);
+        TRACE_END();
+    }
+}
+
+void data_parallel_update(void* arg, int thread_id, int n_threads) {
+    data_parallel_task* task = (data_parallel_task*)arg;
+
+    // Every thread reduces and updates its own range of weights
+    TRACE_BEGIN("reduce and update", thread_id);
+    PERF_BEGIN(PERF_WEIGHT_UPDATE);
+    size_t size = task->shards[0].weight_correction.size;
+    size_t start = size * thread_id / n_threads;
+    size_t end = size * (thread_id+1) / n_threads;
+
+    // Pairwise tree reduction of the shard gradients in a fixed order: shard s receives shard s+step
+    size_t k;
+    int s, step;
+    for (step = 1; step < task->n_shards; step *= 2) {
+        for (s = 0; s + step < task->n_shards; s += 2*step) {
+            mlp_real* sum = task->shards[s].weight_correction.data;
+            mlp_real* other = task->shards[s+step].weight_correction.data;
+            for (k = start; k < end; k++)
+                sum[k] += other[k];
+        }
+    }
+
+    // One update with the gradient averaged over the batch, the optimizer state of the range updated with it
+    optimizer_update(&task->param->moments, &task->step, &task->param->weight, &task->shards[0].weight_correction, start, end);
+    PERF_END(PERF_WEIGHT_UPDATE);
+    TRACE_END();
 }
 
-void mlp_trainer(parameters* param, int* layer_sizes) {
+// Scratch memory and threads of a training run, created once and reused for every pass
+typedef struct {
+    int n_layers;
+    int n_workspaces;
+    training_workspace* ws; // One workspace per Hogwild thread
+    int n_shards;
+    mini_batch* shards;     // Gradient shards of data-parallel training
+    thread_pool* pool;
+    int* indices;           // Order of the training examples in a pass
+    hogwild_task task;
+    data_parallel_task dp_task;
+} training_run;
+
+// Set up a run training on up to max_rows rows at a time and initialize the weights
+static void training_run_create(training_run* run, parameters* param, int* layer_sizes, int max_rows) {
     // Total number of layers
     int n_layers = param->n_hidden + 2;
+    run->n_layers = n_layers;
 
-    // Create memory for arrays of inputs to the layers
-    double** layer_inputs = (double**)calloc(n_layers, sizeof(double*));
+    // Pick the kernels for this CPU, and those of every layer
+    simd_init();
+    layer_plan_create(&param->plan, param->n_hidden, param->hidden_activation_functions, param->output_activation_function,
+        param->activation_accuracy);
 
+    // Number of threads, each with its own scratch memory for the training step
+    // created once and reused for every sample
+    int n_threads = param->parallel_mode != TRAIN_SERIAL && param->n_threads > 1 ? param->n_threads : 1;
+    run->n_workspaces = param->parallel_mode == TRAIN_HOGWILD ? n_threads : 1;
+    run->ws = (training_workspace*)mlp_calloc(run->n_workspaces, sizeof(training_workspace));
     int i;
-    for (i = 0; i < n_layers; i++)
-        layer_inputs[i] = (double*)calloc(layer_sizes[i], sizeof(double));
+    for (i = 0; i < run->n_workspaces; i++)
+        training_workspace_create(&run->ws[i], param, n_layers, layer_sizes);
+
+    // Data-parallel training splits every batch into a fixed number of shards, independent of the
+    // number of threads, each with its own matrices and gradient accumulator
+    int batch_size = param->batch_size > 1 ? param->batch_size : 1;
+    run->n_shards = param->gradient_shards > 1 ? param->gradient_shards : 1;
+    run->shards = NULL;
+    if (param->parallel_mode == TRAIN_DATA_PARALLEL) {
+        run->shards = (mini_batch*)mlp_calloc(run->n_shards, sizeof(mini_batch));
+        for (i = 0; i < run->n_shards; i++)
+            mini_batch_create(&run->shards[i], (batch_size + run->n_shards - 1) / run->n_shards, n_layers, layer_sizes);
+    }
 
-    // Create memory for arrays of outputs from the layers
-    double** layer_outputs = (double**)calloc(n_layers, sizeof(double*));
+    run->pool = thread_pool_create(n_threads);
+    // The threads of the pool record their first trace events inside the epoch loop
+    TRACE_RESERVE(n_threads);
 
-    for (i = 0; i < n_layers; i++)
-        layer_outputs[i] = (double*)calloc(layer_sizes[i]+1, sizeof(double));
+    // Seed rand() once for the run, so the weights and every shuffle follow from param->seed
+    srand(param->seed > 0 ? param->seed : (unsigned int)time(NULL));
 
-    // Initialize the weights
+    // Initialize the weights, and the state of the optimizer beside them
     initialize_weights(param, n_layers, layer_sizes);
+    optimizer_create(&param->moments, param->optimizer, param->momentum, param->decay, n_layers, layer_sizes);
+
+    run->indices = (int*)mlp_calloc(max_rows, sizeof(int));
+    for (i = 0; i < max_rows; i++)
+        run->indices[i] = i;
+
+    hogwild_task task = { param, n_layers, layer_sizes, run->ws, run->indices, 0 };
+    data_parallel_task dp_task = { param, n_layers, layer_sizes, run->shards, run->n_shards, run->indices, 0, { 0, 0, 0, 0, 0, 0 } };
+    run->task = task;
+    run->dp_task = dp_task;
+}
 
-    int* indices = (int*)calloc(param->train_sample_size, sizeof(int));
-    for (i = 0; i < param->train_sample_size; i++)
-        indices[i] = i;
+// One pass over the rows of param->data_train in the first n_rows entries of run->indices, in their order
+static void train_pass(training_run* run, parameters* param, int* layer_sizes, int n_rows) {
+    int batch_size = param->batch_size > 1 ? param->batch_size : 1;
+
+    if (param->parallel_mode == TRAIN_DATA_PARALLEL) {
+        // Gradients of the shards in parallel, then the reduction and one weight update per batch
+        int j;
+        for (j = 0; j < n_rows; j += batch_size) {
+            TRACE_BEGIN("batch", j);
+            run->dp_task.batch_indices = run->indices + j;
+            run->dp_task.batch_size = n_rows - j < batch_size ? n_rows - j : batch_size;
+            optimizer_step(&param->moments, param->learning_rate, run->dp_task.batch_size, &run->dp_task.step);
+            thread_pool_run(run->pool, data_parallel_gradients, &run->dp_task);
+            thread_pool_run(run->pool, data_parallel_update, &run->dp_task);
+            TRACE_END();
+        }
+    }
+    else if (param->parallel_mode == TRAIN_HOGWILD && thread_pool_size(run->pool) > 1) {
+        run->task.n_rows = n_rows;
+        thread_pool_run(run->pool, hogwild_worker, &run->task);
+    }
+    else
+        train_samples(param, run->n_layers, layer_sizes, &run->ws[0], run->indices, n_rows);
+}
+
+static void training_run_destroy(training_run* run) {
+    // Free the memory allocated in Heap
+    mlp_free(run->indices);
+
+    thread_pool_destroy(run->pool);
+
+    int i;
+    if (run->shards != NULL) {
+        for (i = 0; i < run->n_shards; i++)
+            mini_batch_destroy(&run->shards[i], run->n_layers);
+        mlp_free(run->shards);
+    }
+
+    for (i = 0; i < run->n_workspaces; i++)
+        training_workspace_destroy(&run->ws[i], run->n_layers);
+
+    mlp_free(run->ws);
+
+    optimizer_destroy(&run->task.param->moments);
+    layer_plan_destroy(&run->task.param->plan);
+}
+
+// Rows of data_train held out from training and scored every validation_interval epochs,
+// with every buffer of the scoring and the best weights so far created before the epoch loop
+typedef struct {
+    int n_rows;
+    int* rows;               // Rows of data_train held out, the last n_rows of the indices of the run
+    mlp_real* features;      // Their features gathered one after the other, as the batched inference reads them
+    int n_blocks;
+    inference_block* blocks; // Activations of every thread of the pool
+    mlp_real** outputs;      // Network outputs of every held-out row
+    weight_arena best;       // Weights of the lowest validation loss so far
+    double best_loss;
+    int best_epoch;
+} validation_split;
+
+static void validation_create(validation_split* v, training_run* run, parameters* param, int* layer_sizes) {
+    // Without a validation split nothing is held out and no weights are kept
+    memset(v, 0, sizeof(validation_split));
+    int n_rows = param->data_train.n_rows;
+    v->n_rows = (int)(param->validation_fraction * n_rows);
+    if (param->validation_fraction < 0 || param->validation_fraction >= 1 || (param->validation_fraction > 0 && v->n_rows < 1)) {
+        printf("Error: The validation fraction %g leaves no rows to train or to validate on\n", (double)param->validation_fraction);
+        exit(0);
+    }
+    if (v->n_rows == 0)
+        return;
+
+    // The held-out rows are drawn at random once, and stay at the end of the indices for the whole run
+    shuffle(run->indices, n_rows);
+    v->rows = run->indices + n_rows - v->n_rows;
+
+    int n_features = layer_sizes[0];
+    v->features = (mlp_real*)mlp_calloc((size_t)v->n_rows * n_features, sizeof(mlp_real));
+    int i;
+    for (i = 0; i < v->n_rows; i++)
+        memcpy(v->features + (size_t)i * n_features, dataset_row(&param->data_train, v->rows[i]), n_features * sizeof(mlp_real));
+
+    v->outputs = (mlp_real**)mlp_calloc(v->n_rows, sizeof(mlp_real*));
+    for (i = 0; i < v->n_rows; i++)
+        v->outputs[i] = (mlp_real*)mlp_calloc(param->output_layer_size, sizeof(mlp_real));
+
+    // One block of activations for each thread of the pool
+    int block_size = v->n_rows < INFERENCE_BLOCK ? v->n_rows : INFERENCE_BLOCK;
+    v->n_blocks = thread_pool_size(run->pool);
+    v->blocks = (inference_block*)mlp_calloc(v->n_blocks, sizeof(inference_block));
+    for (i = 0; i < v->n_blocks; i++)
+        inference_block_create(&v->blocks[i], block_size, run->n_layers, layer_sizes);
+
+    weight_arena_create(&v->best, run->n_layers, layer_sizes);
+    v->best_loss = -1;
+}
+
+// Squared error of the network averaged over the held-out rows, with the fraction classified correctly
+static double validation_loss(validation_split* v, training_run* run, parameters* param, int* layer_sizes, double* accuracy) {
+    TRACE_BEGIN("validation", v->n_rows);
+    mlp_classify_batch(param, layer_sizes, v->features, v->n_rows, run->pool, v->blocks, v->outputs);
+    TRACE_END();
+
+    double loss = 0;
+    int i, j, correct = 0;
+    for (i = 0; i < v->n_rows; i++) {
+        int label = (int)param->data_train.labels[v->rows[i]];
+        mlp_real* output = v->outputs[i];
+
+        // Expected outputs as in back propagation: the label itself for a single output, one-hot for k classes
+        if (param->output_layer_size == 1) {
+            loss += (output[0] - label) * (output[0] - label);
+            correct += (output[0] < 0.5 ? 0 : 1) == label;
+        }
+        else {
+            int predicted_class = 1;
+            for (j = 0; j < param->output_layer_size; j++) {
+                mlp_real expected = j+1 == label ? 1 : 0;
+                loss += (output[j] - expected) * (output[j] - expected);
+                if (output[j] > output[predicted_class-1])
+                    predicted_class = j+1;
+            }
+            correct += predicted_class == label;
+        }
+    }
+
+    *accuracy = (double)correct / v->n_rows;
+    return loss / v->n_rows;
+}
+
+static void validation_destroy(validation_split* v, training_run* run) {
+    if (v->n_rows == 0)
+        return;
+
+    weight_arena_destroy(&v->best);
+
+    int i;
+    for (i = 0; i < v->n_blocks; i++)
+        inference_block_destroy(&v->blocks[i], run->n_layers);
+    mlp_free(v->blocks);
+
+    for (i = 0; i < v->n_rows; i++)
+        mlp_free(v->outputs[i]);
+    mlp_free(v->outputs);
+    mlp_free(v->features);
+}
+
+unsigned long mlp_trainer(parameters* param, int* layer_sizes) {
+    training_run run;
+    training_run_create(&run, param, layer_sizes, param->data_train.n_rows);
+
+    // Hold out part of the training data to score the model during training
+    validation_split v;
+    validation_create(&v, &run, param, layer_sizes);
+    int n_train = param->data_train.n_rows - v.n_rows;
+    int interval = param->validation_interval > 0 ? param->validation_interval : 1;
+
+    // No heap allocation is expected inside the epoch loop
+    unsigned long heap_allocations = mlp_heap_allocations();
 
     // Train the MLP
-    int training_example, j;
+    int i, scores_since_best = 0;
     for (i = 0; i < param->n_iterations_max; i++) {
         printf("Iteration %d of %d(max)\r", i+1, param->n_iterations_max);
-        // Randomly shuffle the data
-        randomly_shuffle(indices, param->train_sample_size);
+        TRACE_BEGIN("epoch", i);
+        // Randomly shuffle the data, the held-out rows stay at the end
+        shuffle(run.indices, n_train);
 
-        for (j = 0; j < param->train_sample_size; j++) {
-            training_example = indices[j];
-            // Perform forward propagation on the jth training example
-            forward_propagation(param, training_example, n_layers, layer_sizes, layer_inputs, layer_outputs);
+        train_pass(&run, param, layer_sizes, n_train);
+        TRACE_END();
 
-            // Calculate the error
+        // Score the held-out rows every interval epochs and after the last one, keeping the weights of the lowest loss
+        if (v.n_rows == 0 || ((i+1) % interval != 0 && i+1 != param->n_iterations_max))
+            continue;
 
-            // Perform back propagation and update weights
-            back_propagation(param, training_example, n_layers, layer_sizes, layer_inputs, layer_outputs);
-        }   
+        double accuracy;
+        double loss = validation_loss(&v, &run, param, layer_sizes, &accuracy);
+        printf("Iteration %d: validation loss %.6f, accuracy %.2f%%\n", i+1, loss, accuracy * 100);
+        if (v.best_loss < 0 || loss < v.best_loss) {
+            v.best_loss = loss;
+            v.best_epoch = i+1;
+            memcpy(v.best.data, param->weight.data, param->weight.size * sizeof(mlp_real));
+            scores_since_best = 0;
+        }
+        // Stop once the loss has not improved for patience scores in a row
+        else if (param->patience > 0 && ++scores_since_best >= param->patience) {
+            printf("Stopping early: no lower validation loss in %d scores\n", param->patience);
+            break;
+        }
     }
 
-    // Free the memory allocated in Heap
-    free(indices);
+    heap_allocations = mlp_heap_allocations() - heap_allocations;
+    if (heap_allocations != 0)
+        printf("Warning: %lu heap allocations inside the training loop\n", heap_allocations);
+    PERF_REPORT("Training");
+
+    // Training ends with the weights of the best score
+    param->epochs_trained = i < param->n_iterations_max ? i+1 : param->n_iterations_max;
+    param->best_epoch = v.best_epoch;
+    if (v.best_epoch > 0) {
+        memcpy(param->weight.data, v.best.data, param->weight.size * sizeof(mlp_real));
+        printf("Kept the weights of iteration %d, validation loss %.6f\n", v.best_epoch, v.best_loss);
+    }
+
+    validation_destroy(&v, &run);
+    training_run_destroy(&run);
+    return heap_allocations;
+}
+
+unsigned long mlp_trainer_stream(parameters* param, int* layer_sizes, const char* filename, size_t memory_budget) {
+    // The dataset file is read in shards that fit in the memory budget, two at a time
+    dataset_stream stream;
+    dataset_stream_open(&stream, filename, memory_budget);
+    if (stream.header.n_features != (uint32_t)layer_sizes[0]) {
+        printf("Error: %s has %u features, the input layer has %d units\n", filename, stream.header.n_features, layer_sizes[0]);
+        exit(0);
+    }
+
+    training_run run;
+    training_run_create(&run, param, layer_sizes, stream.shard_rows);
+    // The reader thread of the stream is traced too, beside those of the pool
+    TRACE_RESERVE(thread_pool_size(run.pool) + 1);
+
+
+    int* shard_order = (int*)mlp_calloc(stream.n_shards, sizeof(int));
+    int i, j;
+    for (i = 0; i < stream.n_shards; i++)
+        shard_order[i] = i;
+
+    // param->data_train points at one shard at a time
+    dataset data_train = param->data_train;
+
+    // No heap allocation is expected inside the epoch loop
+    unsigned long heap_allocations = mlp_heap_allocations();
+
+    // Train the MLP, each epoch visits the shards in a new random order and the rows
+    // of every shard in a new random order, while the next shard is read in the background
+    for (i = 0; i < param->n_iterations_max; i++) {
+        printf("Iteration %d of %d(max)\r", i+1, param->n_iterations_max);
+        TRACE_BEGIN("epoch", i);
+        shuffle(shard_order, stream.n_shards);
+        dataset_stream_start(&stream, shard_order);
+
+        const dataset* shard;
+        while ((shard = dataset_stream_next(&stream)) != NULL) {
+            TRACE_BEGIN("shard", -1);
+            param->data_train = *shard;
+            for (j = 0; j < shard->n_rows; j++)
+                run.indices[j] = j;
+            shuffle(run.indices, shard->n_rows);
+
+            train_pass(&run, param, layer_sizes, shard->n_rows);
+            TRACE_END();
+        }
+        TRACE_END();
+    }
+
+    heap_allocations = mlp_heap_allocations() - heap_allocations;
+    if (heap_allocations != 0)
+        printf("Warning: %lu heap allocations inside the training loop\n", heap_allocations);
 
-    for (i = 0; i < n_layers; i++)
-        free(layer_outputs[i]);
+    PERF_REPORT("Training");
 
-    free(layer_outputs);
+    param->data_train = data_train;
+    param->epochs_trained = param->n_iterations_max;
+    param->best_epoch = 0;
 
-    for (i = 0; i < n_layers; i++)
-        free(layer_inputs[i]);
 
-    free(layer_inputs);
+    mlp_free(shard_order);
+    training_run_destroy(&run);
+    dataset_stream_close(&stream);
+    return heap_allocations;
 }
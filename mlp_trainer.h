@@ -8,8 +8,22 @@
 #include <time.h>
 #include "forward_propagation.h"
 #include "back_propagation.h"
+#include "workspace.h"
+#include "mlp_alloc.h"
+#include "thread_pool.h"
+#include "dataset_stream.h"
+#include "mlp_perf.h"
+#include "mlp_trace.h"
+#include "mlp_inference.h"
 #include "parameters.h"
 
-void mlp_trainer(parameters* param, int*);
+// Both trainers return the number of heap allocations made inside the epoch loop, which is expected to be 0
+unsigned long mlp_trainer(parameters* param, int*);
+
+// Train on a binary dataset file larger than memory, read in shards of consecutive rows
+// The two shard buffers take at most memory_budget bytes; while one shard trains the next is
+// read by a background thread. Shards are visited in a random order every epoch and the rows
+// of a shard are shuffled within it; mini-batches do not span shards
+unsigned long mlp_trainer_stream(parameters* param, int*, const char*, size_t);
 
 #endif
\ No newline at end of file
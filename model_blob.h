@@ -0,0 +1,215 @@
+/*
+Desc: Trained model embedded in the firmware, in the binary model format of mlp_model.h
+      Network 4-4-5-5-1 (softmax, relu, tanh; sigmoid output)
+      Regenerate from files written by model_save() with: xxd -i model.bin
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#ifndef MODEL_BLOB_H
+#define MODEL_BLOB_H
+
+#include <stdint.h>
+#include "weight_arena.h"
+
+// Aligned like the weight arena so the weights are used in place
+#ifdef MLP_FLOAT
+static const uint8_t model_blob[] __attribute__((aligned(WEIGHT_ALIGNMENT))) = {
+    0x4d, 0x4c, 0x50, 0x4d, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x80, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5a, 0xf4, 0xd3, 0xce, 0xd2, 0xdd, 0xea, 0x76, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4a, 0xd2, 0x39, 0x3f, 0x02, 0x11, 0xe2, 0x3e, 0xd1, 0x91, 0x4c, 0xbf, 0x71, 0x3c, 0x1f, 0x3c,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x52, 0x2b, 0xe4, 0x3e, 0xfc, 0x55, 0x18, 0xbf, 0x76, 0x17, 0x80, 0xbe, 0x4f, 0xe8, 0x55, 0x3e,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x82, 0xae, 0x8d, 0x3e, 0xd9, 0x99, 0x42, 0x3e, 0xc0, 0x22, 0x3f, 0xbd, 0x9b, 0x55, 0x43, 0x3f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xbe, 0xbd, 0x5b, 0xbe, 0x84, 0x9b, 0xcc, 0xbe, 0x97, 0x57, 0x3e, 0xbf, 0xb2, 0x2c, 0x3c, 0x3f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xc2, 0x18, 0x51, 0x3e, 0x18, 0xeb, 0x03, 0xbf, 0xf5, 0x47, 0x24, 0x3f, 0xc8, 0x0b, 0x89, 0xbe,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x46, 0x06, 0x39, 0x3c, 0x4b, 0x3e, 0x76, 0x3e, 0x63, 0x9c, 0xe7, 0x3e, 0x9d, 0xa1, 0x18, 0x3e,
+    0xf1, 0x47, 0xf1, 0xbe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xc2, 0xa3, 0x15, 0x3f, 0x1d, 0xe4, 0x55, 0xbe, 0x6d, 0x8d, 0xb0, 0xbe, 0x65, 0x55, 0x24, 0x3e,
+    0x7b, 0xd7, 0x20, 0x3d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x94, 0xda, 0x2f, 0x3f, 0x0b, 0x0e, 0x8f, 0x3d, 0xd2, 0xdf, 0xab, 0xbe, 0xb5, 0x4e, 0x34, 0x3f,
+    0x3f, 0xa7, 0x3c, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x33, 0xe0, 0x34, 0xbf, 0x39, 0x0d, 0x35, 0xbf, 0x20, 0xb4, 0x2e, 0xbe, 0xa7, 0x3f, 0xa3, 0x3e,
+    0xf5, 0x9f, 0xc5, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x84, 0x0c, 0x4c, 0xbf, 0x4b, 0x58, 0x0b, 0xbf, 0x46, 0x3f, 0xaa, 0x3e, 0x06, 0xd8, 0x47, 0xbe,
+    0x6b, 0x80, 0x02, 0xbe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xfe, 0x9b, 0xcf, 0x3e, 0x62, 0x9e, 0x8d, 0xbe, 0xcc, 0x5f, 0x3d, 0xbf, 0xc9, 0xe8, 0x34, 0x3f,
+    0x57, 0x3e, 0xdb, 0xbe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xff, 0x76, 0x39, 0xbe, 0xb9, 0x6d, 0xbf, 0xbd, 0x9d, 0x13, 0x13, 0x3f, 0xd5, 0xcc, 0x06, 0xbf,
+    0x85, 0x06, 0x3a, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6d, 0xab, 0x25, 0xbf, 0xe2, 0x22, 0x3f, 0xbf, 0x52, 0xd4, 0x19, 0xbe, 0xb3, 0x79, 0x4c, 0xbe,
+    0xce, 0x8a, 0x38, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x42, 0x60, 0x29, 0x3f, 0x17, 0x2c, 0xa5, 0xbe, 0x6a, 0x32, 0x07, 0xbf, 0x4f, 0xe5, 0xdc, 0xbe,
+    0x1e, 0xa8, 0xdb, 0xbe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xba, 0xbe, 0xe7, 0xbe, 0x74, 0x7d, 0xa7, 0xbe, 0x96, 0x95, 0xa6, 0xbe, 0x73, 0xf5, 0x23, 0x3e,
+    0xca, 0xfc, 0x3f, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xe0, 0xd8, 0x3b, 0xbf, 0xd0, 0xd5, 0x36, 0x3e, 0xe0, 0x80, 0x0a, 0xbf, 0x05, 0x69, 0xb6, 0x3e,
+    0xc7, 0x9b, 0x44, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xe8, 0xbc, 0xe6, 0x3d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x7c, 0xd2, 0x09, 0xbd, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5e, 0xba, 0x89, 0xbe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0xee, 0x3d, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x2a, 0x36, 0x36, 0xbe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0b, 0x9c, 0xcc, 0x3d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+#else
+static const uint8_t model_blob[] __attribute__((aligned(WEIGHT_ALIGNMENT))) = {
+    0x4d, 0x4c, 0x50, 0x4d, 0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x80, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x9f, 0xf6, 0x58, 0x83, 0x3d, 0x89, 0xd7, 0xa3, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0a, 0xf4, 0x89, 0x3c, 0x49, 0x3a, 0xe7, 0x3f, 0x0d, 0x6d, 0x00, 0x36, 0x20, 0x42, 0xdc, 0x3f,
+    0xa7, 0x79, 0xc7, 0x29, 0x3a, 0x92, 0xe9, 0xbf, 0xed, 0xd6, 0x32, 0x19, 0x8e, 0xe7, 0x83, 0x3f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xb8, 0x3e, 0xac, 0x37, 0x6a, 0x85, 0xdc, 0x3f, 0x8c, 0xf4, 0xa2, 0x76, 0xbf, 0x0a, 0xe3, 0xbf,
+    0xcd, 0x57, 0xc9, 0xc7, 0xee, 0x02, 0xd0, 0xbf, 0xe3, 0x51, 0x2a, 0xe1, 0x09, 0xbd, 0xca, 0x3f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8a, 0x5b, 0x05, 0x31, 0xd0, 0xb5, 0xd1, 0x3f, 0x88, 0x46, 0x77, 0x10, 0x3b, 0x53, 0xc8, 0x3f,
+    0x1a, 0x14, 0xcd, 0x03, 0x58, 0xe4, 0xa7, 0xbf, 0x09, 0xf9, 0xa0, 0x67, 0xb3, 0x6a, 0xe8, 0x3f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x31, 0x0a, 0x82, 0xc7, 0xb7, 0x77, 0xcb, 0xbf, 0xcc, 0x96, 0xac, 0x8a, 0x70, 0x93, 0xd9, 0xbf,
+    0xb9, 0x50, 0xf9, 0xd7, 0xf2, 0xca, 0xe7, 0xbf, 0x95, 0x44, 0xf6, 0x41, 0x96, 0x85, 0xe7, 0x3f,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8e, 0xac, 0xfc, 0x32, 0x18, 0x23, 0xca, 0x3f, 0xaa, 0xd7, 0x2d, 0x02, 0x63, 0x7d, 0xe0, 0xbf,
+    0x8a, 0xe9, 0x42, 0xac, 0xfe, 0x88, 0xe4, 0x3f, 0xf8, 0xe2, 0x8b, 0xf6, 0x78, 0x21, 0xd1, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x81, 0xcb, 0x63, 0xcd, 0xc8, 0x20, 0x87, 0x3f, 0x6f, 0x46, 0xcd, 0x57, 0xc9, 0xc7, 0xce, 0x3f,
+    0xfa, 0xb8, 0x36, 0x54, 0x8c, 0xf3, 0xdc, 0x3f, 0x0f, 0x43, 0xab, 0x93, 0x33, 0x14, 0xc3, 0x3f,
+    0x84, 0x2c, 0x0b, 0x26, 0xfe, 0x28, 0xde, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xf8, 0xfc, 0x30, 0x42, 0x78, 0xb4, 0xe2, 0x3f, 0x34, 0x4c, 0x6d, 0xa9, 0x83, 0xbc, 0xca, 0xbf,
+    0xb3, 0x97, 0x6d, 0xa7, 0xad, 0x11, 0xd6, 0xbf, 0xc0, 0x5f, 0xcc, 0x96, 0xac, 0x8a, 0xc4, 0x3f,
+    0x14, 0x04, 0x8f, 0x6f, 0xef, 0x1a, 0xa4, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x47, 0x91, 0xb5, 0x86, 0x52, 0xfb, 0xe5, 0x3f, 0x08, 0xc8, 0x97, 0x50, 0xc1, 0xe1, 0xb1, 0x3f,
+    0x62, 0xd8, 0x61, 0x4c, 0xfa, 0x7b, 0xd5, 0xbf, 0xb0, 0x1e, 0xf7, 0xad, 0xd6, 0x89, 0xe6, 0x3f,
+    0xb3, 0x42, 0x91, 0xee, 0xe7, 0x94, 0xe7, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xe5, 0xd3, 0x63, 0x5b, 0x06, 0x9c, 0xe6, 0xbf, 0xec, 0xdc, 0xb4, 0x19, 0xa7, 0xa1, 0xe6, 0xbf,
+    0x28, 0x9e, 0xb3, 0x05, 0x84, 0xd6, 0xc5, 0xbf, 0x47, 0x8f, 0xdf, 0xdb, 0xf4, 0x67, 0xd4, 0x3f,
+    0xd1, 0xaf, 0xad, 0x9f, 0xfe, 0xb3, 0xd8, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xf8, 0x1c, 0x58, 0x8e, 0x90, 0x81, 0xe9, 0xbf, 0xae, 0x10, 0x56, 0x63, 0x09, 0x6b, 0xe1, 0xbf,
+    0xc4, 0x93, 0xdd, 0xcc, 0xe8, 0x47, 0xd5, 0x3f, 0xd0, 0x61, 0xbe, 0xbc, 0x00, 0xfb, 0xc8, 0xbf,
+    0x11, 0x54, 0x8d, 0x5e, 0x0d, 0x50, 0xc0, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x71, 0x00, 0xfd, 0xbe, 0x7f, 0xf3, 0xd9, 0x3f, 0xaf, 0xcd, 0xc6, 0x4a, 0xcc, 0xb3, 0xd1, 0xbf,
+    0xda, 0x3c, 0x0e, 0x83, 0xf9, 0xab, 0xe7, 0xbf, 0x88, 0xbb, 0x7a, 0x15, 0x19, 0x9d, 0xe6, 0x3f,
+    0x80, 0x7d, 0x74, 0xea, 0xca, 0x67, 0xdb, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4c, 0xc4, 0x5b, 0xe7, 0xdf, 0x2e, 0xc7, 0xbf, 0xba, 0xd9, 0x1f, 0x28, 0xb7, 0xed, 0xb7, 0xbf,
+    0x95, 0xd3, 0x9e, 0x92, 0x73, 0x62, 0xe2, 0x3f, 0xa5, 0x13, 0x09, 0xa6, 0x9a, 0xd9, 0xe0, 0xbf,
+    0xd7, 0xde, 0xa7, 0xaa, 0xd0, 0x40, 0xe7, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x5d, 0x8b, 0x16, 0xa0, 0x6d, 0xb5, 0xe4, 0xbf, 0x48, 0xfc, 0x8a, 0x35, 0x5c, 0xe4, 0xe7, 0xbf,
+    0xcb, 0x82, 0x89, 0x3f, 0x8a, 0x3a, 0xc3, 0xbf, 0xf6, 0x98, 0x48, 0x69, 0x36, 0x8f, 0xc9, 0xbf,
+    0x25, 0x74, 0x97, 0xc4, 0x59, 0x11, 0xc7, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x79, 0xe9, 0x26, 0x31, 0x08, 0x2c, 0xe5, 0x3f, 0xc3, 0xf2, 0xe7, 0xdb, 0x82, 0xa5, 0xd4, 0xbf,
+    0x56, 0xf5, 0xf2, 0x3b, 0x4d, 0xe6, 0xe0, 0xbf, 0xd3, 0x32, 0x52, 0xef, 0xa9, 0x9c, 0xdb, 0xbf,
+    0xe0, 0x64, 0x1b, 0xb8, 0x03, 0x75, 0xdb, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x86, 0x57, 0x92, 0x3c, 0xd7, 0xf7, 0xdc, 0xbf, 0x0c, 0xaf, 0x24, 0x79, 0xae, 0xef, 0xd4, 0xbf,
+    0xc2, 0x4c, 0xdb, 0xbf, 0xb2, 0xd2, 0xd4, 0xbf, 0xb3, 0x7d, 0xc8, 0x5b, 0xae, 0x7e, 0xc4, 0x3f,
+    0xa6, 0x47, 0x53, 0x3d, 0x99, 0xff, 0xe7, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xf8, 0xc6, 0x10, 0x00, 0x1c, 0x7b, 0xe7, 0xbf, 0xd0, 0xb3, 0x59, 0xf5, 0xb9, 0xda, 0xc6, 0x3f,
+    0xb0, 0x00, 0xa6, 0x0c, 0x1c, 0x50, 0xe1, 0xbf, 0x5a, 0xf0, 0xa2, 0xaf, 0x20, 0xcd, 0xd6, 0x3f,
+    0x27, 0x67, 0x28, 0xee, 0x78, 0x93, 0xe8, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0f, 0x62, 0x67, 0x0a, 0x9d, 0xd7, 0xbc, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x4e, 0xd0, 0x26, 0x87, 0x4f, 0x3a, 0xa1, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x9e, 0xef, 0xa7, 0xc6, 0x4b, 0x37, 0xd1, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xe2, 0x21, 0x8c, 0x9f, 0xc6, 0xbd, 0xc7, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x6b, 0x0b, 0xcf, 0x4b, 0xc5, 0xc6, 0xc6, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x82, 0x37, 0xa4, 0x51, 0x81, 0x93, 0xb9, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/*
+Desc: Optimizers of the weights (SGD, momentum, Nesterov, RMSProp, Adam) with their state beside the weights
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "optimizer.h"
+
+void optimizer_create(optimizer_state* state, int optimizer, mlp_real momentum, mlp_real decay, int n_layers, int* layer_sizes) {
+    if (optimizer < 0 || optimizer >= OPTIMIZERS) {
+        printf("Error: Invalid optimizer %d\n", optimizer);
+        exit(0);
+    }
+
+    memset(state, 0, sizeof(optimizer_state));
+    state->optimizer = optimizer;
+    state->momentum = momentum > 0 ? momentum : OPTIMIZER_MOMENTUM_DEFAULT;
+    state->decay = decay > 0 ? decay : (optimizer == OPTIMIZER_ADAM ? ADAM_DECAY_DEFAULT : RMSPROP_DECAY_DEFAULT);
+    state->step = 0;
+
+    // Only the averages the optimizer uses are created, zeroed like the padding of the weights
+    if (optimizer == OPTIMIZER_MOMENTUM || optimizer == OPTIMIZER_NESTEROV || optimizer == OPTIMIZER_ADAM)
+        weight_arena_create(&state->velocity, n_layers, layer_sizes);
+    if (optimizer == OPTIMIZER_RMSPROP || optimizer == OPTIMIZER_ADAM)
+        weight_arena_create(&state->square, n_layers, layer_sizes);
+
+    state->update = simd->update[optimizer];
+}
+
+void optimizer_destroy(optimizer_state* state) {
+    if (state->velocity.data != NULL)
+        weight_arena_destroy(&state->velocity);
+    if (state->square.data != NULL)
+        weight_arena_destroy(&state->square);
+}
+
+void optimizer_step(optimizer_state* state, mlp_real learning_rate, int batch_size, update_step* step) {
+    // Hogwild threads share the state and take steps concurrently, each one uses the count its own increment returned
+    long count = __atomic_add_fetch(&state->step, 1, __ATOMIC_RELAXED);
+
+    step->rate = learning_rate / batch_size;
+    step->scale = (mlp_real)1 / batch_size;
+    step->step = learning_rate;
+    step->momentum = state->momentum;
+    step->decay = state->decay;
+    step->epsilon = OPTIMIZER_EPSILON;
+
+    // Both averages of Adam start at 0 and are biased towards it over the first steps, the step size makes up for it
+    if (state->optimizer == OPTIMIZER_ADAM)
+        step->step = learning_rate * sqrt(1 - pow(state->decay, count)) / (1 - pow(state->momentum, count));
+}
+
+void optimizer_update(const optimizer_state* state, const update_step* step, weight_arena* weight, const weight_arena* gradient, size_t start, size_t end) {
+    mlp_real* velocity = state->velocity.data != NULL ? state->velocity.data + start : NULL;
+    mlp_real* square = state->square.data != NULL ? state->square.data + start : NULL;
+    state->update(end - start, weight->data + start, gradient->data + start, velocity, square, step);
+}
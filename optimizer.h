@@ -0,0 +1,43 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mlp_alloc.h"
+#include "weight_arena.h"
+#include "simd_kernels.h"
+
+// Hyperparameters used when parameters.momentum or parameters.decay is left at 0
+#define OPTIMIZER_MOMENTUM_DEFAULT 0.9
+#define RMSPROP_DECAY_DEFAULT 0.9
+#define ADAM_DECAY_DEFAULT 0.999
+
+// Added to the root of the squared-gradient average so weights with no gradient yet do not divide by 0
+#define OPTIMIZER_EPSILON 1e-8
+
+// State an optimizer keeps beside the weights, laid out like them so one update covers the whole arena
+typedef struct {
+    int optimizer;         // OPTIMIZER_SGD, OPTIMIZER_MOMENTUM, OPTIMIZER_NESTEROV, OPTIMIZER_RMSPROP or OPTIMIZER_ADAM
+    mlp_real momentum;
+    mlp_real decay;
+    long step;             // Updates made so far, for the bias correction of Adam
+    weight_arena velocity; // Velocity (momentum, Nesterov) or gradient average (Adam), not created otherwise
+    weight_arena square;   // Average of the squared gradient (RMSProp, Adam), not created otherwise
+    update_kernel update;  // Kernel of the optimizer selected by simd_init(), which is called first
+} optimizer_state;
+
+// Create the state of an optimizer for the weights of the network, every average starting at 0
+// Arguments: optimizer, momentum, decay (0 for the defaults above), number of layers and layer sizes
+void optimizer_create(optimizer_state*, int, mlp_real, mlp_real, int, int*);
+void optimizer_destroy(optimizer_state*);
+
+// Coefficients of the next update, from the learning rate and the number of samples the gradient is summed over
+// Counts one step, so it is called once per update even when threads share the update out
+void optimizer_step(optimizer_state*, mlp_real, int, update_step*);
+
+// Update elements [start, end) of the weight arena from the gradient arena in one fused pass
+void optimizer_update(const optimizer_state*, const update_step*, weight_arena*, const weight_arena*, size_t, size_t);
+
+#endif
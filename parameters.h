@@ -1,21 +1,44 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
 
+#include "dataset.h"
+#include "weight_arena.h"
+#include "layer_plan.h"
+#include "optimizer.h"
+
+// Parallel training modes
+#define TRAIN_SERIAL 0  // One thread
+#define TRAIN_HOGWILD 1 // Threads share the weights and update them without locks
+#define TRAIN_DATA_PARALLEL 2 // Threads compute the gradients of fixed shards of a batch, reproducible for any thread count
+
 typedef struct {
     int n_hidden;
     int* hidden_layers_size;
     int* hidden_activation_functions;
-    double learning_rate;
+    mlp_real learning_rate;
     int n_iterations_max;
-    int momentum;
+    unsigned int seed; // Seed of the weight initialization and of the shuffles (0 for one taken from the clock)
+    mlp_real validation_fraction; // Fraction of data_train held out by mlp_trainer to score the model during training (0 for none)
+    int validation_interval; // Epochs between two scores of the held-out rows (0 for 1)
+    int patience; // Scores without a lower validation loss after which training stops (0 to train n_iterations_max epochs)
+    int epochs_trained; // Set by the trainers: epochs run, fewer than n_iterations_max after an early stop
+    int best_epoch; // Set by mlp_trainer: epoch whose weights were kept, the lowest validation loss (0 without a validation split)
+
+    int optimizer; // Weight update rule (OPTIMIZER_SGD, OPTIMIZER_MOMENTUM, OPTIMIZER_NESTEROV, OPTIMIZER_RMSPROP, OPTIMIZER_ADAM)
+    mlp_real momentum; // Momentum of OPTIMIZER_MOMENTUM and OPTIMIZER_NESTEROV, decay of the gradient average of OPTIMIZER_ADAM (0 for 0.9)
+    mlp_real decay; // Decay of the squared-gradient average of OPTIMIZER_RMSPROP and OPTIMIZER_ADAM (0 for 0.9 and 0.999)
+    int parallel_mode; // Parallel training mode (TRAIN_SERIAL, TRAIN_HOGWILD, TRAIN_DATA_PARALLEL)
+    int n_threads; // Number of training threads
+    int gradient_shards; // Number of shards each batch is split into in TRAIN_DATA_PARALLEL
+    int batch_size; // Number of training samples per weight update (1 updates after every sample)
     int output_layer_size;
     int output_activation_function;
-    double** data_train;
-    double** data_test;
-    int feature_size;
-    int train_sample_size;
-    int test_sample_size;
-    double*** weight;
+    int activation_accuracy; // Accuracy tier of sigmoid, tanh and softmax (ACTIVATION_EXACT, ACTIVATION_FAST, ACTIVATION_FASTEST)
+    dataset data_train; // Flat rows of input features and a column of labels
+    dataset data_test;
+    weight_arena weight;
+    optimizer_state moments; // State of the optimizer beside the weights, created by the trainer
+    layer_plan plan; // Kernels of every layer, created with layer_plan_create once the activations are set
 } parameters;
 
 #endif
\ No newline at end of file
@@ -6,8 +6,20 @@ GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
 */
 
 #include "read_csv.h"
+#include "thread_pool.h"
+#include <float.h>
+#include <limits.h>
+#include <stdint.h>
 
-void read_csv(char* filename, int rows, int cols, double** data) {
+// Parallel parsing maps the file, threads imply POSIX
+#ifdef MLP_THREADS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+void read_csv(char* filename, int rows, int cols, mlp_real** data) {
     // Open file and perform sanity check
     FILE* fp = fopen(filename, "r");
     if (NULL == fp) {
@@ -15,6 +27,8 @@ void read_csv(char* filename, int rows, int cols, double** data) {
         exit(0);
     }
 
+    TRACE_BEGIN("read_csv", rows);
+
     // Create memory to read a line/row from the file
     char* line = (char*)malloc(MAX_LINE_SIZE * sizeof(char));
 
@@ -33,4 +47,537 @@ void read_csv(char* filename, int rows, int cols, double** data) {
 
     // Close the file
     fclose(fp);
+
+    TRACE_END();
+}
+
+// Exact powers of ten, the largest exactly representable in a double is 1e22
+static const double csv_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Values parsed so far, all rows in one growing block
+typedef struct {
+    mlp_real* values;
+    size_t n_values;
+    size_t capacity;
+    long rows;
+    int cols; // Fields per line, 0 until the first line is read
+    long n_errors;
+    const char* filename;
+    char (*messages)[CSV_MESSAGE_SIZE]; // Where errors are kept to be printed later, NULL to print them at once
+} csv_table;
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+#ifdef __SIZEOF_INT128__
+// Powers of five below 2^64, 10^k = 5^k * 2^k
+static const uint64_t csv_pow5[] = {
+    1ULL, 5ULL, 25ULL, 125ULL, 625ULL, 3125ULL, 15625ULL, 78125ULL, 390625ULL, 1953125ULL,
+    9765625ULL, 48828125ULL, 244140625ULL, 1220703125ULL, 6103515625ULL, 30517578125ULL,
+    152587890625ULL, 762939453125ULL, 3814697265625ULL, 19073486328125ULL, 95367431640625ULL,
+    476837158203125ULL, 2384185791015625ULL, 11920928955078125ULL, 59604644775390625ULL,
+    298023223876953125ULL, 1490116119384765625ULL, 7450580596923828125ULL
+};
+#define CSV_MAX_POW5 27
+
+static int bit_length(unsigned __int128 x) {
+    uint64_t high = (uint64_t)(x >> 64);
+    return high ? 128 - __builtin_clzll(high) : 64 - __builtin_clzll((uint64_t)x);
+}
+
+// x * 2^exp2 rounded to the nearest double, ties to even
+// sticky tells that the exact value is slightly above x (nonzero bits were dropped below it)
+static double round_to_double(unsigned __int128 x, int sticky, int exp2) {
+    int drop = bit_length(x) - 53;
+    if (drop > 0) {
+        unsigned __int128 half = (unsigned __int128)1 << (drop - 1);
+        unsigned __int128 rest = x & ((half << 1) - 1);
+        x >>= drop;
+        exp2 += drop;
+        if (rest > half || (rest == half && (sticky || (x & 1)))) {
+            x++;
+            if (x >> 53) {
+                x >>= 1;
+                exp2++;
+            }
+        }
+    }
+    return ldexp((double)(uint64_t)x, exp2);
+}
+
+// mantissa * 10^exponent correctly rounded with 128-bit integer arithmetic, |exponent| <= CSV_MAX_POW5
+// A division keeps at least 64 quotient bits and its remainder as the sticky bit
+static double exact_decimal(uint64_t mantissa, int exponent) {
+    if (exponent >= 0)
+        return round_to_double((unsigned __int128)mantissa * csv_pow5[exponent], 0, exponent);
+
+    int shift = 127 - bit_length(mantissa);
+    unsigned __int128 numerator = (unsigned __int128)mantissa << shift;
+    unsigned __int128 quotient = numerator / csv_pow5[-exponent];
+    int sticky = numerator % csv_pow5[-exponent] != 0;
+    return round_to_double(quotient, sticky, exponent - shift);
+}
+#endif
+
+// Decimal number starting at s, as digits with an optional fraction and exponent
+// A significand of at most 19 digits is exact in 64 bits. When it also fits in 53 bits and the
+// power of ten is at most 22, both are exact doubles and one multiplication or division rounds
+// correctly (Clinger's fast path); otherwise, for powers of ten up to 27, the product is rounded
+// exactly with 128-bit integers
+// Returns the end of the number, or NULL when neither path applies
+static const char* csv_fast_number(const char* s, const char* end, double* value) {
+    const char* p = s;
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    // Significand, counting the digits after the first nonzero one
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0, n_digits = 0;
+    for (; p < end && (unsigned)(*p - '0') < 10; p++, n_digits++) {
+        mantissa = mantissa * 10 + (unsigned)(*p - '0');
+        digits += mantissa != 0;
+        if (digits > 19)
+            return NULL;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && (unsigned)(*p - '0') < 10; p++, n_digits++, exponent--) {
+            mantissa = mantissa * 10 + (unsigned)(*p - '0');
+            digits += mantissa != 0;
+            if (digits > 19)
+                return NULL;
+        }
+    }
+    if (n_digits == 0)
+        return NULL;
+
+    // Exponent
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        int exp_negative = 0, exp_value = 0;
+        p++;
+        if (p < end && (*p == '-' || *p == '+'))
+            exp_negative = *p++ == '-';
+        if (p == end || (unsigned)(*p - '0') >= 10)
+            return NULL;
+        for (; p < end && (unsigned)(*p - '0') < 10; p++)
+            if (exp_value < 10000)
+                exp_value = exp_value * 10 + (*p - '0');
+        exponent += exp_negative ? -exp_value : exp_value;
+    }
+
+    double v;
+    if (mantissa == 0)
+        v = 0;
+#if FLT_EVAL_METHOD == 0
+    // Extended precision intermediates would round twice
+    else if (mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22)
+        v = exponent < 0 ? (double)mantissa / csv_pow10[-exponent] : (double)mantissa * csv_pow10[exponent];
+#endif
+#ifdef __SIZEOF_INT128__
+    else if (exponent >= -CSV_MAX_POW5 && exponent <= CSV_MAX_POW5)
+        v = exact_decimal(mantissa, exponent);
+#endif
+    else
+        return NULL;
+
+    *value = negative ? -v : v;
+    return p;
+}
+
+int csv_parse_number(const char* begin, const char* end, double* value) {
+    // Trim the surrounding spaces
+    while (begin < end && is_space(*begin))
+        begin++;
+    while (end > begin && is_space(end[-1]))
+        end--;
+    if (begin == end)
+        return 0;
+
+    if (csv_fast_number(begin, end, value) == end)
+        return 1;
+
+    // Everything else, long significands, large exponents, inf and nan, goes through strtod
+    char small[64];
+    size_t length = end - begin;
+    char* text = length < sizeof(small) ? small : (char*)malloc(length + 1);
+    memcpy(text, begin, length);
+    text[length] = '\0';
+
+    char* stop;
+    *value = strtod(text, &stop);
+    int ok = stop == text + length;
+
+    if (text != small)
+        free(text);
+
+    return ok;
+}
+
+static void csv_error(csv_table* t, long line_number, const char* reason, int found) {
+    if (t->n_errors < CSV_MAX_ERRORS) {
+        char message[CSV_MESSAGE_SIZE];
+        int length = snprintf(message, sizeof(message), "Error: %s line %ld: ", t->filename, line_number);
+        if (length >= 0 && length < (int)sizeof(message))
+            snprintf(message + length, sizeof(message) - length, reason, found, t->cols);
+
+        if (t->messages)
+            strcpy(t->messages[t->n_errors], message);
+        else
+            printf("%s\n", message);
+    }
+    t->n_errors++;
+}
+
+static void csv_grow(csv_table* t) {
+    t->capacity = 2 * t->capacity + (t->cols > 0 ? t->cols : 64);
+    t->values = (mlp_real*)realloc(t->values, t->capacity * sizeof(mlp_real));
+    if (NULL == t->values) {
+        printf("Error: Out of memory reading %s\n", t->filename);
+        exit(0);
+    }
+}
+
+// A line of spaces only, without its line break
+static int csv_blank_line(const char* line, const char* end) {
+    if (end > line && end[-1] == '\r')
+        end--;
+    while (line < end && is_space(*line))
+        line++;
+    return line == end;
+}
+
+// Parse one line without its line break into the next row of the table
+static void csv_parse_line(csv_table* t, const char* line, const char* end, long line_number) {
+    // Blank lines are skipped
+    if (csv_blank_line(line, end))
+        return;
+    if (end[-1] == '\r')
+        end--;
+
+    // Room for the whole row once the number of columns is known, extra fields are only counted
+    if (t->cols > 0 && t->n_values + t->cols > t->capacity)
+        csv_grow(t);
+
+    size_t row_start = t->n_values;
+    int j = 0;
+    const char* p;
+    for (p = line; ; p++) {
+        if (t->cols == 0 && t->n_values == t->capacity)
+            csv_grow(t);
+
+        while (p < end && is_space(*p))
+            p++;
+
+        // Most fields are plain decimals that end right at the delimiter
+        double value;
+        const char* stop = csv_fast_number(p, end, &value);
+        if (stop) {
+            while (stop < end && is_space(*stop))
+                stop++;
+        }
+        if (NULL == stop || (stop < end && *stop != ',')) {
+            stop = (const char*)memchr(p, ',', end - p);
+            if (NULL == stop)
+                stop = end;
+            if (!csv_parse_number(p, stop, &value)) {
+                t->n_values = row_start;
+                csv_error(t, line_number, stop == p ? "empty field %d" : "field %d is not a number", j + 1);
+                return;
+            }
+        }
+
+        if (t->cols == 0 || j < t->cols)
+            t->values[t->n_values++] = (mlp_real)value;
+        j++;
+        p = stop;
+        if (p == end)
+            break;
+    }
+
+    if (t->cols == 0)
+        t->cols = j;
+    else if (j != t->cols) {
+        t->n_values = row_start;
+        csv_error(t, line_number, "%d fields, expected %d", j);
+        return;
+    }
+
+    if (t->rows == INT_MAX) {
+        printf("Error: %s has more than %d rows\n", t->filename, INT_MAX);
+        exit(0);
+    }
+    t->rows++;
+}
+
+mlp_real** read_csv_auto(char* filename, int* rows, int* cols) {
+    // Open file and perform sanity check
+    FILE* fp = fopen(filename, "rb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+
+    csv_table t = { NULL, 0, 0, 0, 0, 0, filename, NULL };
+    TRACE_BEGIN("read_csv_auto", -1);
+
+    // Read the file in large blocks and parse every complete line of a block,
+    // the partial last line is moved to the front and completed by the next block
+    size_t size = CSV_BLOCK_SIZE, filled = 0;
+    char* buffer = (char*)malloc(size);
+    long line_number = 1;
+    for (;;) {
+        size_t n = fread(buffer + filled, 1, size - filled, fp);
+        if (ferror(fp)) {
+            printf("Error reading %s\n", filename);
+            exit(0);
+        }
+        filled += n;
+
+        char* p = buffer;
+        char* end = buffer + filled;
+        char* newline;
+        while ((newline = (char*)memchr(p, '\n', end - p))) {
+            csv_parse_line(&t, p, newline, line_number++);
+            p = newline + 1;
+        }
+
+        // End of file, the last line may not end with a line break
+        if (n == 0) {
+            if (p < end)
+                csv_parse_line(&t, p, end, line_number);
+            break;
+        }
+
+        filled = end - p;
+        memmove(buffer, p, filled);
+
+        // A line longer than the buffer, grow it
+        if (filled == size) {
+            size *= 2;
+            buffer = (char*)realloc(buffer, size);
+            if (NULL == buffer) {
+                printf("Error: Out of memory reading %s\n", filename);
+                exit(0);
+            }
+        }
+    }
+
+    free(buffer);
+    fclose(fp);
+
+    if (t.n_errors > 0) {
+        printf("Error: %ld malformed lines in %s\n", t.n_errors, filename);
+        exit(0);
+    }
+    if (t.rows == 0) {
+        printf("Error: %s contains no data\n", filename);
+        exit(0);
+    }
+
+    // Row pointers into the block of values
+    mlp_real** data = (mlp_real**)malloc(t.rows * sizeof(mlp_real*));
+    data[0] = (mlp_real*)realloc(t.values, t.n_values * sizeof(mlp_real));
+    long i;
+    for (i = 1; i < t.rows; i++)
+        data[i] = data[0] + (size_t)i * t.cols;
+
+    *rows = (int)t.rows;
+    *cols = t.cols;
+    TRACE_END();
+    return data;
+}
+
+void free_csv(mlp_real** data) {
+    if (NULL == data)
+        return;
+
+    free(data[0]);
+    free(data);
+}
+
+#ifdef MLP_THREADS
+// One byte range of the file, starting at the beginning of a line, parsed by one thread
+typedef struct {
+    const char* begin;
+    const char* end;
+    long first_line; // Line number of the first line of the range
+    long n_lines; // Line breaks in the range
+    long first_row; // Row of the first non-blank line of the range
+    long n_rows; // Non-blank lines of the range
+    csv_table table;
+} csv_range;
+
+typedef struct {
+    csv_range* ranges;
+    mlp_real* values;
+    int cols;
+} csv_task;
+
+// First pass: line breaks and non-blank lines of every range
+static void csv_count_worker(void* arg, int thread_id, int n_threads) {
+    (void)n_threads;
+    csv_range* r = &((csv_task*)arg)->ranges[thread_id];
+    TRACE_BEGIN("csv count", thread_id);
+
+    const char* p = r->begin;
+    while (p < r->end) {
+        const char* newline = (const char*)memchr(p, '\n', r->end - p);
+        const char* line_end = newline ? newline : r->end;
+        r->n_rows += !csv_blank_line(p, line_end);
+        if (NULL == newline)
+            break;
+        r->n_lines++;
+        p = newline + 1;
+    }
+    TRACE_END();
+}
+
+// Second pass: every range is parsed into its own rows of the preallocated block
+static void csv_parse_worker(void* arg, int thread_id, int n_threads) {
+    (void)n_threads;
+    csv_task* task = (csv_task*)arg;
+    csv_range* r = &task->ranges[thread_id];
+    csv_table* t = &r->table;
+
+    t->values = task->values + (size_t)r->first_row * task->cols;
+    t->capacity = (size_t)r->n_rows * task->cols;
+    t->cols = task->cols;
+    TRACE_BEGIN("csv parse", thread_id);
+
+    const char* p = r->begin;
+    long line_number = r->first_line;
+    while (p < r->end) {
+        const char* newline = (const char*)memchr(p, '\n', r->end - p);
+        csv_parse_line(t, p, newline ? newline : r->end, line_number++);
+        if (NULL == newline)
+            break;
+        p = newline + 1;
+    }
+    TRACE_END();
+}
+#endif
+
+mlp_real** read_csv_parallel(char* filename, int* rows, int* cols, int n_threads) {
+#ifdef MLP_THREADS
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    size_t size = (size_t)st.st_size;
+    if (n_threads <= 1 || size < CSV_BLOCK_SIZE) {
+        close(fd);
+        return read_csv_auto(filename, rows, cols);
+    }
+
+    // The ranges are read through a mapping of the whole file
+    TRACE_BEGIN("read_csv_parallel", n_threads);
+    const char* file = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ((void*)file == MAP_FAILED) {
+        printf("Error: Cannot map %s\n", filename);
+        exit(0);
+    }
+    madvise((void*)file, size, MADV_SEQUENTIAL);
+    const char* file_end = file + size;
+
+    // The number of columns comes from the first line that parses, read serially like read_csv_auto does
+    csv_table first = { NULL, 0, 0, 0, 0, 0, filename, NULL };
+    const char* p = file;
+    long line_number = 1;
+    while (p < file_end && first.rows == 0) {
+        const char* newline = (const char*)memchr(p, '\n', file_end - p);
+        csv_parse_line(&first, p, newline ? newline : file_end, line_number);
+        p = newline ? newline + 1 : file_end;
+        line_number += newline != NULL;
+    }
+
+    // The rest is split into one byte range per thread, each moved forward to the start of a line
+    thread_pool* pool = thread_pool_create(n_threads);
+    n_threads = thread_pool_size(pool);
+    csv_range* ranges = (csv_range*)calloc(n_threads, sizeof(csv_range));
+    int k;
+    for (k = 0; k < n_threads; k++) {
+        ranges[k].begin = k == 0 ? p : ranges[k-1].end;
+        ranges[k].end = file_end;
+        if (k < n_threads - 1) {
+            const char* split = p + (size_t)(file_end - p) / n_threads * (k + 1);
+            if (split < ranges[k].begin)
+                split = ranges[k].begin;
+            const char* newline = (const char*)memchr(split, '\n', file_end - split);
+            ranges[k].end = newline ? newline + 1 : file_end;
+        }
+        csv_table t = { NULL, 0, 0, 0, 0, 0, filename, NULL };
+        ranges[k].table = t;
+        ranges[k].table.messages = (char (*)[CSV_MESSAGE_SIZE])malloc(CSV_MAX_ERRORS * CSV_MESSAGE_SIZE);
+    }
+
+    csv_task task = { ranges, NULL, first.cols };
+    thread_pool_run(pool, csv_count_worker, &task);
+
+    // Line numbers and rows of the ranges follow from the counts
+    long total_rows = first.rows;
+    for (k = 0; k < n_threads; k++) {
+        ranges[k].first_line = k == 0 ? line_number : ranges[k-1].first_line + ranges[k-1].n_lines;
+        ranges[k].first_row = total_rows;
+        total_rows += ranges[k].n_rows;
+    }
+    if (total_rows > INT_MAX) {
+        printf("Error: %s has more than %d rows\n", filename, INT_MAX);
+        exit(0);
+    }
+
+    // Every thread parses its range into its rows of one block
+    if (total_rows > 0) {
+        task.values = (mlp_real*)malloc((size_t)total_rows * first.cols * sizeof(mlp_real));
+        if (NULL == task.values) {
+            printf("Error: Out of memory reading %s\n", filename);
+            exit(0);
+        }
+        memcpy(task.values, first.values, first.n_values * sizeof(mlp_real));
+        thread_pool_run(pool, csv_parse_worker, &task);
+    }
+    thread_pool_destroy(pool);
+    munmap((void*)file, size);
+    free(first.values);
+
+    // The first errors of the file in line order, as read_csv_auto prints them
+    long n_errors = first.n_errors;
+    for (k = 0; k < n_threads; k++) {
+        int e;
+        for (e = 0; e < ranges[k].table.n_errors && n_errors + e < CSV_MAX_ERRORS; e++)
+            printf("%s\n", ranges[k].table.messages[e]);
+        n_errors += ranges[k].table.n_errors;
+        free(ranges[k].table.messages);
+    }
+    free(ranges);
+
+    if (n_errors > 0) {
+        printf("Error: %ld malformed lines in %s\n", n_errors, filename);
+        exit(0);
+    }
+    if (total_rows == 0) {
+        printf("Error: %s contains no data\n", filename);
+        exit(0);
+    }
+
+    // Row pointers into the block of values
+    mlp_real** data = (mlp_real**)malloc(total_rows * sizeof(mlp_real*));
+    long i;
+    for (i = 0; i < total_rows; i++)
+        data[i] = task.values + (size_t)i * first.cols;
+
+    *rows = (int)total_rows;
+    *cols = first.cols;
+    TRACE_END();
+    return data;
+#else
+    (void)n_threads;
+    return read_csv_auto(filename, rows, cols);
+#endif
 }
@@ -4,9 +4,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "mlp_real.h"
+#include "mlp_trace.h"
 
 #define MAX_LINE_SIZE 1048576 // 2^20
 
-void read_csv(char*, int, int, double**);
+#define CSV_BLOCK_SIZE 16777216 // 2^24, bytes read from the file at a time
+#define CSV_MAX_ERRORS 10 // Malformed lines printed before the rest are only counted
+#define CSV_MESSAGE_SIZE 4096 // Longest error message, kept by parsing threads until all are done
 
-#endif
\ No newline at end of file
+void read_csv(char*, int, int, mlp_real**);
+
+// Read a .csv file of numbers, inferring the number of rows and columns from the file
+// Returns *rows row pointers into one block of *rows x *cols values, to be freed with free_csv()
+// Lines with a different number of fields than the first line, or with an empty or
+// non-numeric field, are reported with their line number and stop the program
+mlp_real** read_csv_auto(char*, int*, int*);
+void free_csv(mlp_real**);
+
+// read_csv_auto with the file split into n_threads byte ranges at line breaks, parsed in parallel
+// A first pass counts the rows of every range so each thread parses straight into its own rows
+// The rows and the error messages are the same as read_csv_auto's, for any number of threads
+// Files smaller than CSV_BLOCK_SIZE, and builds without threads, are read by read_csv_auto
+mlp_real** read_csv_parallel(char*, int*, int*, int);
+
+// Convert the decimal number in [begin, end) exactly, surrounding spaces allowed
+// Returns 1 on success, 0 if the text is not a number
+int csv_parse_number(const char*, const char*, double*);
+
+#endif
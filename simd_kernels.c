@@ -0,0 +1,761 @@
+/*
+Desc: Scalar and SIMD kernels for the matrix product, the activation functions and the weight updates,
+      chosen at runtime from the instruction sets of the CPU
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "simd_kernels.h"
+#include <stdint.h>
+#include <string.h>
+
+#define max(x, y) (x > y ? x : y)
+
+/* ------------------ Constants of the exponential ----------------------------------------*/
+
+#ifdef MLP_FLOAT
+#define LOG2E 1.44269504f
+#define LN2_HI 0.693359375f   // ln(2) split so that n * LN2_HI is exact
+#define LN2_LO -2.12194440e-4f
+#define EXP_ROUND 12582912.0f // 1.5 * 2^23, adding it rounds to an integer in the low bits
+#define EXP_MIN_ARG -87.0f
+#define EXP_MAX_ARG 88.0f
+#define TANH_MAX_ARG 20.0f    // tanh(10) is 1 in single precision
+
+// Terms of the Taylor series of e^r - 1 for each accuracy tier, |r| <= ln(2)/2
+// The truncation error of n terms is about (ln(2)/2)^(n+1) / (n+1)! relative to e^r
+#define EXP_TERMS 7         // ACTIVATION_EXACT, 5e-9
+#define EXP_TERMS_FAST 5    // ACTIVATION_FAST, 2e-6
+#define EXP_TERMS_FASTEST 4 // ACTIVATION_FASTEST, 4e-5
+
+// Bits of EXP_ROUND subtracted and the exponent bias added when building 2^n
+#define EXP_BIAS_BITS (127 - 0x4B400000)
+#define EXP_MANTISSA_BITS 23
+typedef uint32_t real_bits;
+#else
+#define LOG2E 1.4426950408889634
+#define LN2_HI 6.93147180369123816490e-01
+#define LN2_LO 1.90821492927058770002e-10
+#define EXP_ROUND 6755399441055744.0 // 1.5 * 2^52, adding it rounds to an integer in the low bits
+#define EXP_MIN_ARG -708.0
+#define EXP_MAX_ARG 709.0
+#define TANH_MAX_ARG 40.0 // tanh(20) is 1 in double precision
+
+// Terms of the Taylor series of e^r - 1 for each accuracy tier, |r| <= ln(2)/2
+// The truncation error of n terms is about (ln(2)/2)^(n+1) / (n+1)! relative to e^r
+#define EXP_TERMS 13        // ACTIVATION_EXACT, 4e-18
+#define EXP_TERMS_FAST 7    // ACTIVATION_FAST, 5e-9
+#define EXP_TERMS_FASTEST 4 // ACTIVATION_FASTEST, 4e-5
+
+// Bits of EXP_ROUND subtracted and the exponent bias added when building 2^n
+#define EXP_BIAS_BITS (1023LL - 0x4338000000000000LL)
+#define EXP_MANTISSA_BITS 52
+typedef uint64_t real_bits;
+#endif
+
+// 1/(i+1)! for i = 0..12
+static const mlp_real exp_taylor[13] = {
+    1.0, 1.0/2, 1.0/6, 1.0/24, 1.0/120, 1.0/720, 1.0/5040, 1.0/40320, 1.0/362880,
+    1.0/3628800, 1.0/39916800, 1.0/479001600, 1.0/6227020800.0
+};
+
+/* ------------------ Scalar reference kernels ----------------------------------------*/
+
+static void mat_mul_scalar(mlp_real* a, mlp_real* b, int ldb, mlp_real* result, int n, int p) {
+    // matrix a of size 1 x n (array)
+    // matrix b of size n x p, row-major with a row stride of ldb
+    // matrix result of size 1 x p (array)
+    // result = a * b
+    int j, k;
+    for (j = 0; j < p; j++)
+        result[j] = 0.0;
+
+    for (k = 0; k < n; k++) {
+        mlp_real* b_row = b + (size_t)k * ldb;
+        for (j = 0; j < p; j++)
+            result[j] += (a[k] * b_row[j]);
+    }
+}
+
+// Block of rows of b kept in cache while it is applied to every row of a
+#define MAT_MUL_BLOCK 64
+
+static void mat_mul_batch_scalar(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* result, int ldr, int m, int n, int p) {
+    // matrix a of size m x n, row-major with a row stride of lda
+    // matrix b of size n x p, row-major with a row stride of ldb
+    // matrix result of size m x p, row-major with a row stride of ldr
+    // result = a * b
+    int i, j, k, kk;
+    for (i = 0; i < m; i++)
+        for (j = 0; j < p; j++)
+            result[(size_t)i * ldr + j] = 0.0;
+
+    for (kk = 0; kk < n; kk += MAT_MUL_BLOCK) {
+        int k_end = kk + MAT_MUL_BLOCK < n ? kk + MAT_MUL_BLOCK : n;
+        for (i = 0; i < m; i++) {
+            mlp_real* a_row = a + (size_t)i * lda;
+            mlp_real* result_row = result + (size_t)i * ldr;
+            for (k = kk; k < k_end; k++) {
+                mlp_real* b_row = b + (size_t)k * ldb;
+                for (j = 0; j < p; j++)
+                    result_row[j] += (a_row[k] * b_row[j]);
+            }
+        }
+    }
+}
+
+static void mat_mul_nt_scalar(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* result, int ldr, int m, int n, int p) {
+    // matrix a of size m x n, row-major with a row stride of lda
+    // matrix b of size p x n, row-major with a row stride of ldb
+    // matrix result of size m x p, row-major with a row stride of ldr
+    // result = a * transpose(b)
+    int i, j, k;
+    for (i = 0; i < m; i++) {
+        mlp_real* a_row = a + (size_t)i * lda;
+        for (j = 0; j < p; j++) {
+            mlp_real* b_row = b + (size_t)j * ldb;
+            mlp_real sum = 0.0;
+            for (k = 0; k < n; k++)
+                sum += a_row[k] * b_row[k];
+            result[(size_t)i * ldr + j] = sum;
+        }
+    }
+}
+
+static void mat_mul_tn_scalar(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* result, int ldr, int m, int n, int p) {
+    // matrix a of size m x n, row-major with a row stride of lda
+    // matrix b of size m x p, row-major with a row stride of ldb
+    // matrix result of size n x p, row-major with a row stride of ldr
+    // result = transpose(a) * b, summed sample by sample over the m rows
+    int i, j, k;
+    for (k = 0; k < n; k++)
+        for (j = 0; j < p; j++)
+            result[(size_t)k * ldr + j] = 0.0;
+
+    for (i = 0; i < m; i++) {
+        mlp_real* a_row = a + (size_t)i * lda;
+        mlp_real* b_row = b + (size_t)i * ldb;
+        for (k = 0; k < n; k++) {
+            mlp_real* result_row = result + (size_t)k * ldr;
+            for (j = 0; j < p; j++)
+                result_row[j] += a_row[k] * b_row[j];
+        }
+    }
+}
+
+static void identity_scalar(int n, mlp_real* input, mlp_real* output) {
+    output[0] = 1; // Bias term
+
+    int i;
+    for (i = 0; i < n; i++)
+        output[i+1] = input[i]; // Identity function
+}
+
+static void sigmoid_scalar(int n, mlp_real* input, mlp_real* output) {
+    output[0] = 1; // Bias term
+
+    int i;
+    for (i = 0; i < n; i++)
+        output[i+1] = 1 / (1 + real_exp(-input[i])); // Sigmoid function
+}
+
+static void tan_h_scalar(int n, mlp_real* input, mlp_real* output) {
+    output[0] = 1; // Bias term
+
+    int i;
+    for (i = 0; i < n; i++)
+        output[i+1] = real_tanh(input[i]); // tanh function
+}
+
+static void relu_scalar(int n, mlp_real* input, mlp_real* output) {
+    output[0] = 1; // Bias term
+
+    int i;
+    for (i = 0; i < n; i++)
+        output[i+1] = max(0, input[i]); // ReLU function
+}
+
+static void softmax_scalar(int n, mlp_real* input, mlp_real* output) {
+    output[0] = 1; // Bias term
+
+    // Shift by the largest input so no exponential overflows, and compute each one once
+    int i;
+    mlp_real largest = input[0];
+    for (i = 1; i < n; i++)
+        largest = max(largest, input[i]);
+
+    mlp_real sum = 0.0;
+    for (i = 0; i < n; i++) {
+        output[i+1] = real_exp(input[i] - largest);
+        sum += output[i+1];
+    }
+
+    for (i = 0; i < n; i++)
+        output[i+1] /= sum; // Softmax function
+}
+
+/* ------------------ Scalar approximations ----------------------------------------*/
+
+// Same range reduction and series as the vector exponential, with the given number of terms
+// exp(x) = scale * (1 + q)
+static inline mlp_real exp_parts_scalar(mlp_real x, mlp_real* scale, const int terms) {
+    if (x < EXP_MIN_ARG)
+        x = EXP_MIN_ARG;
+    if (x > EXP_MAX_ARG)
+        x = EXP_MAX_ARG;
+
+    mlp_real t = x * LOG2E + EXP_ROUND;
+    mlp_real n = t - EXP_ROUND;
+    mlp_real r = (x - n * LN2_HI) - n * LN2_LO;
+
+    int i;
+    mlp_real h = exp_taylor[terms-1];
+    for (i = terms-2; i >= 0; i--)
+        h = h * r + exp_taylor[i];
+
+    // 2^n from the integer in the low bits of t
+    real_bits bits;
+    memcpy(&bits, &t, sizeof(bits));
+    bits = (bits + (real_bits)EXP_BIAS_BITS) << EXP_MANTISSA_BITS;
+    memcpy(scale, &bits, sizeof(bits));
+
+    return r * h;
+}
+
+static inline mlp_real exp_approx(mlp_real x, const int terms) {
+    mlp_real scale;
+    mlp_real q = exp_parts_scalar(x, &scale, terms);
+    return scale * q + scale;
+}
+
+static inline mlp_real tanh_approx(mlp_real x, const int terms) {
+    mlp_real a = real_fabs(x) * 2;
+    if (a > TANH_MAX_ARG)
+        a = TANH_MAX_ARG;
+
+    mlp_real scale;
+    mlp_real q = exp_parts_scalar(a, &scale, terms);
+    mlp_real e = scale * q + (scale - 1);
+    return real_copysign(e / (e + 2), x);
+}
+
+// Approximate tiers of the scalar activations for the given number of terms of the series
+#define SCALAR_TIER(tier, terms) \
+static void sigmoid_##tier##_scalar(int n, mlp_real* input, mlp_real* output) { \
+    output[0] = 1; \
+    int i; \
+    for (i = 0; i < n; i++) \
+        output[i+1] = 1 / (1 + exp_approx(-input[i], terms)); \
+} \
+static void tan_h_##tier##_scalar(int n, mlp_real* input, mlp_real* output) { \
+    output[0] = 1; \
+    int i; \
+    for (i = 0; i < n; i++) \
+        output[i+1] = tanh_approx(input[i], terms); \
+} \
+static void softmax_##tier##_scalar(int n, mlp_real* input, mlp_real* output) { \
+    output[0] = 1; \
+    int i; \
+    mlp_real largest = input[0]; \
+    for (i = 1; i < n; i++) \
+        largest = max(largest, input[i]); \
+    mlp_real sum = 0.0; \
+    for (i = 0; i < n; i++) { \
+        output[i+1] = exp_approx(input[i] - largest, terms); \
+        sum += output[i+1]; \
+    } \
+    for (i = 0; i < n; i++) \
+        output[i+1] /= sum; \
+}
+
+SCALAR_TIER(fast, EXP_TERMS_FAST)
+SCALAR_TIER(fastest, EXP_TERMS_FASTEST)
+
+#undef SCALAR_TIER
+
+// Dense layer of the scalar reference: the products are written straight into the output rows
+// after the bias column, and the activation is applied to every row in place
+#define SCALAR_DENSE(name, activation) \
+static void dense_##name##_scalar(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* output, int ldo, int m, int n, int p) { \
+    mat_mul_batch_scalar(a, lda, b, ldb, output + 1, ldo, m, n, p); \
+    int i; \
+    for (i = 0; i < m; i++) \
+        activation(p, output + (size_t)i * ldo + 1, output + (size_t)i * ldo); \
+}
+
+SCALAR_DENSE(identity, identity_scalar)
+SCALAR_DENSE(sigmoid, sigmoid_scalar)
+SCALAR_DENSE(sigmoid_fast, sigmoid_fast_scalar)
+SCALAR_DENSE(sigmoid_fastest, sigmoid_fastest_scalar)
+SCALAR_DENSE(tan_h, tan_h_scalar)
+SCALAR_DENSE(tan_h_fast, tan_h_fast_scalar)
+SCALAR_DENSE(tan_h_fastest, tan_h_fastest_scalar)
+SCALAR_DENSE(relu, relu_scalar)
+SCALAR_DENSE(softmax, softmax_scalar)
+SCALAR_DENSE(softmax_fast, softmax_fast_scalar)
+SCALAR_DENSE(softmax_fastest, softmax_fastest_scalar)
+
+#undef SCALAR_DENSE
+
+// Weight updates of the scalar reference, with g the gradient averaged over the batch
+static void sgd_scalar(size_t n, mlp_real* weight, const mlp_real* gradient, mlp_real* velocity, mlp_real* square, const update_step* c) {
+    size_t i;
+    for (i = 0; i < n; i++)
+        weight[i] -= c->rate * gradient[i];
+}
+
+// v = momentum * v + rate * g, then w -= v
+static void momentum_scalar(size_t n, mlp_real* weight, const mlp_real* gradient, mlp_real* velocity, mlp_real* square, const update_step* c) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        velocity[i] = c->momentum * velocity[i] + c->rate * gradient[i];
+        weight[i] -= velocity[i];
+    }
+}
+
+// The same velocity, but the step looks ahead along it: w -= momentum * v + rate * g
+static void nesterov_scalar(size_t n, mlp_real* weight, const mlp_real* gradient, mlp_real* velocity, mlp_real* square, const update_step* c) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        mlp_real g = c->rate * gradient[i];
+        velocity[i] = c->momentum * velocity[i] + g;
+        weight[i] -= c->momentum * velocity[i] + g;
+    }
+}
+
+// s = decay * s + (1 - decay) * g^2, then w -= step * g / (sqrt(s) + epsilon)
+static void rmsprop_scalar(size_t n, mlp_real* weight, const mlp_real* gradient, mlp_real* velocity, mlp_real* square, const update_step* c) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        mlp_real g = c->scale * gradient[i];
+        square[i] = c->decay * square[i] + (1 - c->decay) * g * g;
+        weight[i] -= c->step * g / (real_sqrt(square[i]) + c->epsilon);
+    }
+}
+
+// m = momentum * m + (1 - momentum) * g and s as for RMSProp, then w -= step * m / (sqrt(s) + epsilon)
+static void adam_scalar(size_t n, mlp_real* weight, const mlp_real* gradient, mlp_real* velocity, mlp_real* square, const update_step* c) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        mlp_real g = c->scale * gradient[i];
+        velocity[i] = c->momentum * velocity[i] + (1 - c->momentum) * g;
+        square[i] = c->decay * square[i] + (1 - c->decay) * g * g;
+        weight[i] -= c->step * velocity[i] / (real_sqrt(square[i]) + c->epsilon);
+    }
+}
+
+static const simd_kernels scalar_kernels = {
+    "scalar",
+    mat_mul_scalar,
+    mat_mul_batch_scalar,
+    mat_mul_nt_scalar,
+    mat_mul_tn_scalar,
+    identity_scalar,
+    { sigmoid_scalar, sigmoid_fast_scalar, sigmoid_fastest_scalar },
+    { tan_h_scalar, tan_h_fast_scalar, tan_h_fastest_scalar },
+    relu_scalar,
+    { softmax_scalar, softmax_fast_scalar, softmax_fastest_scalar },
+    dense_identity_scalar,
+    { dense_sigmoid_scalar, dense_sigmoid_fast_scalar, dense_sigmoid_fastest_scalar },
+    { dense_tan_h_scalar, dense_tan_h_fast_scalar, dense_tan_h_fastest_scalar },
+    dense_relu_scalar,
+    { dense_softmax_scalar, dense_softmax_fast_scalar, dense_softmax_fastest_scalar },
+    { sgd_scalar, momentum_scalar, nesterov_scalar, rmsprop_scalar, adam_scalar }
+};
+
+const simd_kernels* simd = &scalar_kernels;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+
+#include <immintrin.h>
+
+/* ------------------ SSE2 ----------------------------------------*/
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+#ifdef MLP_FLOAT
+#define SIMD_FN(name) name##_sse2
+#define SIMD_NAME "sse2"
+#define VEC __m128
+#define W 4
+#define V_ZERO() _mm_setzero_ps()
+#define V_SET1(x) _mm_set1_ps(x)
+#define V_LOADU(p) _mm_loadu_ps(p)
+#define V_STOREU(p, v) _mm_storeu_ps(p, v)
+#define V_LOAD_TAIL(p, n) load_tail_sse2(p, n)
+#define V_STORE_TAIL(p, v, n) store_tail_sse2(p, v, n)
+#define V_ADD(a, b) _mm_add_ps(a, b)
+#define V_SUB(a, b) _mm_sub_ps(a, b)
+#define V_MUL(a, b) _mm_mul_ps(a, b)
+#define V_DIV(a, b) _mm_div_ps(a, b)
+#define V_SQRT(v) _mm_sqrt_ps(v)
+#define V_MAX(a, b) _mm_max_ps(a, b)
+#define V_MIN(a, b) _mm_min_ps(a, b)
+#define V_FMA(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#define V_ABS(v) _mm_andnot_ps(_mm_set1_ps(-0.0f), v)
+#define V_COPYSIGN(v, s) _mm_or_ps(v, _mm_and_ps(_mm_set1_ps(-0.0f), s))
+#define V_REDUCE_ADD(v) reduce_add_sse2(v)
+#define V_REDUCE_MAX(v) reduce_max_sse2(v)
+#define V_POW2(t) _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_castps_si128(t), _mm_set1_epi32(EXP_BIAS_BITS)), 23))
+
+// First n < 4 lanes, through 64-bit and 32-bit moves
+static inline __m128 load_tail_sse2(const float* p, int n) {
+    if (n == 1)
+        return _mm_load_ss(p);
+    __m128 low = _mm_castpd_ps(_mm_load_sd((const double*)p));
+    return n == 2 ? low : _mm_movelh_ps(low, _mm_load_ss(p + 2));
+}
+
+static inline void store_tail_sse2(float* p, __m128 v, int n) {
+    if (n == 1) {
+        _mm_store_ss(p, v);
+        return;
+    }
+    _mm_storel_pi((__m64*)p, v);
+    if (n == 3)
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+}
+
+static inline float reduce_add_sse2(__m128 v) {
+    __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+static inline float reduce_max_sse2(__m128 v) {
+    __m128 s = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#else
+#define SIMD_FN(name) name##_sse2
+#define SIMD_NAME "sse2"
+#define VEC __m128d
+#define W 2
+#define V_ZERO() _mm_setzero_pd()
+#define V_SET1(x) _mm_set1_pd(x)
+#define V_LOADU(p) _mm_loadu_pd(p)
+#define V_STOREU(p, v) _mm_storeu_pd(p, v)
+#define V_LOAD_TAIL(p, n) ((void)(n), _mm_load_sd(p)) // n is always 1
+#define V_STORE_TAIL(p, v, n) ((void)(n), _mm_store_sd(p, v))
+#define V_ADD(a, b) _mm_add_pd(a, b)
+#define V_SUB(a, b) _mm_sub_pd(a, b)
+#define V_MUL(a, b) _mm_mul_pd(a, b)
+#define V_DIV(a, b) _mm_div_pd(a, b)
+#define V_SQRT(v) _mm_sqrt_pd(v)
+#define V_MAX(a, b) _mm_max_pd(a, b)
+#define V_MIN(a, b) _mm_min_pd(a, b)
+#define V_FMA(a, b, c) _mm_add_pd(_mm_mul_pd(a, b), c)
+#define V_ABS(v) _mm_andnot_pd(_mm_set1_pd(-0.0), v)
+#define V_COPYSIGN(v, s) _mm_or_pd(v, _mm_and_pd(_mm_set1_pd(-0.0), s))
+#define V_REDUCE_ADD(v) _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)))
+#define V_REDUCE_MAX(v) _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)))
+#define V_POW2(t) _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(_mm_castpd_si128(t), _mm_set1_epi64x(EXP_BIAS_BITS)), 52))
+#endif
+
+#include "simd_kernels_impl.h"
+
+#pragma GCC pop_options
+
+#undef SIMD_FN
+#undef SIMD_NAME
+#undef VEC
+#undef W
+#undef V_ZERO
+#undef V_SET1
+#undef V_LOADU
+#undef V_STOREU
+#undef V_LOAD_TAIL
+#undef V_STORE_TAIL
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_SQRT
+#undef V_MAX
+#undef V_MIN
+#undef V_FMA
+#undef V_ABS
+#undef V_COPYSIGN
+#undef V_REDUCE_ADD
+#undef V_REDUCE_MAX
+#undef V_POW2
+
+/* ------------------ AVX2 ----------------------------------------*/
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+#ifdef MLP_FLOAT
+// Lanes [8-n, 16-n) of this table enable the first n lanes of a vector
+static const int avx2_tail_mask[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+#define SIMD_FN(name) name##_avx2
+#define SIMD_NAME "avx2"
+#define VEC __m256
+#define W 8
+#define AVX2_MASK(n) _mm256_loadu_si256((const __m256i*)(avx2_tail_mask + 8 - (n)))
+#define V_ZERO() _mm256_setzero_ps()
+#define V_SET1(x) _mm256_set1_ps(x)
+#define V_LOADU(p) _mm256_loadu_ps(p)
+#define V_STOREU(p, v) _mm256_storeu_ps(p, v)
+#define V_LOAD_TAIL(p, n) _mm256_maskload_ps(p, AVX2_MASK(n))
+#define V_STORE_TAIL(p, v, n) _mm256_maskstore_ps(p, AVX2_MASK(n), v)
+#define V_ADD(a, b) _mm256_add_ps(a, b)
+#define V_SUB(a, b) _mm256_sub_ps(a, b)
+#define V_MUL(a, b) _mm256_mul_ps(a, b)
+#define V_DIV(a, b) _mm256_div_ps(a, b)
+#define V_SQRT(v) _mm256_sqrt_ps(v)
+#define V_MAX(a, b) _mm256_max_ps(a, b)
+#define V_MIN(a, b) _mm256_min_ps(a, b)
+#define V_FMA(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define V_ABS(v) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v)
+#define V_COPYSIGN(v, s) _mm256_or_ps(v, _mm256_and_ps(_mm256_set1_ps(-0.0f), s))
+#define V_POW2(t) _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_castps_si256(t), _mm256_set1_epi32(EXP_BIAS_BITS)), 23))
+
+static inline float reduce_add_avx2(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#define V_REDUCE_ADD(v) reduce_add_avx2(v)
+
+static inline float reduce_max_avx2(__m256 v) {
+    __m128 s = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_max_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#define V_REDUCE_MAX(v) reduce_max_avx2(v)
+#else
+// Lanes [4-n, 8-n) of this table enable the first n lanes of a vector
+static const long long avx2_tail_mask[8] = { -1, -1, -1, -1, 0, 0, 0, 0 };
+
+#define SIMD_FN(name) name##_avx2
+#define SIMD_NAME "avx2"
+#define VEC __m256d
+#define W 4
+#define AVX2_MASK(n) _mm256_loadu_si256((const __m256i*)(avx2_tail_mask + 4 - (n)))
+#define V_ZERO() _mm256_setzero_pd()
+#define V_SET1(x) _mm256_set1_pd(x)
+#define V_LOADU(p) _mm256_loadu_pd(p)
+#define V_STOREU(p, v) _mm256_storeu_pd(p, v)
+#define V_LOAD_TAIL(p, n) _mm256_maskload_pd(p, AVX2_MASK(n))
+#define V_STORE_TAIL(p, v, n) _mm256_maskstore_pd(p, AVX2_MASK(n), v)
+#define V_ADD(a, b) _mm256_add_pd(a, b)
+#define V_SUB(a, b) _mm256_sub_pd(a, b)
+#define V_MUL(a, b) _mm256_mul_pd(a, b)
+#define V_DIV(a, b) _mm256_div_pd(a, b)
+#define V_SQRT(v) _mm256_sqrt_pd(v)
+#define V_MAX(a, b) _mm256_max_pd(a, b)
+#define V_MIN(a, b) _mm256_min_pd(a, b)
+#define V_FMA(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define V_ABS(v) _mm256_andnot_pd(_mm256_set1_pd(-0.0), v)
+#define V_COPYSIGN(v, s) _mm256_or_pd(v, _mm256_and_pd(_mm256_set1_pd(-0.0), s))
+#define V_POW2(t) _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(EXP_BIAS_BITS)), 52))
+
+static inline double reduce_add_avx2(__m256d v) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+#define V_REDUCE_ADD(v) reduce_add_avx2(v)
+
+static inline double reduce_max_avx2(__m256d v) {
+    __m128d s = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(s, _mm_unpackhi_pd(s, s)));
+}
+#define V_REDUCE_MAX(v) reduce_max_avx2(v)
+#endif
+
+#include "simd_kernels_impl.h"
+
+#pragma GCC pop_options
+
+#undef SIMD_FN
+#undef SIMD_NAME
+#undef VEC
+#undef W
+#undef V_ZERO
+#undef V_SET1
+#undef V_LOADU
+#undef V_STOREU
+#undef V_LOAD_TAIL
+#undef V_STORE_TAIL
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_SQRT
+#undef V_MAX
+#undef V_MIN
+#undef V_FMA
+#undef V_ABS
+#undef V_COPYSIGN
+#undef V_REDUCE_ADD
+#undef V_REDUCE_MAX
+#undef V_POW2
+
+/* ------------------ AVX-512 ----------------------------------------*/
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+#ifdef MLP_FLOAT
+#define SIMD_FN(name) name##_avx512
+#define SIMD_NAME "avx512"
+#define VEC __m512
+#define W 16
+#define AVX512_MASK(n) ((__mmask16)((1u << (n)) - 1))
+#define V_ZERO() _mm512_setzero_ps()
+#define V_SET1(x) _mm512_set1_ps(x)
+#define V_LOADU(p) _mm512_loadu_ps(p)
+#define V_STOREU(p, v) _mm512_storeu_ps(p, v)
+#define V_LOAD_TAIL(p, n) _mm512_maskz_loadu_ps(AVX512_MASK(n), p)
+#define V_STORE_TAIL(p, v, n) _mm512_mask_storeu_ps(p, AVX512_MASK(n), v)
+#define V_ADD(a, b) _mm512_add_ps(a, b)
+#define V_SUB(a, b) _mm512_sub_ps(a, b)
+#define V_MUL(a, b) _mm512_mul_ps(a, b)
+#define V_DIV(a, b) _mm512_div_ps(a, b)
+#define V_SQRT(v) _mm512_sqrt_ps(v)
+#define V_MAX(a, b) _mm512_max_ps(a, b)
+#define V_MIN(a, b) _mm512_min_ps(a, b)
+#define V_FMA(a, b, c) _mm512_fmadd_ps(a, b, c)
+#define V_ABS(v) _mm512_abs_ps(v)
+#define V_COPYSIGN(v, s) _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(v), \
+    _mm512_and_si512(_mm512_castps_si512(s), _mm512_set1_epi32((int)0x80000000))))
+#define V_REDUCE_ADD(v) _mm512_reduce_add_ps(v)
+#define V_REDUCE_MAX(v) _mm512_reduce_max_ps(v)
+#define V_POW2(t) _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_castps_si512(t), _mm512_set1_epi32(EXP_BIAS_BITS)), 23))
+#else
+#define SIMD_FN(name) name##_avx512
+#define SIMD_NAME "avx512"
+#define VEC __m512d
+#define W 8
+#define AVX512_MASK(n) ((__mmask8)((1u << (n)) - 1))
+#define V_ZERO() _mm512_setzero_pd()
+#define V_SET1(x) _mm512_set1_pd(x)
+#define V_LOADU(p) _mm512_loadu_pd(p)
+#define V_STOREU(p, v) _mm512_storeu_pd(p, v)
+#define V_LOAD_TAIL(p, n) _mm512_maskz_loadu_pd(AVX512_MASK(n), p)
+#define V_STORE_TAIL(p, v, n) _mm512_mask_storeu_pd(p, AVX512_MASK(n), v)
+#define V_ADD(a, b) _mm512_add_pd(a, b)
+#define V_SUB(a, b) _mm512_sub_pd(a, b)
+#define V_MUL(a, b) _mm512_mul_pd(a, b)
+#define V_DIV(a, b) _mm512_div_pd(a, b)
+#define V_SQRT(v) _mm512_sqrt_pd(v)
+#define V_MAX(a, b) _mm512_max_pd(a, b)
+#define V_MIN(a, b) _mm512_min_pd(a, b)
+#define V_FMA(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define V_ABS(v) _mm512_abs_pd(v)
+#define V_COPYSIGN(v, s) _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(v), \
+    _mm512_and_si512(_mm512_castpd_si512(s), _mm512_set1_epi64(0x8000000000000000LL))))
+#define V_REDUCE_ADD(v) _mm512_reduce_add_pd(v)
+#define V_REDUCE_MAX(v) _mm512_reduce_max_pd(v)
+#define V_POW2(t) _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(_mm512_castpd_si512(t), _mm512_set1_epi64(EXP_BIAS_BITS)), 52))
+#endif
+
+#include "simd_kernels_impl.h"
+
+#pragma GCC pop_options
+
+#endif
+
+/* ------------------ Dispatch ----------------------------------------*/
+
+// Widest instruction set supported by the CPU
+static int simd_supported(void) {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+int simd_select(int level) {
+    int supported = simd_supported();
+    if (level > supported)
+        level = supported;
+
+    switch (level) {
+#ifdef SIMD_X86
+        case SIMD_AVX512:
+            simd = &kernels_avx512;
+            break;
+        case SIMD_AVX2:
+            simd = &kernels_avx2;
+            break;
+        case SIMD_SSE2:
+            simd = &kernels_sse2;
+            break;
+#endif
+        default:
+            simd = &scalar_kernels;
+            level = SIMD_SCALAR;
+            break;
+    }
+
+    return level;
+}
+
+void simd_init(void) {
+    static int initialized = 0;
+    if (initialized)
+        return;
+    initialized = 1;
+
+    int level = SIMD_AVX512;
+    char* cap = getenv("MLP_SIMD");
+    if (cap != NULL) {
+        if (strcmp(cap, "scalar") == 0)
+            level = SIMD_SCALAR;
+        else if (strcmp(cap, "sse2") == 0)
+            level = SIMD_SSE2;
+        else if (strcmp(cap, "avx2") == 0)
+            level = SIMD_AVX2;
+    }
+
+    simd_select(level);
+}
+
+/* ------------------ Kernels of a layer ----------------------------------------*/
+
+activation_kernel simd_activation(int activation_function, int accuracy) {
+    // Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+    switch (activation_function) {
+        case 1: // identity
+            return simd->identity;
+        case 2: // sigmoid
+            return simd->sigmoid[accuracy];
+        case 3: // tanh
+            return simd->tan_h[accuracy];
+        case 4: // relu
+            return simd->relu;
+        case 5: // softmax
+            return simd->softmax[accuracy];
+        default:
+            printf("Forward propagation: Invalid activation function\n");
+            exit(0);
+    }
+}
+
+dense_kernel simd_dense(int activation_function, int accuracy) {
+    // Activation functions (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+    switch (activation_function) {
+        case 1: // identity
+            return simd->dense_identity;
+        case 2: // sigmoid
+            return simd->dense_sigmoid[accuracy];
+        case 3: // tanh
+            return simd->dense_tan_h[accuracy];
+        case 4: // relu
+            return simd->dense_relu;
+        case 5: // softmax
+            return simd->dense_softmax[accuracy];
+        default:
+            printf("Forward propagation: Invalid activation function\n");
+            exit(0);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "mlp_real.h"
+
+// Instruction sets of the kernels, from the scalar reference up
+#define SIMD_SCALAR 0
+#define SIMD_SSE2 1
+#define SIMD_AVX2 2
+#define SIMD_AVX512 3
+
+// Accuracy tiers of sigmoid, tanh and softmax, selected per model by parameters.activation_accuracy
+// Measured maximum errors against long double libm (relative for sigmoid and softmax, absolute for tanh):
+//                       double                                   float (-DMLP_FLOAT)
+//   ACTIVATION_EXACT    libm / 13-term series: 3e-16, 2e-16      libm / 7-term series: 1.7e-7, 8e-8
+//   ACTIVATION_FAST     7-term series: 7.1e-9, 3e-9              5-term series: 3.3e-6, 1.5e-6
+//   ACTIVATION_FASTEST  4-term series: 5.6e-5, 2.5e-5            4-term series: 5.6e-5, 2.5e-5
+// Every tier of every SIMD level is thus within twice the larger of its two errors of the scalar
+// ACTIVATION_EXACT kernels, the bound simd_test.c checks
+#define ACTIVATION_EXACT 0
+#define ACTIVATION_FAST 1
+#define ACTIVATION_FASTEST 2
+#define ACTIVATION_TIERS 3
+
+// Weight update rules, selected per run by parameters.optimizer
+#define OPTIMIZER_SGD 0      // Plain gradient descent
+#define OPTIMIZER_MOMENTUM 1 // Gradient descent with momentum
+#define OPTIMIZER_NESTEROV 2 // Nesterov's accelerated gradient
+#define OPTIMIZER_RMSPROP 3  // Step divided by the root of a running average of the squared gradient
+#define OPTIMIZER_ADAM 4     // Running averages of the gradient and of its square, with bias correction
+#define OPTIMIZERS 5
+
+// Activation: n inputs, the bias term written to output[0] and f(input[i]) to output[i+1]
+// input may be output+1, the activation is then applied in place
+typedef void (*activation_kernel)(int, mlp_real*, mlp_real*);
+
+// Fully connected layer fused with its activation: output (m x (p+1)) = [1, f(a (m x n) * b (n x p))],
+// each matrix row-major with its own row stride. The activation is applied to the products while they
+// are still in registers, softmax to each row once it is complete, so no pre-activation is stored
+typedef void (*dense_kernel)(mlp_real*, int, mlp_real*, int, mlp_real*, int, int, int, int);
+
+// Coefficients of one weight update, the same for every weight
+typedef struct {
+    mlp_real rate;     // Learning rate divided by the batch size, the step along the summed gradient
+    mlp_real scale;    // 1 / batch size, turns the summed gradient into its average for RMSProp and Adam
+    mlp_real step;     // Learning rate of RMSProp and Adam, with the bias correction of Adam
+    mlp_real momentum; // Decay of the velocity (momentum, Nesterov) or of the gradient average (Adam)
+    mlp_real decay;    // Decay of the average of the squared gradient (RMSProp, Adam)
+    mlp_real epsilon;  // Added to the root of the squared-gradient average
+} update_step;
+
+// Weight update: n weights moved against their gradient summed over a batch, in one pass that also
+// updates the velocity (or gradient average) and the squared-gradient average the optimizer keeps,
+// both laid out like the weights and NULL when the optimizer has no such state
+typedef void (*update_kernel)(size_t, mlp_real*, const mlp_real*, mlp_real*, mlp_real*, const update_step*);
+
+// Hot-path kernels of forward propagation, classification, batch back propagation and the weight update
+// mat_mul: result (1 x p) = a (1 x n) * b (n x p), b with a row stride of ldb
+// mat_mul_batch: result (m x p) = a (m x n) * b (n x p), each matrix row-major with its own row stride
+// mat_mul_nt: result (m x p) = a (m x n) * transpose(b (p x n)), the errors of a hidden layer for a batch
+// mat_mul_tn: result (n x p) = transpose(a (m x n)) * b (m x p), the weight gradients summed over a batch
+// sigmoid, tan_h and softmax are indexed by accuracy tier, and so are their dense kernels
+// update is indexed by optimizer
+typedef struct {
+    const char* name;
+    void (*mat_mul)(mlp_real*, mlp_real*, int, mlp_real*, int, int);
+    void (*mat_mul_batch)(mlp_real*, int, mlp_real*, int, mlp_real*, int, int, int, int);
+    void (*mat_mul_nt)(mlp_real*, int, mlp_real*, int, mlp_real*, int, int, int, int);
+    void (*mat_mul_tn)(mlp_real*, int, mlp_real*, int, mlp_real*, int, int, int, int);
+    void (*identity)(int, mlp_real*, mlp_real*);
+    void (*sigmoid[ACTIVATION_TIERS])(int, mlp_real*, mlp_real*);
+    void (*tan_h[ACTIVATION_TIERS])(int, mlp_real*, mlp_real*);
+    void (*relu)(int, mlp_real*, mlp_real*);
+    void (*softmax[ACTIVATION_TIERS])(int, mlp_real*, mlp_real*);
+    dense_kernel dense_identity;
+    dense_kernel dense_sigmoid[ACTIVATION_TIERS];
+    dense_kernel dense_tan_h[ACTIVATION_TIERS];
+    dense_kernel dense_relu;
+    dense_kernel dense_softmax[ACTIVATION_TIERS];
+    update_kernel update[OPTIMIZERS];
+} simd_kernels;
+
+// Kernels in use, the scalar reference until simd_init() is called
+extern const simd_kernels* simd;
+
+// Select the widest instruction set supported by the CPU, once
+// The MLP_SIMD environment variable (scalar, sse2, avx2, avx512) caps the choice
+void simd_init(void);
+
+// Select the kernels of the given instruction set, or the widest supported one below it
+// Returns the instruction set in use
+int simd_select(int);
+
+// Kernels in use for an activation function (identity - 1, sigmoid - 2, tanh - 3, relu - 4, softmax - 5)
+// and accuracy tier, resolved once per model rather than for every layer of every sample
+activation_kernel simd_activation(int, int);
+dense_kernel simd_dense(int, int);
+
+#endif
@@ -0,0 +1,561 @@
+/*
+Desc: Vector kernels written once against the V_* macros and instantiated by
+      simd_kernels.c for every instruction set (SSE2, AVX2, AVX-512)
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+// Expected from the including file:
+//   SIMD_FN(name)       Name of the kernel for this instruction set
+//   VEC, W              Vector type of mlp_real and its number of lanes
+//   V_ZERO(), V_SET1(x), V_LOADU(p), V_STOREU(p, v)
+//   V_LOAD_TAIL(p, n), V_STORE_TAIL(p, v, n)   First n < W lanes only, the others load as 0
+//   V_ADD, V_SUB, V_MUL, V_DIV, V_SQRT, V_MAX, V_MIN, V_FMA(a, b, c) = a * b + c
+//   V_ABS(v), V_COPYSIGN(v, s), V_REDUCE_ADD(v), V_REDUCE_MAX(v)
+//   V_POW2(t)           2^n for t = n + EXP_ROUND, n integral
+
+// exp(x) = 2^n * (1 + q), x = n * ln(2) + r, |r| <= ln(2)/2
+// q = e^r - 1 by the first terms of its Taylor series (EXP_TERMS for the exact tier)
+static inline VEC SIMD_FN(exp_parts)(VEC x, VEC* scale, const int terms) {
+    x = V_MIN(V_MAX(x, V_SET1(EXP_MIN_ARG)), V_SET1(EXP_MAX_ARG));
+
+    VEC t = V_ADD(V_MUL(x, V_SET1(LOG2E)), V_SET1(EXP_ROUND));
+    VEC n = V_SUB(t, V_SET1(EXP_ROUND));
+    VEC r = V_SUB(V_SUB(x, V_MUL(n, V_SET1(LN2_HI))), V_MUL(n, V_SET1(LN2_LO)));
+
+    int i;
+    VEC h = V_SET1(exp_taylor[terms-1]);
+    for (i = terms-2; i >= 0; i--)
+        h = V_FMA(h, r, V_SET1(exp_taylor[i]));
+
+    *scale = V_POW2(t);
+    return V_MUL(r, h);
+}
+
+static inline VEC SIMD_FN(exp_v)(VEC x, const int terms) {
+    VEC scale;
+    VEC q = SIMD_FN(exp_parts)(x, &scale, terms);
+    return V_FMA(scale, q, scale);
+}
+
+static inline VEC SIMD_FN(sigmoid_v)(VEC x, const int terms) {
+    VEC one = V_SET1(1.0);
+    return V_DIV(one, V_ADD(one, SIMD_FN(exp_v)(V_SUB(V_ZERO(), x), terms)));
+}
+
+// tanh(|x|) = e / (e + 2) with e = exp(2|x|) - 1, kept accurate near 0 by computing e from q
+static inline VEC SIMD_FN(tanh_v)(VEC x, const int terms) {
+    VEC a = V_MIN(V_MUL(V_ABS(x), V_SET1(2.0)), V_SET1(TANH_MAX_ARG));
+    VEC scale;
+    VEC q = SIMD_FN(exp_parts)(a, &scale, terms);
+    VEC e = V_FMA(scale, q, V_SUB(scale, V_SET1(1.0)));
+    return V_COPYSIGN(V_DIV(e, V_ADD(e, V_SET1(2.0))), x);
+}
+
+// relu and identity take the number of terms only to share SIMD_ACTIVATION
+static inline VEC SIMD_FN(relu_v)(VEC x, const int terms) {
+    (void)terms;
+    return V_MAX(V_ZERO(), x);
+}
+
+static inline VEC SIMD_FN(identity_v)(VEC x, const int terms) {
+    (void)terms;
+    return x;
+}
+
+static void SIMD_FN(mat_mul)(mlp_real* a, mlp_real* b, int ldb, mlp_real* result, int n, int p) {
+    // result (1 x p) = a (1 x n) * b (n x p), b row-major with a row stride of ldb
+    // Blocks of columns are accumulated in registers over all the rows of b
+    int j = 0, k;
+    for (; j + 4*W <= p; j += 4*W) {
+        VEC acc0 = V_ZERO(), acc1 = V_ZERO(), acc2 = V_ZERO(), acc3 = V_ZERO();
+        for (k = 0; k < n; k++) {
+            VEC a_k = V_SET1(a[k]);
+            mlp_real* b_row = b + (size_t)k * ldb + j;
+            acc0 = V_FMA(a_k, V_LOADU(b_row), acc0);
+            acc1 = V_FMA(a_k, V_LOADU(b_row + W), acc1);
+            acc2 = V_FMA(a_k, V_LOADU(b_row + 2*W), acc2);
+            acc3 = V_FMA(a_k, V_LOADU(b_row + 3*W), acc3);
+        }
+        V_STOREU(result + j, acc0);
+        V_STOREU(result + j + W, acc1);
+        V_STOREU(result + j + 2*W, acc2);
+        V_STOREU(result + j + 3*W, acc3);
+    }
+
+    for (; j + W <= p; j += W) {
+        VEC acc = V_ZERO();
+        for (k = 0; k < n; k++)
+            acc = V_FMA(V_SET1(a[k]), V_LOADU(b + (size_t)k * ldb + j), acc);
+        V_STOREU(result + j, acc);
+    }
+
+    // Remaining columns with masked loads and stores
+    if (j < p) {
+        int tail = p - j;
+        VEC acc = V_ZERO();
+        for (k = 0; k < n; k++)
+            acc = V_FMA(V_SET1(a[k]), V_LOAD_TAIL(b + (size_t)k * ldb + j, tail), acc);
+        V_STORE_TAIL(result + j, acc, tail);
+    }
+}
+
+static void SIMD_FN(mat_mul_batch)(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* result, int ldr, int m, int n, int p) {
+    // result (m x p) = a (m x n) * b (n x p), all row-major with their own row strides
+    // Four rows of a are computed together so every load of b is used four times
+    int i = 0, j, k;
+    for (; i + 4 <= m; i += 4) {
+        mlp_real* a0 = a + (size_t)i * lda;
+        mlp_real* a1 = a0 + lda;
+        mlp_real* a2 = a1 + lda;
+        mlp_real* a3 = a2 + lda;
+        mlp_real* r0 = result + (size_t)i * ldr;
+        for (j = 0; j < p; j += W) {
+            int tail = p - j;
+            VEC acc0 = V_ZERO(), acc1 = V_ZERO(), acc2 = V_ZERO(), acc3 = V_ZERO();
+            if (tail >= W) {
+                for (k = 0; k < n; k++) {
+                    VEC b_k = V_LOADU(b + (size_t)k * ldb + j);
+                    acc0 = V_FMA(V_SET1(a0[k]), b_k, acc0);
+                    acc1 = V_FMA(V_SET1(a1[k]), b_k, acc1);
+                    acc2 = V_FMA(V_SET1(a2[k]), b_k, acc2);
+                    acc3 = V_FMA(V_SET1(a3[k]), b_k, acc3);
+                }
+                V_STOREU(r0 + j, acc0);
+                V_STOREU(r0 + ldr + j, acc1);
+                V_STOREU(r0 + 2*(size_t)ldr + j, acc2);
+                V_STOREU(r0 + 3*(size_t)ldr + j, acc3);
+            }
+            else {
+                // Remaining columns with masked loads and stores
+                for (k = 0; k < n; k++) {
+                    VEC b_k = V_LOAD_TAIL(b + (size_t)k * ldb + j, tail);
+                    acc0 = V_FMA(V_SET1(a0[k]), b_k, acc0);
+                    acc1 = V_FMA(V_SET1(a1[k]), b_k, acc1);
+                    acc2 = V_FMA(V_SET1(a2[k]), b_k, acc2);
+                    acc3 = V_FMA(V_SET1(a3[k]), b_k, acc3);
+                }
+                V_STORE_TAIL(r0 + j, acc0, tail);
+                V_STORE_TAIL(r0 + ldr + j, acc1, tail);
+                V_STORE_TAIL(r0 + 2*(size_t)ldr + j, acc2, tail);
+                V_STORE_TAIL(r0 + 3*(size_t)ldr + j, acc3, tail);
+            }
+        }
+    }
+
+    // Remaining rows one at a time
+    for (; i < m; i++)
+        SIMD_FN(mat_mul)(a + (size_t)i * lda, b, ldb, result + (size_t)i * ldr, n, p);
+}
+
+static void SIMD_FN(mat_mul_nt)(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* result, int ldr, int m, int n, int p) {
+    // result (m x p) = a (m x n) * transpose(b (p x n)), all row-major with their own row strides
+    // Every result is the dot product of a row of a and a row of b, both contiguous, reduced once
+    // Four rows of a are computed together so every load of b is used four times
+    int i = 0, j, k;
+    for (; i + 4 <= m; i += 4) {
+        mlp_real* a0 = a + (size_t)i * lda;
+        mlp_real* a1 = a0 + lda;
+        mlp_real* a2 = a1 + lda;
+        mlp_real* a3 = a2 + lda;
+        mlp_real* r0 = result + (size_t)i * ldr;
+        for (j = 0; j < p; j++) {
+            mlp_real* b_row = b + (size_t)j * ldb;
+            VEC acc0 = V_ZERO(), acc1 = V_ZERO(), acc2 = V_ZERO(), acc3 = V_ZERO();
+            for (k = 0; k + W <= n; k += W) {
+                VEC b_k = V_LOADU(b_row + k);
+                acc0 = V_FMA(V_LOADU(a0 + k), b_k, acc0);
+                acc1 = V_FMA(V_LOADU(a1 + k), b_k, acc1);
+                acc2 = V_FMA(V_LOADU(a2 + k), b_k, acc2);
+                acc3 = V_FMA(V_LOADU(a3 + k), b_k, acc3);
+            }
+            // Remaining products with masked loads, the other lanes add 0
+            if (k < n) {
+                int tail = n - k;
+                VEC b_k = V_LOAD_TAIL(b_row + k, tail);
+                acc0 = V_FMA(V_LOAD_TAIL(a0 + k, tail), b_k, acc0);
+                acc1 = V_FMA(V_LOAD_TAIL(a1 + k, tail), b_k, acc1);
+                acc2 = V_FMA(V_LOAD_TAIL(a2 + k, tail), b_k, acc2);
+                acc3 = V_FMA(V_LOAD_TAIL(a3 + k, tail), b_k, acc3);
+            }
+            r0[j] = V_REDUCE_ADD(acc0);
+            r0[ldr + j] = V_REDUCE_ADD(acc1);
+            r0[2*(size_t)ldr + j] = V_REDUCE_ADD(acc2);
+            r0[3*(size_t)ldr + j] = V_REDUCE_ADD(acc3);
+        }
+    }
+
+    // Remaining rows one at a time
+    for (; i < m; i++) {
+        mlp_real* a_row = a + (size_t)i * lda;
+        for (j = 0; j < p; j++) {
+            mlp_real* b_row = b + (size_t)j * ldb;
+            VEC acc = V_ZERO();
+            for (k = 0; k + W <= n; k += W)
+                acc = V_FMA(V_LOADU(a_row + k), V_LOADU(b_row + k), acc);
+            if (k < n)
+                acc = V_FMA(V_LOAD_TAIL(a_row + k, n - k), V_LOAD_TAIL(b_row + k, n - k), acc);
+            result[(size_t)i * ldr + j] = V_REDUCE_ADD(acc);
+        }
+    }
+}
+
+static void SIMD_FN(mat_mul_tn)(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* result, int ldr, int m, int n, int p) {
+    // result (n x p) = transpose(a (m x n)) * b (m x p), all row-major with their own row strides
+    // mat_mul_batch on the transpose of a: four rows of the result, four columns of a, are summed over the
+    // m samples in registers, so every load of b is used four times and every result is stored once
+    int i, j, k = 0;
+    for (; k + 4 <= n; k += 4) {
+        mlp_real* r0 = result + (size_t)k * ldr;
+        for (j = 0; j < p; j += W) {
+            int tail = p - j;
+            VEC acc0 = V_ZERO(), acc1 = V_ZERO(), acc2 = V_ZERO(), acc3 = V_ZERO();
+            if (tail >= W) {
+                for (i = 0; i < m; i++) {
+                    mlp_real* a_i = a + (size_t)i * lda + k;
+                    VEC b_i = V_LOADU(b + (size_t)i * ldb + j);
+                    acc0 = V_FMA(V_SET1(a_i[0]), b_i, acc0);
+                    acc1 = V_FMA(V_SET1(a_i[1]), b_i, acc1);
+                    acc2 = V_FMA(V_SET1(a_i[2]), b_i, acc2);
+                    acc3 = V_FMA(V_SET1(a_i[3]), b_i, acc3);
+                }
+                V_STOREU(r0 + j, acc0);
+                V_STOREU(r0 + ldr + j, acc1);
+                V_STOREU(r0 + 2*(size_t)ldr + j, acc2);
+                V_STOREU(r0 + 3*(size_t)ldr + j, acc3);
+            }
+            else {
+                // Remaining columns with masked loads and stores
+                for (i = 0; i < m; i++) {
+                    mlp_real* a_i = a + (size_t)i * lda + k;
+                    VEC b_i = V_LOAD_TAIL(b + (size_t)i * ldb + j, tail);
+                    acc0 = V_FMA(V_SET1(a_i[0]), b_i, acc0);
+                    acc1 = V_FMA(V_SET1(a_i[1]), b_i, acc1);
+                    acc2 = V_FMA(V_SET1(a_i[2]), b_i, acc2);
+                    acc3 = V_FMA(V_SET1(a_i[3]), b_i, acc3);
+                }
+                V_STORE_TAIL(r0 + j, acc0, tail);
+                V_STORE_TAIL(r0 + ldr + j, acc1, tail);
+                V_STORE_TAIL(r0 + 2*(size_t)ldr + j, acc2, tail);
+                V_STORE_TAIL(r0 + 3*(size_t)ldr + j, acc3, tail);
+            }
+        }
+    }
+
+    // Remaining rows of the result one at a time
+    for (; k < n; k++) {
+        mlp_real* result_row = result + (size_t)k * ldr;
+        for (j = 0; j < p; j += W) {
+            int tail = p - j;
+            VEC acc = V_ZERO();
+            if (tail >= W) {
+                for (i = 0; i < m; i++)
+                    acc = V_FMA(V_SET1(a[(size_t)i * lda + k]), V_LOADU(b + (size_t)i * ldb + j), acc);
+                V_STOREU(result_row + j, acc);
+            }
+            else {
+                for (i = 0; i < m; i++)
+                    acc = V_FMA(V_SET1(a[(size_t)i * lda + k]), V_LOAD_TAIL(b + (size_t)i * ldb + j, tail), acc);
+                V_STORE_TAIL(result_row + j, acc, tail);
+            }
+        }
+    }
+}
+
+// Element-wise activation: output[0] is the bias term, output[i+1] = f(input[i], terms)
+#define SIMD_ACTIVATION(name, f, terms) \
+static void SIMD_FN(name)(int n, mlp_real* input, mlp_real* output) { \
+    output[0] = 1; \
+    int i = 0; \
+    for (; i + W <= n; i += W) \
+        V_STOREU(output + 1 + i, f(V_LOADU(input + i), terms)); \
+    if (i < n) \
+        V_STORE_TAIL(output + 1 + i, f(V_LOAD_TAIL(input + i, n - i), terms), n - i); \
+}
+
+SIMD_ACTIVATION(identity, SIMD_FN(identity_v), 0)
+SIMD_ACTIVATION(relu, SIMD_FN(relu_v), 0)
+SIMD_ACTIVATION(sigmoid, SIMD_FN(sigmoid_v), EXP_TERMS)
+SIMD_ACTIVATION(sigmoid_fast, SIMD_FN(sigmoid_v), EXP_TERMS_FAST)
+SIMD_ACTIVATION(sigmoid_fastest, SIMD_FN(sigmoid_v), EXP_TERMS_FASTEST)
+SIMD_ACTIVATION(tan_h, SIMD_FN(tanh_v), EXP_TERMS)
+SIMD_ACTIVATION(tan_h_fast, SIMD_FN(tanh_v), EXP_TERMS_FAST)
+SIMD_ACTIVATION(tan_h_fastest, SIMD_FN(tanh_v), EXP_TERMS_FASTEST)
+
+#undef SIMD_ACTIVATION
+
+// Softmax shifted by the largest input so no exponential overflows
+// Each exponential is computed once, stored and summed
+static inline void SIMD_FN(softmax_terms)(int n, mlp_real* input, mlp_real* output, const int terms) {
+    output[0] = 1;
+    int i = 0;
+    VEC largest_v = V_SET1(input[0]);
+    for (; i + W <= n; i += W)
+        largest_v = V_MAX(largest_v, V_LOADU(input + i));
+    mlp_real largest = V_REDUCE_MAX(largest_v);
+    for (; i < n; i++)
+        largest = largest > input[i] ? largest : input[i];
+    VEC shift = V_SET1(largest);
+    VEC sum = V_ZERO();
+    for (i = 0; i + W <= n; i += W) {
+        VEC e = SIMD_FN(exp_v)(V_SUB(V_LOADU(input + i), shift), terms);
+        V_STOREU(output + 1 + i, e);
+        sum = V_ADD(sum, e);
+    }
+    if (i < n) {
+        V_STORE_TAIL(output + 1 + i, SIMD_FN(exp_v)(V_SUB(V_LOAD_TAIL(input + i, n - i), shift), terms), n - i);
+        sum = V_ADD(sum, V_LOAD_TAIL(output + 1 + i, n - i));
+    }
+    VEC total = V_SET1(V_REDUCE_ADD(sum));
+    for (i = 0; i + W <= n; i += W)
+        V_STOREU(output + 1 + i, V_DIV(V_LOADU(output + 1 + i), total));
+    if (i < n)
+        V_STORE_TAIL(output + 1 + i, V_DIV(V_LOAD_TAIL(output + 1 + i, n - i), total), n - i);
+}
+
+#define SIMD_SOFTMAX(name, terms) \
+static void SIMD_FN(name)(int n, mlp_real* input, mlp_real* output) { \
+    SIMD_FN(softmax_terms)(n, input, output, terms); \
+}
+
+SIMD_SOFTMAX(softmax, EXP_TERMS)
+SIMD_SOFTMAX(softmax_fast, EXP_TERMS_FAST)
+SIMD_SOFTMAX(softmax_fastest, EXP_TERMS_FASTEST)
+
+#undef SIMD_SOFTMAX
+
+/* Dense layers: mat_mul_batch with the activation in its epilogue. The dense kernels below pass
+   activation (1 to 5, as in parameters) and terms as constants, so after inlining each one holds
+   only the code of its own activation. Softmax needs a whole row and is applied once it is stored */
+
+static inline __attribute__((always_inline)) VEC SIMD_FN(activate_v)(VEC x, const int activation, const int terms) {
+    switch (activation) {
+        case 2:
+            return SIMD_FN(sigmoid_v)(x, terms);
+        case 3:
+            return SIMD_FN(tanh_v)(x, terms);
+        case 4:
+            return SIMD_FN(relu_v)(x, terms);
+        default: // identity, and softmax until the row is complete
+            return x;
+    }
+}
+
+static inline __attribute__((always_inline)) void SIMD_FN(dense_row)(mlp_real* a, mlp_real* b, int ldb, mlp_real* output,
+    int n, int p, const int activation, const int terms) {
+    // output (1 x (p+1)) = [1, f(a (1 x n) * b (n x p))], the column blocks of mat_mul
+    mlp_real* result = output + 1;
+    int j = 0, k;
+    for (; j + 4*W <= p; j += 4*W) {
+        VEC acc0 = V_ZERO(), acc1 = V_ZERO(), acc2 = V_ZERO(), acc3 = V_ZERO();
+        for (k = 0; k < n; k++) {
+            VEC a_k = V_SET1(a[k]);
+            mlp_real* b_row = b + (size_t)k * ldb + j;
+            acc0 = V_FMA(a_k, V_LOADU(b_row), acc0);
+            acc1 = V_FMA(a_k, V_LOADU(b_row + W), acc1);
+            acc2 = V_FMA(a_k, V_LOADU(b_row + 2*W), acc2);
+            acc3 = V_FMA(a_k, V_LOADU(b_row + 3*W), acc3);
+        }
+        V_STOREU(result + j, SIMD_FN(activate_v)(acc0, activation, terms));
+        V_STOREU(result + j + W, SIMD_FN(activate_v)(acc1, activation, terms));
+        V_STOREU(result + j + 2*W, SIMD_FN(activate_v)(acc2, activation, terms));
+        V_STOREU(result + j + 3*W, SIMD_FN(activate_v)(acc3, activation, terms));
+    }
+
+    for (; j + W <= p; j += W) {
+        VEC acc = V_ZERO();
+        for (k = 0; k < n; k++)
+            acc = V_FMA(V_SET1(a[k]), V_LOADU(b + (size_t)k * ldb + j), acc);
+        V_STOREU(result + j, SIMD_FN(activate_v)(acc, activation, terms));
+    }
+
+    if (j < p) {
+        int tail = p - j;
+        VEC acc = V_ZERO();
+        for (k = 0; k < n; k++)
+            acc = V_FMA(V_SET1(a[k]), V_LOAD_TAIL(b + (size_t)k * ldb + j, tail), acc);
+        V_STORE_TAIL(result + j, SIMD_FN(activate_v)(acc, activation, terms), tail);
+    }
+
+    if (activation == 5)
+        SIMD_FN(softmax_terms)(p, result, output, terms);
+    else
+        output[0] = 1; // Bias term
+}
+
+static inline __attribute__((always_inline)) void SIMD_FN(dense_batch)(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* output, int ldo,
+    int m, int n, int p, const int activation, const int terms) {
+    // Rows of four samples as in mat_mul_batch, each output row after its bias column
+    int i = 0, j, k;
+    for (; i + 4 <= m; i += 4) {
+        mlp_real* a0 = a + (size_t)i * lda;
+        mlp_real* a1 = a0 + lda;
+        mlp_real* a2 = a1 + lda;
+        mlp_real* a3 = a2 + lda;
+        mlp_real* r0 = output + (size_t)i * ldo + 1;
+        for (j = 0; j < p; j += W) {
+            int tail = p - j;
+            VEC acc0 = V_ZERO(), acc1 = V_ZERO(), acc2 = V_ZERO(), acc3 = V_ZERO();
+            if (tail >= W) {
+                for (k = 0; k < n; k++) {
+                    VEC b_k = V_LOADU(b + (size_t)k * ldb + j);
+                    acc0 = V_FMA(V_SET1(a0[k]), b_k, acc0);
+                    acc1 = V_FMA(V_SET1(a1[k]), b_k, acc1);
+                    acc2 = V_FMA(V_SET1(a2[k]), b_k, acc2);
+                    acc3 = V_FMA(V_SET1(a3[k]), b_k, acc3);
+                }
+                V_STOREU(r0 + j, SIMD_FN(activate_v)(acc0, activation, terms));
+                V_STOREU(r0 + ldo + j, SIMD_FN(activate_v)(acc1, activation, terms));
+                V_STOREU(r0 + 2*(size_t)ldo + j, SIMD_FN(activate_v)(acc2, activation, terms));
+                V_STOREU(r0 + 3*(size_t)ldo + j, SIMD_FN(activate_v)(acc3, activation, terms));
+            }
+            else {
+                for (k = 0; k < n; k++) {
+                    VEC b_k = V_LOAD_TAIL(b + (size_t)k * ldb + j, tail);
+                    acc0 = V_FMA(V_SET1(a0[k]), b_k, acc0);
+                    acc1 = V_FMA(V_SET1(a1[k]), b_k, acc1);
+                    acc2 = V_FMA(V_SET1(a2[k]), b_k, acc2);
+                    acc3 = V_FMA(V_SET1(a3[k]), b_k, acc3);
+                }
+                V_STORE_TAIL(r0 + j, SIMD_FN(activate_v)(acc0, activation, terms), tail);
+                V_STORE_TAIL(r0 + ldo + j, SIMD_FN(activate_v)(acc1, activation, terms), tail);
+                V_STORE_TAIL(r0 + 2*(size_t)ldo + j, SIMD_FN(activate_v)(acc2, activation, terms), tail);
+                V_STORE_TAIL(r0 + 3*(size_t)ldo + j, SIMD_FN(activate_v)(acc3, activation, terms), tail);
+            }
+        }
+
+        for (k = 0; k < 4; k++) {
+            mlp_real* row = output + (size_t)(i + k) * ldo;
+            if (activation == 5)
+                SIMD_FN(softmax_terms)(p, row + 1, row, terms);
+            else
+                row[0] = 1; // Bias term
+        }
+    }
+
+    // Remaining rows one at a time
+    for (; i < m; i++)
+        SIMD_FN(dense_row)(a + (size_t)i * lda, b, ldb, output + (size_t)i * ldo, n, p, activation, terms);
+}
+
+#define SIMD_DENSE(name, activation, terms) \
+static void SIMD_FN(name)(mlp_real* a, int lda, mlp_real* b, int ldb, mlp_real* output, int ldo, int m, int n, int p) { \
+    SIMD_FN(dense_batch)(a, lda, b, ldb, output, ldo, m, n, p, activation, terms); \
+}
+
+SIMD_DENSE(dense_identity, 1, 0)
+SIMD_DENSE(dense_sigmoid, 2, EXP_TERMS)
+SIMD_DENSE(dense_sigmoid_fast, 2, EXP_TERMS_FAST)
+SIMD_DENSE(dense_sigmoid_fastest, 2, EXP_TERMS_FASTEST)
+SIMD_DENSE(dense_tan_h, 3, EXP_TERMS)
+SIMD_DENSE(dense_tan_h_fast, 3, EXP_TERMS_FAST)
+SIMD_DENSE(dense_tan_h_fastest, 3, EXP_TERMS_FASTEST)
+SIMD_DENSE(dense_relu, 4, 0)
+SIMD_DENSE(dense_softmax, 5, EXP_TERMS)
+SIMD_DENSE(dense_softmax_fast, 5, EXP_TERMS_FAST)
+SIMD_DENSE(dense_softmax_fastest, 5, EXP_TERMS_FASTEST)
+
+#undef SIMD_DENSE
+
+// Coefficients of an update_step broadcast to every lane
+typedef struct {
+    VEC rate, scale, step, momentum, decay, epsilon;
+    VEC momentum_rest, decay_rest; // 1 - momentum and 1 - decay
+} SIMD_FN(update_coefficients);
+
+// New weights of the lanes of w, with v and s the velocity and squared-gradient average of the same lanes,
+// computed as in the scalar kernels
+static inline __attribute__((always_inline)) VEC SIMD_FN(update_v)(VEC w, VEC gradient, VEC* v, VEC* s,
+    const SIMD_FN(update_coefficients)* k, const int optimizer) {
+    VEC g;
+    switch (optimizer) {
+        case OPTIMIZER_MOMENTUM:
+            *v = V_ADD(V_MUL(k->momentum, *v), V_MUL(k->rate, gradient));
+            return V_SUB(w, *v);
+        case OPTIMIZER_NESTEROV:
+            g = V_MUL(k->rate, gradient);
+            *v = V_ADD(V_MUL(k->momentum, *v), g);
+            return V_SUB(w, V_ADD(V_MUL(k->momentum, *v), g));
+        case OPTIMIZER_RMSPROP:
+            g = V_MUL(k->scale, gradient);
+            *s = V_ADD(V_MUL(k->decay, *s), V_MUL(V_MUL(k->decay_rest, g), g));
+            return V_SUB(w, V_DIV(V_MUL(k->step, g), V_ADD(V_SQRT(*s), k->epsilon)));
+        case OPTIMIZER_ADAM:
+            g = V_MUL(k->scale, gradient);
+            *v = V_ADD(V_MUL(k->momentum, *v), V_MUL(k->momentum_rest, g));
+            *s = V_ADD(V_MUL(k->decay, *s), V_MUL(V_MUL(k->decay_rest, g), g));
+            return V_SUB(w, V_DIV(V_MUL(k->step, *v), V_ADD(V_SQRT(*s), k->epsilon)));
+        default: // OPTIMIZER_SGD
+            return V_SUB(w, V_MUL(k->rate, gradient));
+    }
+}
+
+// One pass over the weights, their gradient and the state of the optimizer, each read and written once
+static inline __attribute__((always_inline)) void SIMD_FN(update_batch)(size_t n, mlp_real* weight, const mlp_real* gradient,
+    mlp_real* velocity, mlp_real* square, const update_step* c, const int optimizer) {
+    const int has_velocity = optimizer == OPTIMIZER_MOMENTUM || optimizer == OPTIMIZER_NESTEROV || optimizer == OPTIMIZER_ADAM;
+    const int has_square = optimizer == OPTIMIZER_RMSPROP || optimizer == OPTIMIZER_ADAM;
+    SIMD_FN(update_coefficients) k = {
+        V_SET1(c->rate), V_SET1(c->scale), V_SET1(c->step), V_SET1(c->momentum), V_SET1(c->decay), V_SET1(c->epsilon),
+        V_SET1(1 - c->momentum), V_SET1(1 - c->decay)
+    };
+    VEC v = V_ZERO(), s = V_ZERO();
+
+    size_t i;
+    for (i = 0; i + W <= n; i += W) {
+        if (has_velocity)
+            v = V_LOADU(velocity + i);
+        if (has_square)
+            s = V_LOADU(square + i);
+        V_STOREU(weight + i, SIMD_FN(update_v)(V_LOADU(weight + i), V_LOADU(gradient + i), &v, &s, &k, optimizer));
+        if (has_velocity)
+            V_STOREU(velocity + i, v);
+        if (has_square)
+            V_STOREU(square + i, s);
+    }
+
+    // The ranges of data-parallel threads end anywhere, the last partial vector is masked
+    if (i < n) {
+        int tail = (int)(n - i);
+        if (has_velocity)
+            v = V_LOAD_TAIL(velocity + i, tail);
+        if (has_square)
+            s = V_LOAD_TAIL(square + i, tail);
+        V_STORE_TAIL(weight + i, SIMD_FN(update_v)(V_LOAD_TAIL(weight + i, tail), V_LOAD_TAIL(gradient + i, tail), &v, &s, &k, optimizer), tail);
+        if (has_velocity)
+            V_STORE_TAIL(velocity + i, v, tail);
+        if (has_square)
+            V_STORE_TAIL(square + i, s, tail);
+    }
+}
+
+#define SIMD_UPDATE(name, optimizer) \
+static void SIMD_FN(name)(size_t n, mlp_real* weight, const mlp_real* gradient, mlp_real* velocity, mlp_real* square, const update_step* c) { \
+    SIMD_FN(update_batch)(n, weight, gradient, velocity, square, c, optimizer); \
+}
+
+SIMD_UPDATE(sgd, OPTIMIZER_SGD)
+SIMD_UPDATE(momentum, OPTIMIZER_MOMENTUM)
+SIMD_UPDATE(nesterov, OPTIMIZER_NESTEROV)
+SIMD_UPDATE(rmsprop, OPTIMIZER_RMSPROP)
+SIMD_UPDATE(adam, OPTIMIZER_ADAM)
+
+#undef SIMD_UPDATE
+
+static const simd_kernels SIMD_FN(kernels) = {
+    SIMD_NAME,
+    SIMD_FN(mat_mul),
+    SIMD_FN(mat_mul_batch),
+    SIMD_FN(mat_mul_nt),
+    SIMD_FN(mat_mul_tn),
+    SIMD_FN(identity),
+    { SIMD_FN(sigmoid), SIMD_FN(sigmoid_fast), SIMD_FN(sigmoid_fastest) },
+    { SIMD_FN(tan_h), SIMD_FN(tan_h_fast), SIMD_FN(tan_h_fastest) },
+    SIMD_FN(relu),
+    { SIMD_FN(softmax), SIMD_FN(softmax_fast), SIMD_FN(softmax_fastest) },
+    SIMD_FN(dense_identity),
+    { SIMD_FN(dense_sigmoid), SIMD_FN(dense_sigmoid_fast), SIMD_FN(dense_sigmoid_fastest) },
+    { SIMD_FN(dense_tan_h), SIMD_FN(dense_tan_h_fast), SIMD_FN(dense_tan_h_fastest) },
+    SIMD_FN(dense_relu),
+    { SIMD_FN(dense_softmax), SIMD_FN(dense_softmax_fast), SIMD_FN(dense_softmax_fastest) },
+    { SIMD_FN(sgd), SIMD_FN(momentum), SIMD_FN(nesterov), SIMD_FN(rmsprop), SIMD_FN(adam) }
+};
@@ -0,0 +1,310 @@
+/*
+Desc: Tests of the SIMD kernels of the level selected by MLP_SIMD against the scalar kernels, on sizes
+      that leave a partial vector in every loop
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include <float.h>
+#include "mlp_alloc.h"
+#include "simd_kernels.h"
+
+#define TEST_SEED 7
+
+// Written past the end of every output row, a kernel storing outside its row changes it
+#define TEST_PAD 5
+#define TEST_SENTINEL ((mlp_real)-7777)
+
+#ifdef MLP_FLOAT
+#define TEST_EPSILON FLT_EPSILON
+#else
+#define TEST_EPSILON DBL_EPSILON
+#endif
+
+// Rows, inner dimensions and columns: 4-row blocks with 1 to 3 rows left, and columns with 1 to W-1
+// left after the 4W-column blocks and single vectors of every level, in float and double
+static const int test_m[] = { 1, 3, 6, 9 };
+static const int test_n[] = { 1, 5, 17 };
+static const int test_p[] = { 1, 3, 7, 13, 29, 67 };
+#define TEST_SIZES(sizes) (int)(sizeof(sizes) / sizeof(sizes[0]))
+
+// Inputs of the element-wise activations are drawn from [-TEST_RANGE, TEST_RANGE]
+#define TEST_RANGE 16
+
+// Largest difference of every accuracy tier from the scalar ACTIVATION_EXACT kernels, on any level:
+// twice the larger error against libm listed in simd_kernels.h, relative for sigmoid and softmax and
+// absolute for tanh. A dense layer may also differ by the rounding of its products
+static const char* tier_names[ACTIVATION_TIERS] = { "exact", "fast", "fastest" };
+#ifdef MLP_FLOAT
+static const double tier_bound[ACTIVATION_TIERS] = { 3.4e-7, 6.6e-6, 1.12e-4 };
+#else
+static const double tier_bound[ACTIVATION_TIERS] = { 6e-16, 1.42e-8, 1.12e-4 };
+#endif
+
+static int failures = 0;
+
+static void check(int ok, const char* name, const char* what) {
+    printf("%s: %s %s\n", ok ? "PASS" : "FAIL", name, what);
+    failures += !ok;
+}
+
+static void fill_random(mlp_real* v, int n) {
+    int i;
+    for (i = 0; i < n; i++)
+        v[i] = (mlp_real)(2.0 * rand() / RAND_MAX - 1);
+}
+
+static void fill_sentinel(mlp_real* v, int n) {
+    int i;
+    for (i = 0; i < n; i++)
+        v[i] = TEST_SENTINEL;
+}
+
+// Rounding error allowed between two sums of the n products x[k * incx] * y[k * incy], taken in any order
+// and with or without FMA: n units of the last place of the sum of their magnitudes
+static double strided_allowance(const mlp_real* x, int incx, const mlp_real* y, int incy, int n) {
+    double magnitude = 0;
+    int k;
+    for (k = 0; k < n; k++)
+        magnitude += fabs((double)x[(size_t)k * incx] * y[(size_t)k * incy]);
+    return n * TEST_EPSILON * magnitude;
+}
+
+// Allowance of the product of a row of a and column j of b
+static double product_allowance(const mlp_real* a, const mlp_real* b, int ldb, int n, int j) {
+    return strided_allowance(a, 1, b + j, ldb, n);
+}
+
+// Relative rounding error allowed between two sums of p positive terms taken in any order, the
+// normalization of softmax, which the errors of the tiers were not measured on so wide a layer
+static double sum_allowance(int p) {
+    return p * TEST_EPSILON;
+}
+
+// Difference of an activation from the expected value, relative except for tanh
+static double activation_error(mlp_real value, mlp_real expected, int relative) {
+    double error = fabs((double)value - expected);
+    return relative ? error / fabs((double)expected) : error;
+}
+
+// result (m x p, row stride ldr) of the kernel under test against the scalar one, and the padding of every row
+// Result (i, j) sums the n products a[i * a_row + k * a_step] * b[j * b_column + k * b_step]
+static int strided_products_match(const mlp_real* a, int a_row, int a_step, const mlp_real* b, int b_column, int b_step,
+    const mlp_real* result, const mlp_real* expected, int ldr, int m, int n, int p, int first_column) {
+    int i, j;
+    for (i = 0; i < m; i++) {
+        const mlp_real* row = result + (size_t)i * ldr;
+        const mlp_real* expected_row = expected + (size_t)i * ldr;
+        for (j = 0; j < p; j++)
+            if (fabs((double)row[first_column + j] - expected_row[first_column + j]) >
+                strided_allowance(a + (size_t)i * a_row, a_step, b + (size_t)j * b_column, b_step, n))
+                return 0;
+        for (j = first_column + p; j < ldr; j++)
+            if (row[j] != TEST_SENTINEL)
+                return 0;
+    }
+    return 1;
+}
+
+// result = a (m x n) * b (n x p)
+static int products_match(const mlp_real* a, int lda, const mlp_real* b, int ldb, const mlp_real* result,
+    const mlp_real* expected, int ldr, int m, int n, int p, int first_column) {
+    return strided_products_match(a, lda, 1, b, 1, ldb, result, expected, ldr, m, n, p, first_column);
+}
+
+int main(void) {
+    // The level capped by MLP_SIMD, compared with the scalar reference
+    simd_init();
+    const simd_kernels* tested = simd;
+    simd_select(SIMD_SCALAR);
+    const simd_kernels* scalar = simd;
+    printf("Kernels: %s, %s\n", tested->name, MLP_REAL_NAME);
+    srand(TEST_SEED);
+
+    int max_m = test_m[TEST_SIZES(test_m) - 1];
+    int max_n = test_n[TEST_SIZES(test_n) - 1];
+    int max_p = test_p[TEST_SIZES(test_p) - 1];
+    int ld = max_p + 1 + TEST_PAD;
+    mlp_real* a = (mlp_real*)mlp_calloc((size_t)max_m * ld, sizeof(mlp_real));
+    // b holds up to p rows of n for mat_mul_nt, the result up to n rows for mat_mul_tn
+    mlp_real* b = (mlp_real*)mlp_calloc((size_t)max_p * ld, sizeof(mlp_real));
+    int max_rows = max_m > max_n ? max_m : max_n;
+    mlp_real* result = (mlp_real*)mlp_calloc((size_t)max_rows * ld, sizeof(mlp_real));
+    mlp_real* expected = (mlp_real*)mlp_calloc((size_t)max_rows * ld, sizeof(mlp_real));
+
+    int mi, ni, pi, i, j;
+    int mat_mul_ok = 1, batch_ok = 1, nt_ok = 1, tn_ok = 1, dense_ok = 1, activation_ok = 1;
+    for (ni = 0; ni < TEST_SIZES(test_n); ni++) {
+        for (pi = 0; pi < TEST_SIZES(test_p); pi++) {
+            int n = test_n[ni], p = test_p[pi];
+            // Row strides wider than the rows, as in the weight arena
+            int lda = n + 2, ldb = p + 3, ldr = p + 1 + TEST_PAD;
+            fill_random(a, max_m * lda);
+            fill_random(b, n * ldb);
+
+            // One sample times a matrix
+            fill_sentinel(result, ldr);
+            fill_sentinel(expected, ldr);
+            tested->mat_mul(a, b, ldb, result, n, p);
+            scalar->mat_mul(a, b, ldb, expected, n, p);
+            mat_mul_ok &= products_match(a, lda, b, ldb, result, expected, ldr, 1, n, p, 0);
+
+            for (mi = 0; mi < TEST_SIZES(test_m); mi++) {
+                int m = test_m[mi];
+
+                // A batch of samples times a matrix
+                fill_sentinel(result, m * ldr);
+                fill_sentinel(expected, m * ldr);
+                tested->mat_mul_batch(a, lda, b, ldb, result, ldr, m, n, p);
+                scalar->mat_mul_batch(a, lda, b, ldb, expected, ldr, m, n, p);
+                batch_ok &= products_match(a, lda, b, ldb, result, expected, ldr, m, n, p, 0);
+
+                // Dense layers with the activations that are exact on every level, after their bias column
+                fill_sentinel(result, m * ldr);
+                fill_sentinel(expected, m * ldr);
+                tested->dense_identity(a, lda, b, ldb, result, ldr, m, n, p);
+                scalar->dense_identity(a, lda, b, ldb, expected, ldr, m, n, p);
+                dense_ok &= products_match(a, lda, b, ldb, result, expected, ldr, m, n, p, 1);
+                for (i = 0; i < m; i++)
+                    dense_ok &= result[(size_t)i * ldr] == 1;
+
+                fill_sentinel(result, m * ldr);
+                fill_sentinel(expected, m * ldr);
+                tested->dense_relu(a, lda, b, ldb, result, ldr, m, n, p);
+                scalar->dense_relu(a, lda, b, ldb, expected, ldr, m, n, p);
+                dense_ok &= products_match(a, lda, b, ldb, result, expected, ldr, m, n, p, 1);
+                for (i = 0; i < m; i++)
+                    dense_ok &= result[(size_t)i * ldr] == 1;
+            }
+        }
+    }
+
+    // The products of batch back propagation: a (m x n) times the transpose of b (p x n), the errors of a
+    // hidden layer, and the transpose of a (m x n) times b (m x p), the weight gradients summed over m samples
+    for (ni = 0; ni < TEST_SIZES(test_n); ni++) {
+        for (pi = 0; pi < TEST_SIZES(test_p); pi++) {
+            for (mi = 0; mi < TEST_SIZES(test_m); mi++) {
+                int m = test_m[mi], n = test_n[ni], p = test_p[pi];
+                int lda = n + 2, ldr = p + 1 + TEST_PAD;
+
+                int ldb = n + 3;
+                fill_random(a, m * lda);
+                fill_random(b, p * ldb);
+                fill_sentinel(result, m * ldr);
+                fill_sentinel(expected, m * ldr);
+                tested->mat_mul_nt(a, lda, b, ldb, result, ldr, m, n, p);
+                scalar->mat_mul_nt(a, lda, b, ldb, expected, ldr, m, n, p);
+                nt_ok &= strided_products_match(a, lda, 1, b, ldb, 1, result, expected, ldr, m, n, p, 0);
+
+                ldb = p + 3;
+                fill_random(b, m * ldb);
+                fill_sentinel(result, n * ldr);
+                fill_sentinel(expected, n * ldr);
+                tested->mat_mul_tn(a, lda, b, ldb, result, ldr, m, n, p);
+                scalar->mat_mul_tn(a, lda, b, ldb, expected, ldr, m, n, p);
+                tn_ok &= strided_products_match(a, 1, lda, b, 1, ldb, result, expected, ldr, n, m, p, 0);
+            }
+        }
+    }
+
+    // Element-wise identity and relu give the same values on every level
+    for (pi = 0; pi < TEST_SIZES(test_p); pi++) {
+        int p = test_p[pi];
+        fill_random(a, p);
+        fill_sentinel(result, p + 1 + TEST_PAD);
+        tested->identity(p, a, result);
+        for (j = 0; j < p; j++)
+            activation_ok &= result[j+1] == a[j];
+        fill_sentinel(result, p + 1 + TEST_PAD);
+        tested->relu(p, a, result);
+        for (j = 0; j < p; j++)
+            activation_ok &= result[j+1] == (a[j] > 0 ? a[j] : 0);
+        activation_ok &= result[0] == 1;
+        for (j = p + 1; j < p + 1 + TEST_PAD; j++)
+            activation_ok &= result[j] == TEST_SENTINEL;
+    }
+
+    check(mat_mul_ok, tested->name, "mat_mul matches the scalar kernel within rounding and stores no column past p");
+    check(batch_ok, tested->name, "mat_mul_batch matches the scalar kernel within rounding and stores no column past p");
+    check(nt_ok, tested->name, "mat_mul_nt matches the scalar kernel within rounding and stores no column past p");
+    check(tn_ok, tested->name, "mat_mul_tn matches the scalar kernel within rounding and stores no column past p");
+    check(dense_ok, tested->name, "dense identity and relu match the scalar kernels and write the bias column");
+    check(activation_ok, tested->name, "identity and relu match the scalar kernels and store no value past n");
+
+    // Every tier of sigmoid, tanh and softmax against scalar ACTIVATION_EXACT, element-wise and fused
+    // into dense layers, with their bias column and nothing stored past their rows
+    int tier, f;
+    for (tier = 0; tier < ACTIVATION_TIERS; tier++) {
+        int tier_ok = 1, dense_tier_ok = 1;
+        for (f = 0; f < 3; f++) {
+            activation_kernel kernel = f == 0 ? tested->sigmoid[tier] : f == 1 ? tested->tan_h[tier] : tested->softmax[tier];
+            activation_kernel reference = f == 0 ? scalar->sigmoid[0] : f == 1 ? scalar->tan_h[0] : scalar->softmax[0];
+            dense_kernel dense = f == 0 ? tested->dense_sigmoid[tier] : f == 1 ? tested->dense_tan_h[tier] : tested->dense_softmax[tier];
+            dense_kernel dense_reference = f == 0 ? scalar->dense_sigmoid[0] : f == 1 ? scalar->dense_tan_h[0] : scalar->dense_softmax[0];
+            int relative = f != 1;
+
+            for (pi = 0; pi < TEST_SIZES(test_p); pi++) {
+                int p = test_p[pi];
+                fill_random(a, p);
+                for (j = 0; j < p; j++)
+                    a[j] *= TEST_RANGE;
+                fill_sentinel(result, p + 1 + TEST_PAD);
+                fill_sentinel(expected, p + 1 + TEST_PAD);
+                kernel(p, a, result);
+                reference(p, a, expected);
+                tier_ok &= result[0] == 1;
+                for (j = 0; j < p; j++)
+                    tier_ok &= activation_error(result[j+1], expected[j+1], relative) <= tier_bound[tier] + (f == 2 ? sum_allowance(p) : 0);
+                for (j = p + 1; j < p + 1 + TEST_PAD; j++)
+                    tier_ok &= result[j] == TEST_SENTINEL;
+            }
+
+            for (ni = 0; ni < TEST_SIZES(test_n); ni++) {
+                for (pi = 0; pi < TEST_SIZES(test_p); pi++) {
+                    int n = test_n[ni], p = test_p[pi];
+                    int lda = n + 2, ldb = p + 3, ldr = p + 1 + TEST_PAD;
+                    fill_random(a, max_m * lda);
+                    fill_random(b, n * ldb);
+                    for (mi = 0; mi < TEST_SIZES(test_m); mi++) {
+                        int m = test_m[mi];
+                        fill_sentinel(result, m * ldr);
+                        fill_sentinel(expected, m * ldr);
+                        dense(a, lda, b, ldb, result, ldr, m, n, p);
+                        dense_reference(a, lda, b, ldb, expected, ldr, m, n, p);
+                        for (i = 0; i < m; i++) {
+                            mlp_real* row = result + (size_t)i * ldr;
+                            mlp_real* expected_row = expected + (size_t)i * ldr;
+                            // The derivatives of sigmoid and tanh are at most 1, a shift of the inputs of
+                            // softmax changes it by up to twice as much, relative to its value, on top of the
+                            // rounding of its sum
+                            double largest = 0;
+                            for (j = 0; j < p; j++) {
+                                double allowance = product_allowance(a + (size_t)i * lda, b, ldb, n, j);
+                                largest = allowance > largest ? allowance : largest;
+                            }
+                            dense_tier_ok &= row[0] == 1;
+                            for (j = 0; j < p; j++) {
+                                double allowance = f == 2 ? 2 * largest + sum_allowance(p) : product_allowance(a + (size_t)i * lda, b, ldb, n, j);
+                                dense_tier_ok &= activation_error(row[j+1], expected_row[j+1], relative) <= tier_bound[tier] + allowance;
+                            }
+                            for (j = p + 1; j < ldr; j++)
+                                dense_tier_ok &= row[j] == TEST_SENTINEL;
+                        }
+                    }
+                }
+            }
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s %s", tested->name, tier_names[tier]);
+        check(tier_ok, name, "sigmoid, tanh and softmax stay within the bound of the tier of scalar exact");
+        check(dense_tier_ok, name, "dense sigmoid, tanh and softmax stay within the bound of the tier of scalar exact");
+    }
+
+    mlp_free(expected);
+    mlp_free(result);
+    mlp_free(b);
+    mlp_free(a);
+
+    printf("%d failed\n", failures);
+    return failures > 0;
+}
@@ -37,6 +37,13 @@ void simpleserial_init(void);
 // - The callback function returns a number in [0x00, 0xFF] as a status code;
 //   in protocol v1.1, this status code is returned through a "z" message
 #if SS_VER == SS_VER_2_1
+
+#define CMD_FLAG_NONE	0x00
+// If this flag is set, no status ("e") frame is sent after the callback, which replies itself.
+// Used by the windowed streams of ss_stream.h, whose data frames are acknowledged a window at a time
+#define CMD_FLAG_NOACK	0x02
+
+int simpleserial_addcmd_flags(char c, unsigned int len, uint8_t (*fp)(uint8_t, uint8_t, uint8_t, uint8_t*), uint8_t);
 int simpleserial_addcmd(char c, unsigned int len, uint8_t (*fp)(uint8_t, uint8_t, uint8_t, uint8_t*));
 #else
 
@@ -0,0 +1,694 @@
+/*
+Desc: SimpleSerial 2.1 client measuring the round-trip latency and throughput of a firmware command
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "read_csv.h"
+#include "dataset.h"
+#include "mlp_device.h"
+#include "mlp_quantized.h"
+#include "ss_stream.h"
+
+// Seconds to wait for a reply before the firmware is considered hung
+#define CLIENT_TIMEOUT 10
+
+// Frames of SimpleSerial 2.1 are at most 255 bytes long before stuffing
+#define FRAME_MAX 256
+
+// Same polynomial as simpleserial.c
+#define CW_CRC 0x4D
+
+// Milliseconds without an acknowledgement before the outstanding frames of a stream are sent again
+#define STREAM_RETRY 1000
+
+typedef struct {
+    int rx_fd, tx_fd;
+    pid_t child; // Firmware started by the client, 0 otherwise
+    unsigned char buffer[4096];
+    int length, next;
+    unsigned long bytes_sent, bytes_received;
+} connection;
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// CRC of every byte value, filled once by crc_table_init()
+static uint8_t crc_table[256];
+
+static void crc_table_init(void) {
+    int i, k;
+    for (i = 0; i < 256; i++) {
+        uint8_t crc = (uint8_t)i;
+        for (k = 0; k < 8; k++)
+            crc = crc & 0x80 ? (crc << 1) ^ CW_CRC : crc << 1;
+        crc_table[i] = crc;
+    }
+}
+
+static uint8_t ss_crc(const uint8_t* buf, int len) {
+    uint8_t crc = 0x00;
+    while (len--)
+        crc = crc_table[crc ^ *buf++];
+    return crc;
+}
+
+// Replace every 0x00 of buf[1..len-1] by the distance to the next one, buf[0] points to the first
+static void stuff(uint8_t* buf, int len) {
+    int i, last = 0;
+    for (i = 1; i < len; i++) {
+        if (buf[i] == 0x00) {
+            buf[last] = i - last;
+            last = i;
+        }
+    }
+}
+
+// Undo stuff(), returns 0 when the pointers run off the frame
+static int unstuff(uint8_t* buf, int len) {
+    int next = buf[0];
+    buf[0] = 0x00;
+    while (next < len - 1) {
+        int step = buf[next];
+        buf[next] = 0x00;
+        if (step == 0)
+            return 0;
+        next += step;
+    }
+    return next == len - 1;
+}
+
+/*----------- Transports -------------------*/
+
+// Start the firmware with frames on its stdin and stdout
+static void spawn(connection* c, const char* executable) {
+    int to_child[2], from_child[2];
+    if (pipe(to_child) != 0 || pipe(from_child) != 0) {
+        printf("Error: Cannot create pipes (%s)\n", strerror(errno));
+        exit(0);
+    }
+
+    c->child = fork();
+    if (c->child == 0) {
+        dup2(to_child[0], STDIN_FILENO);
+        dup2(from_child[1], STDOUT_FILENO);
+        close(to_child[0]); close(to_child[1]);
+        close(from_child[0]); close(from_child[1]);
+        setenv("SS_TRANSPORT", "stdio", 1);
+        execl(executable, executable, (char*)NULL);
+        fprintf(stderr, "Error: Cannot run %s (%s)\n", executable, strerror(errno));
+        _exit(1);
+    }
+
+    close(to_child[0]);
+    close(from_child[1]);
+    c->tx_fd = to_child[1];
+    c->rx_fd = from_child[0];
+}
+
+static void connect_unix(connection* c, const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        printf("Error: Cannot connect to %s (%s)\n", path, strerror(errno));
+        exit(0);
+    }
+    c->rx_fd = c->tx_fd = fd;
+}
+
+static void open_tty(connection* c, const char* device) {
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (fd < 0 || tcgetattr(fd, &tio) != 0) {
+        printf("Error: Cannot open %s (%s)\n", device, strerror(errno));
+        exit(0);
+    }
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    c->rx_fd = c->tx_fd = fd;
+}
+
+// Reach the firmware by a unix socket, a pty device or by starting its executable
+static void open_target(connection* c, const char* target) {
+    struct stat st;
+    if (strncmp(target, "unix:", 5) == 0)
+        connect_unix(c, target + 5);
+    else if (stat(target, &st) == 0 && S_ISCHR(st.st_mode))
+        open_tty(c, target);
+    else
+        spawn(c, target);
+}
+
+// A started firmware exits when its input is closed
+static void close_connection(connection* c) {
+    if (c->child > 0) {
+        close(c->tx_fd);
+        waitpid(c->child, NULL, 0);
+    }
+}
+
+static void send_bytes(connection* c, const uint8_t* data, int len) {
+    while (len > 0) {
+        ssize_t n = write(c->tx_fd, data, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            printf("Error: The firmware closed the connection\n");
+            exit(1);
+        }
+        data += n;
+        len -= (int)n;
+        c->bytes_sent += n;
+    }
+}
+
+static uint8_t receive_byte(connection* c) {
+    while (c->next == c->length) {
+        struct pollfd p = { c->rx_fd, POLLIN, 0 };
+        int ready = poll(&p, 1, CLIENT_TIMEOUT * 1000);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready == 0) {
+            printf("Error: No reply from the firmware within %d seconds\n", CLIENT_TIMEOUT);
+            exit(1);
+        }
+
+        ssize_t n = read(c->rx_fd, c->buffer, sizeof(c->buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            printf("Error: The firmware closed the connection\n");
+            exit(1);
+        }
+        c->length = (int)n;
+        c->next = 0;
+        c->bytes_received += n;
+    }
+    return c->buffer[c->next++];
+}
+
+/*----------- Frames -------------------*/
+
+// [B_STUFF, CMD, SCMD, LEN, DATA..., CRC, TERM], as read by simpleserial_get()
+static void send_command(connection* c, char cmd, uint8_t scmd, uint8_t len, const uint8_t* data) {
+    uint8_t frame[FRAME_MAX + 6];
+    frame[0] = 0x00;
+    frame[1] = (uint8_t)cmd;
+    frame[2] = scmd;
+    frame[3] = len;
+    if (len > 0)
+        memcpy(frame + 4, data, len);
+    frame[len + 4] = ss_crc(frame + 1, len + 3);
+    frame[len + 5] = 0x00;
+    stuff(frame, len + 6);
+    send_bytes(c, frame, len + 6);
+}
+
+// Read a reply [B_STUFF, CMD, LEN, DATA..., CRC, TERM] as written by simpleserial_put()
+// Returns its command character and copies its data, or 0 for a malformed frame
+static char receive_reply(connection* c, uint8_t* data, int* len) {
+    uint8_t frame[FRAME_MAX + 6];
+    int n = 0;
+    uint8_t b;
+    do {
+        b = receive_byte(c);
+        if (n < (int)sizeof(frame))
+            frame[n] = b;
+        n++;
+    } while (b != 0x00);
+
+    if (n < 5 || n > (int)sizeof(frame) || !unstuff(frame, n) || frame[2] != n - 5 || ss_crc(frame + 1, n - 3) != frame[n-2])
+        return 0;
+    *len = frame[2];
+    memcpy(data, frame + 3, *len);
+    return (char)frame[1];
+}
+
+// Send a command and read the replies up to the error frame that closes it, the data of the last
+// other reply is copied to reply
+// Returns the status code of the error frame, or -1 for a malformed frame
+static int request(connection* c, char cmd, uint8_t scmd, uint8_t len, const uint8_t* data, uint8_t* reply, int* reply_len) {
+    uint8_t frame[FRAME_MAX];
+    int frame_len;
+    char kind;
+    send_command(c, cmd, scmd, len, data);
+    while ((kind = receive_reply(c, frame, &frame_len)) != 'e') {
+        if (kind == 0)
+            return -1;
+        memcpy(reply, frame, frame_len);
+        *reply_len = frame_len;
+    }
+    return frame_len == 1 ? frame[0] : -1;
+}
+
+// Command as <character>[:<scmd>[:<payload in hex>]], e.g. c:1:0000803f...
+static void parse_command(const char* spec, char* cmd, uint8_t* scmd, uint8_t* payload, int* len) {
+    *cmd = spec[0];
+    *scmd = 0;
+    *len = 0;
+    if (spec[0] == '\0' || (spec[1] != '\0' && spec[1] != ':')) {
+        printf("Error: Invalid command %s\n", spec);
+        exit(0);
+    }
+    if (spec[1] == '\0')
+        return;
+
+    char* end;
+    *scmd = (uint8_t)strtol(spec + 2, &end, 0);
+    if (*end == '\0')
+        return;
+
+    const char* hex = end + 1;
+    int n = (int)strlen(hex);
+    if (*end != ':' || n % 2 != 0 || n / 2 > FRAME_MAX - 7) {
+        printf("Error: Invalid payload in command %s\n", spec);
+        exit(0);
+    }
+    int i;
+    for (i = 0; i < n / 2; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            printf("Error: Invalid payload in command %s\n", spec);
+            exit(0);
+        }
+        payload[i] = (uint8_t)byte;
+    }
+    *len = n / 2;
+}
+
+// Whether a reply can be read within ms milliseconds
+static int reply_ready(connection* c, int ms) {
+    if (c->next < c->length)
+        return 1;
+    struct pollfd p = { c->rx_fd, POLLIN, 0 };
+    return poll(&p, 1, ms) > 0;
+}
+
+// Read the replies of a stream command up to its 'k' frame [status, next sequence number, window],
+// the data of an 'r' frame before it is copied to result
+static int stream_reply(connection* c, uint8_t* ack, uint8_t* result, int* result_len) {
+    uint8_t frame[FRAME_MAX];
+    int len;
+    char kind;
+    while ((kind = receive_reply(c, frame, &len)) != 'k' || len != 3) {
+        if (kind == 'r' && result != NULL) {
+            memcpy(result, frame, len);
+            *result_len = len;
+        }
+        else if (kind == 'e' && len == 1 && frame[0] != 0)
+            return frame[0];
+    }
+    memcpy(ack, frame, 3);
+    return ack[0];
+}
+
+// Send size bytes with the 's' command, keeping up to *window data frames outstanding (1 for stop-and-wait)
+// Returns the status of the stream, *window is set to the window agreed by the firmware and the data
+// of the reply to the end of the stream is copied to result
+static int stream_send(connection* c, uint8_t kind, const uint8_t* data, uint32_t size, int* window,
+    uint8_t* result, int* result_len, unsigned long* resent) {
+    uint8_t ack[3];
+    uint8_t begin[6] = { kind, size & 0xFF, (size >> 8) & 0xFF, (size >> 16) & 0xFF, size >> 24, (uint8_t)*window };
+    send_command(c, 's', STREAM_BEGIN, 6, begin);
+    int status = stream_reply(c, ack, NULL, NULL);
+    if (status != 0)
+        return status;
+    *window = ack[2];
+
+    uint32_t n_frames = (size + STREAM_CHUNK - 1) / STREAM_CHUNK;
+    uint32_t base = 0, next = 0; // First frame not acknowledged, next frame to send
+    uint8_t frame[FRAME_MAX];
+    int len;
+    while (base < n_frames) {
+        while (next < n_frames && next - base < (uint32_t)*window) {
+            uint32_t offset = next * STREAM_CHUNK;
+            int n = size - offset < STREAM_CHUNK ? (int)(size - offset) : STREAM_CHUNK;
+            frame[0] = (uint8_t)next;
+            memcpy(frame + 1, data + offset, n);
+            send_command(c, 's', STREAM_DATA, (uint8_t)(n + 1), frame);
+            next++;
+        }
+
+        // Without an acknowledgement the outstanding frames are sent again
+        if (!reply_ready(c, STREAM_RETRY)) {
+            *resent += next - base;
+            next = base;
+            continue;
+        }
+
+        // An 'e' frame reports a corrupted frame, the acknowledgement of the gap follows
+        char reply = receive_reply(c, frame, &len);
+        if (reply != 'k' || len != 3)
+            continue;
+
+        // Acknowledgements older than base are stale
+        uint32_t ahead = (uint8_t)(frame[1] - (uint8_t)base);
+        if (ahead > next - base)
+            continue;
+        if (frame[0] == STREAM_ERR_SEQ) {
+            *resent += next - (base + ahead);
+            next = base + ahead;
+        }
+        else if (frame[0] != 0)
+            return frame[0];
+        base += ahead;
+    }
+
+    send_command(c, 's', STREAM_END, 0, NULL);
+    return stream_reply(c, ack, result, result_len);
+}
+
+// Upload a model file written by model_save() (DEVICE_STREAM_MODEL) or quantized_model_save()
+// (DEVICE_STREAM_QUANTIZED) and make it the resident model of its kind
+static void upload_model(connection* c, const char* filename, uint8_t kind, int window) {
+    FILE* fp = fopen(filename, "rb");
+    if (NULL == fp) {
+        printf("Error opening %s file. Make sure you mentioned the file path correctly\n", filename);
+        exit(0);
+    }
+    fseek(fp, 0, SEEK_END);
+    uint32_t size = (uint32_t)ftell(fp);
+    rewind(fp);
+    uint8_t* file = (uint8_t*)malloc(size > 0 ? size : 1);
+    if (fread(file, 1, size, fp) != size) {
+        printf("Error: Cannot read the model file %s\n", filename);
+        exit(0);
+    }
+    fclose(fp);
+
+    unsigned long resent = 0;
+    int status = stream_send(c, kind, file, size, &window, NULL, NULL, &resent);
+    free(file);
+    if (status != 0) {
+        printf("Error: Upload of %s failed with status %d\n", filename, status);
+        exit(1);
+    }
+    printf("Uploaded %s (%u bytes)\n", filename, (unsigned)size);
+}
+
+// A .csv or binary dataset file
+static void load_dataset(dataset* d, const char* filename) {
+    size_t name_len = strlen(filename);
+    if (name_len > 4 && strcmp(filename + name_len - 4, ".csv") == 0) {
+        int rows, cols;
+        mlp_real** table = read_csv_auto((char*)filename, &rows, &cols);
+        dataset_from_table(d, table[0], rows, cols);
+        free_csv(table);
+    }
+    else
+        dataset_open(d, filename);
+}
+
+// Stream a labelled dataset to the firmware, which classifies every sample as it arrives
+static int evaluate(connection* c, const char* filename, int window) {
+    // The samples are sent as mlp_real, which has to be the type of the firmware
+    uint8_t meta[FRAME_MAX];
+    int meta_len = 0;
+    if (request(c, 'm', 0, 0, NULL, meta, &meta_len) != 0 || meta_len < 5 || meta[2] == 0) {
+        printf("Error: The firmware has no model loaded\n");
+        return 1;
+    }
+    if (meta[1] != sizeof(mlp_real)) {
+        printf("Error: The firmware computes with %d-byte reals, this client was built with %s\n", meta[1], MLP_REAL_NAME);
+        return 1;
+    }
+
+    dataset d;
+    load_dataset(&d, filename);
+    if (d.n_features != (meta[3] | meta[4] << 8)) {
+        printf("Error: The dataset has %d features, the model %d inputs\n", d.n_features, meta[3] | meta[4] << 8);
+        return 1;
+    }
+
+    // Every sample is its features followed by its label
+    size_t row = (size_t)(d.n_features + 1);
+    mlp_real* samples = (mlp_real*)malloc((size_t)d.n_rows * row * sizeof(mlp_real));
+    int i;
+    for (i = 0; i < d.n_rows; i++) {
+        memcpy(samples + i * row, dataset_row(&d, i), d.n_features * sizeof(mlp_real));
+        samples[i * row + d.n_features] = d.labels[i];
+    }
+    uint32_t size = (uint32_t)(d.n_rows * row * sizeof(mlp_real));
+
+    uint8_t result[FRAME_MAX];
+    int result_len = 0;
+    unsigned long resent = 0;
+    c->bytes_sent = c->bytes_received = 0;
+    double start = now();
+    int status = stream_send(c, DEVICE_STREAM_SAMPLES, (const uint8_t*)samples, size, &window, result, &result_len, &resent);
+    double elapsed = now() - start;
+    free(samples);
+
+    if (status != 0 || result_len != 8) {
+        printf("Error: Evaluation of %s failed with status %d\n", filename, status);
+        dataset_destroy(&d);
+        return 1;
+    }
+    uint32_t n_evaluated = result[0] | result[1] << 8 | result[2] << 16 | (uint32_t)result[3] << 24;
+    uint32_t n_correct = result[4] | result[5] << 8 | result[6] << 16 | (uint32_t)result[7] << 24;
+
+    printf("Evaluated %u of %d samples of %s on the firmware: accuracy %.2f%%\n", (unsigned)n_evaluated, d.n_rows, filename,
+        n_evaluated > 0 ? 100.0 * n_correct / n_evaluated : 0);
+    printf("Streamed %u bytes in %.3f ms with a window of %d frames: %.1f samples/s, %.1f KB/s, %lu frames resent\n",
+        (unsigned)size, elapsed * 1e3, window, d.n_rows / elapsed, c->bytes_sent / elapsed / 1e3, resent);
+    int failed = n_evaluated != (uint32_t)d.n_rows;
+    dataset_destroy(&d);
+
+    return failed;
+}
+
+// Upload a quantized model file, classify every sample of a dataset with it on the firmware, one 'q' request
+// per sample, and compare every reply byte for byte with the quantized network on the host
+static int compare_quantized(connection* c, const char* model_file, const char* filename, int window) {
+    // The samples are sent and the outputs received as mlp_real, which has to be the type of the firmware
+    uint8_t meta[FRAME_MAX];
+    int meta_len = 0;
+    if (request(c, 'm', 0, 0, NULL, meta, &meta_len) != 0 || meta_len < 3) {
+        printf("Error: No metadata from the firmware\n");
+        return 1;
+    }
+    if (meta[1] != sizeof(mlp_real)) {
+        printf("Error: The firmware computes with %d-byte reals, this client was built with %s\n", meta[1], MLP_REAL_NAME);
+        return 1;
+    }
+
+    quantized_model q;
+    quantized_model_open(&q, model_file);
+    int n_outputs = q.layer_sizes[q.n_layers-1];
+    int reply_size = 1 + n_outputs * sizeof(mlp_real);
+    dataset d;
+    load_dataset(&d, filename);
+    if (d.n_features != q.layer_sizes[0]) {
+        printf("Error: The dataset has %d features, the quantized model %d inputs\n", d.n_features, q.layer_sizes[0]);
+        return 1;
+    }
+    if (d.n_features * sizeof(mlp_real) > FRAME_MAX - 7 || reply_size > FRAME_MAX - 1) {
+        printf("Error: The samples or the outputs of the quantized model do not fit in a frame\n");
+        return 1;
+    }
+
+    upload_model(c, model_file, DEVICE_STREAM_QUANTIZED, window);
+
+    mlp_real* output = (mlp_real*)malloc(n_outputs * sizeof(mlp_real));
+    uint8_t expected[FRAME_MAX], reply[FRAME_MAX];
+    int i, n_differ = 0, n_correct = 0;
+    for (i = 0; i < d.n_rows; i++) {
+        expected[0] = (uint8_t)quantized_model_classify(&q, dataset_row(&d, i), output);
+        memcpy(expected + 1, output, n_outputs * sizeof(mlp_real));
+        n_correct += expected[0] == (int)d.labels[i];
+
+        int reply_len = 0;
+        int status = request(c, 'q', 1, (uint8_t)(d.n_features * sizeof(mlp_real)), (const uint8_t*)dataset_row(&d, i), reply, &reply_len);
+        if (status != 0) {
+            printf("Error: Sample %d failed with status %d\n", i, status);
+            n_differ = d.n_rows - i;
+            break;
+        }
+        if (reply_len != reply_size || memcmp(reply, expected, reply_size) != 0) {
+            if (n_differ == 0)
+                printf("Sample %d: the firmware replied class %d and %s outputs, the host computed class %d\n", i, reply[0],
+                    reply_len == reply_size && memcmp(reply + 1, expected + 1, reply_size - 1) == 0 ? "the same" : "different", expected[0]);
+            n_differ++;
+        }
+    }
+
+    printf("Classified %d samples of %s with the q%d model %s on the firmware: %d replies differ from the host, accuracy %.2f%%\n",
+        d.n_rows, filename, q.bits-1, model_file, n_differ, d.n_rows > 0 ? 100.0 * n_correct / d.n_rows : 0);
+
+    free(output);
+    dataset_destroy(&d);
+    quantized_model_destroy(&q);
+    return n_differ > 0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(const double* sorted, int n, double p) {
+    int i = (int)(p * (n - 1) + 0.5);
+    return sorted[i];
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 6) {
+        printf("\nExecution syntax:\n");
+        printf("-----------------\n");
+        printf("Argument 1: Firmware to reach, either the path of its executable (started with SS_TRANSPORT=stdio), unix:<path> or a pty device Ex: ./MLP \n");
+        printf("Argument 2: Number of requests Ex: 1000 \n");
+        printf("Argument 3: Command character, optionally followed by :scmd and :payload in hex Ex: a \n");
+        printf("Argument 4: Optional JSON file the results are written to, - for none Ex: latency.json \n");
+        printf("Argument 5: Optional model file uploaded once before the requests Ex: model.bin \n");
+        printf("Or, to evaluate a labelled dataset on the firmware, streamed with a window of frames (1 for stop-and-wait):\n");
+        printf("Argument 2: evaluate \n");
+        printf("Argument 3: Dataset, a .csv or binary dataset file Ex: data/data_test.csv \n");
+        printf("Argument 4: Window Ex: %d \n", STREAM_WINDOW);
+        printf("Argument 5: Optional model file uploaded first Ex: model.bin \n");
+        printf("Or, to check that the quantized model classifies a dataset on the firmware exactly as on the host:\n");
+        printf("Argument 2: quantized \n");
+        printf("Argument 3: Quantized model file written by mlp_quantize, uploaded first Ex: model_q15.bin \n");
+        printf("Argument 4: Dataset, a .csv or binary dataset file Ex: data/data_test.csv \n");
+        printf("Example:\n--------\n~$ ./ss_client ./MLP 1000 a latency.json\n~$ ./ss_client ./MLP evaluate data/data_test.csv %d\n", STREAM_WINDOW);
+        printf("~$ ./ss_client ./MLP quantized model_q15.bin data/data_test.csv\n\n");
+        exit(0);
+    }
+
+    crc_table_init();
+    signal(SIGPIPE, SIG_IGN);
+    connection c;
+    memset(&c, 0, sizeof(c));
+    const char* target = argv[1];
+
+    if (argc > 2 && strcmp(argv[2], "evaluate") == 0) {
+        if (argc < 4) {
+            printf("Error: Name of the dataset file is missing\n");
+            exit(0);
+        }
+        int window = argc > 4 ? atoi(argv[4]) : STREAM_WINDOW;
+        if (window < 1 || window > 255) {
+            printf("Error: Window should be between 1 and 255\n");
+            exit(0);
+        }
+        open_target(&c, target);
+        if (argc > 5)
+            upload_model(&c, argv[5], DEVICE_STREAM_MODEL, window);
+        int failed = evaluate(&c, argv[3], window);
+        close_connection(&c);
+        return failed;
+    }
+
+    if (argc > 2 && strcmp(argv[2], "quantized") == 0) {
+        if (argc != 5) {
+            printf("Error: Names of the quantized model file and of the dataset file are missing\n");
+            exit(0);
+        }
+        open_target(&c, target);
+        int failed = compare_quantized(&c, argv[3], argv[4], STREAM_WINDOW);
+        close_connection(&c);
+        return failed;
+    }
+
+    int n_requests = argc > 2 ? atoi(argv[2]) : 1000;
+    char cmd;
+    uint8_t scmd;
+    uint8_t payload[FRAME_MAX];
+    int payload_len;
+    parse_command(argc > 3 ? argv[3] : "a", &cmd, &scmd, payload, &payload_len);
+    const char* results = argc > 4 && strcmp(argv[4], "-") != 0 ? argv[4] : NULL;
+    if (n_requests <= 0) {
+        printf("Error: Number of requests should be positive\n");
+        exit(0);
+    }
+
+    open_target(&c, target);
+    if (argc > 5)
+        upload_model(&c, argv[5], DEVICE_STREAM_MODEL, STREAM_WINDOW);
+
+    double* latency = (double*)malloc(n_requests * sizeof(double));
+    uint8_t last_reply[FRAME_MAX];
+    int last_len = 0;
+    int failed = 0;
+
+    // One warm-up request, then every request waits for the error frame that closes it
+    int i;
+    double start = 0;
+    for (i = -1; i < n_requests; i++) {
+        if (i == 0) {
+            start = now();
+            c.bytes_sent = c.bytes_received = 0;
+        }
+
+        double t0 = now();
+        int status = request(&c, cmd, scmd, (uint8_t)payload_len, payload, last_reply, &last_len);
+        if (i >= 0) {
+            latency[i] = now() - t0;
+            // A malformed frame or a non-zero status code
+            if (status != 0)
+                failed++;
+        }
+    }
+    double elapsed = now() - start;
+    close_connection(&c);
+
+    // Latencies in microseconds
+    qsort(latency, n_requests, sizeof(double), compare_double);
+    double mean = 0;
+    for (i = 0; i < n_requests; i++)
+        mean += latency[i];
+    mean /= n_requests;
+
+    printf("Command '%c' (scmd %d, %d payload bytes) to %s: %d requests, %d failed\n", cmd, scmd, payload_len, target, n_requests, failed);
+    printf("Latency (us): min %.1f  median %.1f  mean %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+        latency[0] * 1e6, percentile(latency, n_requests, 0.5) * 1e6, mean * 1e6, percentile(latency, n_requests, 0.9) * 1e6,
+        percentile(latency, n_requests, 0.99) * 1e6, latency[n_requests-1] * 1e6);
+    printf("Throughput: %.1f requests/s, %.1f KB/s sent, %.1f KB/s received\n",
+        n_requests / elapsed, c.bytes_sent / elapsed / 1e3, c.bytes_received / elapsed / 1e3);
+    printf("Last reply:");
+    for (i = 0; i < last_len; i++)
+        printf(" %02x", last_reply[i]);
+    printf("\n");
+
+    if (results != NULL) {
+        FILE* fp = fopen(results, "w");
+        if (NULL == fp) {
+            printf("Error opening %s file. Make sure you mentioned the file path correctly\n", results);
+            exit(0);
+        }
+        fprintf(fp, "{\n  \"command\": \"%c\",\n  \"scmd\": %d,\n  \"payload_bytes\": %d,\n  \"requests\": %d,\n  \"failed\": %d,\n",
+            cmd, scmd, payload_len, n_requests, failed);
+        fprintf(fp, "  \"latency_us\": {\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+            latency[0] * 1e6, percentile(latency, n_requests, 0.5) * 1e6, mean * 1e6, percentile(latency, n_requests, 0.9) * 1e6,
+            percentile(latency, n_requests, 0.99) * 1e6, latency[n_requests-1] * 1e6);
+        fprintf(fp, "  \"requests_per_second\": %.3f,\n  \"bytes_sent\": %lu,\n  \"bytes_received\": %lu\n}\n",
+            n_requests / elapsed, c.bytes_sent, c.bytes_received);
+        fclose(fp);
+    }
+
+    free(latency);
+
+    // A failed request fails the run, e.g. in CI
+    return failed > 0;
+}
@@ -0,0 +1,96 @@
+/*
+Desc: Windowed SimpleSerial stream carrying payloads larger than one frame without a round trip per frame
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "ss_stream.h"
+
+// State of the stream in progress
+static const ss_stream_handler* handler;
+static int active = 0;
+static uint32_t size, received;
+static uint8_t next_seq;    // Sequence number of the next data frame in order
+static uint8_t window;      // Agreed with the host at begin
+static uint8_t since_ack;   // Data frames taken since the last acknowledgement
+static int nak_sent = 0;    // STREAM_ERR_SEQ is sent once per gap, until the expected frame arrives
+
+static void acknowledge(uint8_t status) {
+    uint8_t reply[3] = { status, next_seq, window };
+    simpleserial_put('k', 3, reply);
+    since_ack = 0;
+}
+
+static uint8_t stream_command(uint8_t cmd, uint8_t scmd, uint8_t len, uint8_t* in) {
+    uint8_t status = 0;
+
+    switch (scmd) {
+        case STREAM_BEGIN:
+            if (len != 6) {
+                status = SS_ERR_LEN;
+                break;
+            }
+            size = (uint32_t)in[1] | (uint32_t)in[2] << 8 | (uint32_t)in[3] << 16 | (uint32_t)in[4] << 24;
+            window = in[5] >= 1 && in[5] < STREAM_WINDOW ? in[5] : STREAM_WINDOW;
+            received = 0;
+            next_seq = 0;
+            nak_sent = 0;
+            status = handler->begin(in[0], size);
+            active = status == 0;
+            break;
+
+        case STREAM_DATA:
+            if (!active || len < 1) {
+                status = STREAM_ERR_STATE;
+                break;
+            }
+
+            // Frames after a gap are dropped until the host goes back to the expected one
+            if (in[0] != next_seq) {
+                if (nak_sent)
+                    return 0;
+                nak_sent = 1;
+                acknowledge(STREAM_ERR_SEQ);
+                return 0;
+            }
+            if (received + (len - 1) > size) {
+                status = SS_ERR_LEN;
+                break;
+            }
+
+            status = handler->data(in + 1, len - 1);
+            if (status != 0)
+                break;
+            received += len - 1;
+            next_seq++;
+            nak_sent = 0;
+
+            // Acknowledge every half window, and the last frame so the host can end the stream
+            if (++since_ack >= (window + 1) / 2 || received == size)
+                acknowledge(0);
+            return 0;
+
+        case STREAM_END:
+            if (!active || received != size) {
+                status = STREAM_ERR_STATE;
+                break;
+            }
+            active = 0;
+            status = handler->end();
+            break;
+
+        default:
+            status = SS_ERR_CMD;
+            break;
+    }
+
+    // A failed stream is over, the host has to begin it again
+    if (status != 0)
+        active = 0;
+    acknowledge(status);
+    return 0;
+}
+
+int ss_stream_init(char c, const ss_stream_handler* h) {
+    handler = h;
+    return simpleserial_addcmd_flags(c, 0, stream_command, CMD_FLAG_NOACK);
+}
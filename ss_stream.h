@@ -0,0 +1,44 @@
+#ifndef SS_STREAM_H
+#define SS_STREAM_H
+
+#include <stdint.h>
+#include "simpleserial.h"
+
+// Windowed stream of a payload larger than one SimpleSerial frame, e.g. a model file or a batch of samples.
+// The host sends up to the agreed window of data frames without waiting; the firmware acknowledges
+// every half window with the sequence number it expects next, so the host keeps sending while the
+// acknowledgements travel back. A frame out of order is answered once with STREAM_ERR_SEQ, after which
+// the host resends from the expected frame (go-back-N).
+//
+// Frames of the stream command (all replies are 'k' frames [status, next sequence number, window]):
+//   scmd 0, begin: [kind, size (uint32, little-endian), window of the host]
+//   scmd 1, data:  [sequence number (mod 256), up to STREAM_CHUNK bytes of the payload]
+//   scmd 2, end:   empty, replied with the result of the end callback (an 'r' frame) before the 'k' frame
+
+// Most data frames outstanding, the host may ask for fewer
+#ifndef STREAM_WINDOW
+#define STREAM_WINDOW 8
+#endif
+
+// Payload bytes of a data frame
+#define STREAM_CHUNK 240
+
+#define STREAM_BEGIN 0
+#define STREAM_DATA 1
+#define STREAM_END 2
+
+// Status codes of the stream, after those of ss_err_cmd and the commands
+#define STREAM_ERR_SEQ 0x20   // A data frame arrived out of order, resend from the expected one
+#define STREAM_ERR_STATE 0x21 // No stream was begun, or the payload is incomplete at its end
+
+// Receiver of the payload of a stream; every callback returns 0 or a status code that aborts the stream
+typedef struct {
+    uint8_t (*begin)(uint8_t kind, uint32_t size);
+    uint8_t (*data)(const uint8_t* data, int len); // The payload in order, a data frame at a time
+    uint8_t (*end)(void); // Sends the result of the stream, e.g. with simpleserial_put('r', ...)
+} ss_stream_handler;
+
+// Register the stream command c
+int ss_stream_init(char c, const ss_stream_handler*);
+
+#endif
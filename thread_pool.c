@@ -0,0 +1,140 @@
+/*
+Desc: Fixed-size pool of threads running the same task in parallel
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "thread_pool.h"
+
+#ifdef MLP_THREADS
+#include <pthread.h>
+#endif
+
+struct thread_pool {
+    int n_threads;
+#ifdef MLP_THREADS
+    pthread_t* threads;
+    pthread_mutex_t lock;
+    pthread_cond_t start;    // Signalled when a new task is posted
+    pthread_cond_t finished; // Signalled when the last worker finishes the task
+    unsigned long generation; // Incremented for every task posted
+    int running;             // Workers still busy with the current task
+    int stop;
+    thread_task task;
+    void* arg;
+#endif
+};
+
+#ifdef MLP_THREADS
+typedef struct {
+    thread_pool* pool;
+    int thread_id;
+} worker_start;
+
+static void* worker(void* arg) {
+    thread_pool* pool = ((worker_start*)arg)->pool;
+    int thread_id = ((worker_start*)arg)->thread_id;
+    mlp_free(arg);
+
+    unsigned long seen = 0;
+    for (;;) {
+        // Wait for the next task
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stop)
+            pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        thread_task task = pool->task;
+        void* task_arg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(task_arg, thread_id, pool->n_threads);
+
+        // Report completion
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+#endif
+
+thread_pool* thread_pool_create(int n_threads) {
+    thread_pool* pool = (thread_pool*)mlp_calloc(1, sizeof(thread_pool));
+    pool->n_threads = n_threads > 0 ? n_threads : 1;
+
+#ifdef MLP_THREADS
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+
+    pool->threads = (pthread_t*)mlp_calloc(pool->n_threads, sizeof(pthread_t));
+    int i;
+    for (i = 1; i < pool->n_threads; i++) {
+        worker_start* start = (worker_start*)mlp_malloc(sizeof(worker_start));
+        start->pool = pool;
+        start->thread_id = i;
+        if (pthread_create(&pool->threads[i], NULL, worker, start) != 0) {
+            printf("Error: Cannot create training thread %d\n", i);
+            exit(0);
+        }
+    }
+#endif
+
+    return pool;
+}
+
+void thread_pool_run(thread_pool* pool, thread_task task, void* arg) {
+#ifdef MLP_THREADS
+    if (pool->n_threads > 1) {
+        // Post the task to the workers
+        pthread_mutex_lock(&pool->lock);
+        pool->task = task;
+        pool->arg = arg;
+        pool->running = pool->n_threads - 1;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+
+        // The caller is thread 0
+        task(arg, 0, pool->n_threads);
+
+        // Wait for the workers
+        pthread_mutex_lock(&pool->lock);
+        while (pool->running > 0)
+            pthread_cond_wait(&pool->finished, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+        return;
+    }
+#endif
+
+    int i;
+    for (i = 0; i < pool->n_threads; i++)
+        task(arg, i, pool->n_threads);
+}
+
+int thread_pool_size(thread_pool* pool) {
+    return pool->n_threads;
+}
+
+void thread_pool_destroy(thread_pool* pool) {
+#ifdef MLP_THREADS
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    int i;
+    for (i = 1; i < pool->n_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    mlp_free(pool->threads);
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+#endif
+
+    mlp_free(pool);
+}
@@ -0,0 +1,29 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mlp_alloc.h"
+
+// Threads are used where POSIX threads exist; elsewhere (e.g. the firmware)
+// the pool runs the work of every thread one after the other on the caller
+#if !defined(MLP_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#define MLP_THREADS 1
+#endif
+
+// Work run by every thread of the pool, thread_id in [0, n_threads)
+typedef void (*thread_task)(void*, int, int);
+
+typedef struct thread_pool thread_pool;
+
+// Start n_threads - 1 worker threads, the caller acts as thread 0
+thread_pool* thread_pool_create(int);
+
+// Run the task on all threads of the pool and wait until every thread has finished it
+void thread_pool_run(thread_pool*, thread_task, void*);
+
+int thread_pool_size(thread_pool*);
+
+void thread_pool_destroy(thread_pool*);
+
+#endif
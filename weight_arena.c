@@ -0,0 +1,72 @@
+/*
+Desc: Contiguous aligned storage for the weight matrices of the network
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "weight_arena.h"
+
+#define ALIGN_ELEMENTS (WEIGHT_ALIGNMENT / sizeof(mlp_real))
+
+// Shape of every matrix and total size of the arena, without the storage
+static void weight_arena_shape(weight_arena* w, int n_layers, int* layer_sizes) {
+    w->n_matrices = n_layers - 1;
+
+    // Create memory for the shape of each matrix
+    w->rows = (int*)mlp_calloc(w->n_matrices, sizeof(int));
+    w->cols = (int*)mlp_calloc(w->n_matrices, sizeof(int));
+    w->stride = (int*)mlp_calloc(w->n_matrices, sizeof(int));
+    w->offset = (size_t*)mlp_calloc(w->n_matrices, sizeof(size_t));
+
+    // Rows are padded to a multiple of the alignment so that every row starts aligned
+    int i;
+    w->size = 0;
+    for (i = 0; i < w->n_matrices; i++) {
+        w->rows[i] = layer_sizes[i] + 1;
+        w->cols[i] = layer_sizes[i+1];
+        w->stride[i] = (int)(((size_t)w->cols[i] + ALIGN_ELEMENTS - 1) / ALIGN_ELEMENTS * ALIGN_ELEMENTS);
+        w->offset[i] = w->size;
+        w->size += (size_t)w->rows[i] * w->stride[i];
+    }
+}
+
+void weight_arena_create(weight_arena* w, int n_layers, int* layer_sizes) {
+    weight_arena_shape(w, n_layers, layer_sizes);
+
+    // One zeroed block for all the matrices, over-allocated so the start can be aligned
+    w->block = mlp_calloc(w->size * sizeof(mlp_real) + WEIGHT_ALIGNMENT, 1);
+    if (NULL == w->block) {
+        printf("Error: Cannot allocate memory for the weights\n");
+        exit(0);
+    }
+    w->data = (mlp_real*)(((uintptr_t)w->block + WEIGHT_ALIGNMENT - 1) & ~(uintptr_t)(WEIGHT_ALIGNMENT - 1));
+}
+
+void weight_arena_attach(weight_arena* w, int n_layers, int* layer_sizes, mlp_real* data) {
+    weight_arena_shape(w, n_layers, layer_sizes);
+
+    // The storage belongs to the caller
+    w->block = NULL;
+    w->data = data;
+}
+
+void weight_arena_load(weight_arena* w, const mlp_real* weights) {
+    // weights holds the matrices one after the other, each row-major without padding
+    int i, j, k;
+    for (i = 0; i < w->n_matrices; i++) {
+        mlp_real* matrix = weight_matrix(w, i);
+        for (j = 0; j < w->rows[i]; j++)
+            for (k = 0; k < w->cols[i]; k++)
+                matrix[j * w->stride[i] + k] = *weights++;
+    }
+}
+
+void weight_arena_destroy(weight_arena* w) {
+    mlp_free(w->block);
+    mlp_free(w->offset);
+    mlp_free(w->stride);
+    mlp_free(w->cols);
+    mlp_free(w->rows);
+
+    w->block = NULL;
+    w->data = NULL;
+}
@@ -0,0 +1,41 @@
+#ifndef WEIGHT_ARENA_H
+#define WEIGHT_ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "mlp_alloc.h"
+#include "mlp_real.h"
+
+// Alignment of the arena and of every weight row, in bytes (one cache line)
+#ifndef WEIGHT_ALIGNMENT
+#define WEIGHT_ALIGNMENT 64
+#endif
+
+// All weight matrices of a model stored in one aligned block
+// Matrix i sits between layers i and i+1 and is of size ((layer_sizes[i]+1) x layer_sizes[i+1]),
+// row 0 holding the bias weights. Element (j, k) of matrix i is at
+// data[offset[i] + j * stride[i] + k]. Padding at the end of each row is kept at zero.
+typedef struct {
+    int n_matrices; // Number of weight matrices (n_layers - 1)
+    int* rows;      // Rows of each matrix (layer_sizes[i] + 1)
+    int* cols;      // Columns of each matrix (layer_sizes[i+1])
+    int* stride;    // Row stride of each matrix in elements (cols rounded up to WEIGHT_ALIGNMENT)
+    size_t* offset; // Start of each matrix in elements from data
+    size_t size;    // Total number of elements in the arena
+    mlp_real* data;   // Aligned start of the arena
+    void* block;    // Block returned by the allocator, data lies inside it (NULL when attached)
+} weight_arena;
+
+void weight_arena_create(weight_arena*, int, int*);
+// Lay the arena over existing storage already in its layout, e.g. a mapped model file
+void weight_arena_attach(weight_arena*, int, int*, mlp_real*);
+void weight_arena_load(weight_arena*, const mlp_real*);
+void weight_arena_destroy(weight_arena*);
+
+// Start of weight matrix i in the arena
+static inline mlp_real* weight_matrix(const weight_arena* w, int i) {
+    return w->data + w->offset[i];
+}
+
+#endif
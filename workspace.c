@@ -0,0 +1,59 @@
+/*
+Desc: Preallocated scratch memory for the training step
+GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
+*/
+
+#include "workspace.h"
+
+void training_workspace_create(training_workspace* ws, parameters* param, int n_layers, int* layer_sizes) {
+    // Create memory for arrays of inputs and outputs of the layers
+    ws->layer_inputs = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+    ws->layer_outputs = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+
+    // Create memory for local gradients and derivatives of each layer
+    ws->local_gradient = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+    ws->layer_derivatives = (mlp_real**)mlp_calloc(n_layers, sizeof(mlp_real*));
+
+    int i;
+    for (i = 0; i < n_layers; i++) {
+        ws->layer_inputs[i] = (mlp_real*)mlp_calloc(layer_sizes[i], sizeof(mlp_real));
+        ws->layer_outputs[i] = (mlp_real*)mlp_calloc(layer_sizes[i]+1, sizeof(mlp_real));
+        ws->local_gradient[i] = (mlp_real*)mlp_calloc(layer_sizes[i], sizeof(mlp_real));
+        ws->layer_derivatives[i] = (mlp_real*)mlp_calloc(layer_sizes[i], sizeof(mlp_real));
+    }
+
+    // Create memory for the expected output and the error at the output layer
+    ws->expected_output = (mlp_real*)mlp_calloc(param->output_layer_size, sizeof(mlp_real));
+    ws->error_output = (mlp_real*)mlp_calloc(param->output_layer_size, sizeof(mlp_real));
+
+    // Weight corrections between layers, including the bias terms
+    weight_arena_create(&ws->weight_correction, n_layers, layer_sizes);
+
+    // Matrices of a whole batch
+    ws->batch.capacity = 0;
+    if (param->batch_size > 1)
+        mini_batch_create(&ws->batch, param->batch_size, n_layers, layer_sizes);
+}
+
+void training_workspace_destroy(training_workspace* ws, int n_layers) {
+    if (ws->batch.capacity > 0)
+        mini_batch_destroy(&ws->batch, n_layers);
+
+    weight_arena_destroy(&ws->weight_correction);
+
+    mlp_free(ws->error_output);
+    mlp_free(ws->expected_output);
+
+    int i;
+    for (i = 0; i < n_layers; i++) {
+        mlp_free(ws->layer_derivatives[i]);
+        mlp_free(ws->local_gradient[i]);
+        mlp_free(ws->layer_outputs[i]);
+        mlp_free(ws->layer_inputs[i]);
+    }
+
+    mlp_free(ws->layer_derivatives);
+    mlp_free(ws->local_gradient);
+    mlp_free(ws->layer_outputs);
+    mlp_free(ws->layer_inputs);
+}
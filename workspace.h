@@ -0,0 +1,25 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mlp_alloc.h"
+#include "parameters.h"
+#include "mini_batch.h"
+
+// Scratch memory of a training step, sized once from the layer sizes and reused for every sample
+typedef struct {
+    mlp_real** layer_inputs;      // layer_inputs[l]: inputs to layer l (layer_sizes[l])
+    mlp_real** layer_outputs;     // layer_outputs[l]: outputs of layer l with the bias at index 0 (layer_sizes[l]+1)
+    mlp_real* expected_output;    // Expected output of the current sample (output_layer_size)
+    mlp_real* error_output;       // Error produced at the output layer (output_layer_size)
+    mlp_real** local_gradient;    // local_gradient[l]: local gradients (delta) of layer l (layer_sizes[l])
+    mlp_real** layer_derivatives; // layer_derivatives[l]: derivatives of the activation of layer l (layer_sizes[l])
+    weight_arena weight_correction; // Weight corrections, same layout as the weights
+    mini_batch batch;           // Batch matrices, only created when batch_size > 1
+} training_workspace;
+
+void training_workspace_create(training_workspace*, parameters*, int, int*);
+void training_workspace_destroy(training_workspace*, int);
+
+#endif
@@ -7,7 +7,7 @@ GitHub: https://github.com/manoharmukku/multilayer-perceptron-in-c
 
 #include "write_csv.h"
 
-void write_csv(char* filename, int rows, int cols, double** data) {
+void write_csv(char* filename, int rows, int cols, mlp_real** data) {
     FILE* fp = fopen(filename, "w");
     if (NULL == fp) {
         printf("Cannot create/open file %s. Make sure you have permission to create/open a file in the directory\n", filename);
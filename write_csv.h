@@ -4,7 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "mlp_real.h"
 
-void write_csv(char*, int, int, double**);
+void write_csv(char*, int, int, mlp_real**);
 
 #endif
\ No newline at end of file